@@ -212,6 +212,9 @@ void BuilderContext::AddTargetPasses(
         passMgr.add(CreateStartStopTimer(pCodeGenTimer, true));
     }
 
+    // Combine uniform loads into wide scalar loads, after all middle-end optimizations.
+    passMgr.add(CreatePatchScalarLoadCombine());
+
     // Dump the module just before codegen.
     if (EnableOuts())
     {
@@ -33,6 +33,8 @@
 #include "llpcInternal.h"
 #include "llpcPipelineState.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
 
 #define DEBUG_TYPE "llpc-builder-replayer"
@@ -40,6 +42,8 @@
 using namespace Llpc;
 using namespace llvm;
 
+STATISTIC(NumBuilderCallsReplayed, "Number of recorded builder calls replayed");
+
 namespace
 {
 
@@ -71,9 +75,10 @@ private:
 
     std::unique_ptr<Builder>                m_pBuilder;                         // The LLPC builder that the builder
                                                                                 //  calls are being replayed on.
-    std::map<Function*, ShaderStage>        m_shaderStageMap;                   // Map function -> shader stage
-    llvm::Function*                         m_pEnclosingFunc = nullptr;         // Last function written with current
-                                                                                //  shader stage
+    DenseMap<Function*, uint32_t>           m_opcodeMap;                        // Map builder call declaration ->
+                                                                                //  opcode
+    SmallVector<std::pair<CallInst*, uint32_t>, 64> m_calls;                    // Builder calls of the function being
+                                                                                //  replayed, in program order
 };
 
 } // anonymous
@@ -114,6 +119,7 @@ bool BuilderReplayer::runOnModule(
     BuilderContext* pBuilderContext = pPipelineState->GetBuilderContext();
     m_pBuilder.reset(pBuilderContext->CreateBuilder(pPipelineState, /*useBuilderRecorder=*/false));
 
+    // Build the opcode table of builder call declarations, so that no metadata needs to be decoded per call.
     SmallVector<Function*, 8> funcsToRemove;
 
     for (auto& func : module)
@@ -135,25 +141,59 @@ bool BuilderReplayer::runOnModule(
         }
 
         const ConstantAsMetadata* const pMetaConst = cast<ConstantAsMetadata>(pFuncMeta->getOperand(0));
-        uint32_t opcode = cast<ConstantInt>(pMetaConst->getValue())->getZExtValue();
-
-        SmallVector<CallInst*, 8> callsToRemove;
+        m_opcodeMap[&func] = cast<ConstantInt>(pMetaConst->getValue())->getZExtValue();
+        funcsToRemove.push_back(&func);
+    }
 
-        while (func.use_empty() == false)
+    // Replay function by function, in program order. The calls of a function are gathered first, as replaying may
+    // add instructions and declarations while we are walking. The shader stage only changes between functions.
+    if (m_opcodeMap.empty() == false)
+    {
+        for (auto& func : module)
         {
-            CallInst* const pCall = dyn_cast<CallInst>(func.use_begin()->getUser());
+            if (func.isDeclaration())
+            {
+                continue;
+            }
 
-            // Replay the call into BuilderImpl.
-            ReplayCall(opcode, pCall);
-        }
+            for (auto& block : func)
+            {
+                for (auto& inst : block)
+                {
+                    auto pCall = dyn_cast<CallInst>(&inst);
+                    if ((pCall == nullptr) || (pCall->getCalledFunction() == nullptr))
+                    {
+                        continue;
+                    }
+
+                    auto opcodeIt = m_opcodeMap.find(pCall->getCalledFunction());
+                    if (opcodeIt != m_opcodeMap.end())
+                    {
+                        m_calls.push_back({ pCall, opcodeIt->second });
+                    }
+                }
+            }
 
-        func.clearMetadata();
-        LLPC_ASSERT(func.user_empty());
-        funcsToRemove.push_back(&func);
+            if (m_calls.empty())
+            {
+                continue;
+            }
+
+            m_pBuilder->SetShaderStage(GetShaderStageFromFunction(&func));
+            for (const auto& call : m_calls)
+            {
+                ReplayCall(call.second, call.first);
+            }
+            NumBuilderCallsReplayed += m_calls.size();
+            m_calls.clear();
+        }
     }
+    m_opcodeMap.clear();
 
     for (Function* const pFunc : funcsToRemove)
     {
+        pFunc->clearMetadata();
+        LLPC_ASSERT(pFunc->user_empty());
         pFunc->eraseFromParent();
     }
 
@@ -166,26 +206,6 @@ void BuilderReplayer::ReplayCall(
     uint32_t  opcode,   // The builder call opcode
     CallInst* pCall)    // [in] The builder call to process
 {
-    // Change shader stage if necessary.
-    Function* pEnclosingFunc = pCall->getParent()->getParent();
-    if (pEnclosingFunc != m_pEnclosingFunc)
-    {
-        m_pEnclosingFunc = pEnclosingFunc;
-
-        auto mapIt = m_shaderStageMap.find(pEnclosingFunc);
-        ShaderStage stage = ShaderStageInvalid;
-        if (mapIt == m_shaderStageMap.end())
-        {
-            stage = GetShaderStageFromFunction(pEnclosingFunc);
-            m_shaderStageMap[pEnclosingFunc] = stage;
-        }
-        else
-        {
-            stage = mapIt->second;
-        }
-        m_pBuilder->SetShaderStage(stage);
-    }
-
     // Set the insert point on the Builder. Also sets debug location to that of pCall.
     m_pBuilder->SetInsertPoint(pCall);
 
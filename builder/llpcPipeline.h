@@ -94,6 +94,12 @@ struct Options
     NggSubgroupSizingType nggSubgroupSizing;       // NGG subgroup sizing type
     uint32_t              nggVertsPerSubgroup;     // How to determine NGG verts per subgroup
     uint32_t              nggPrimsPerSubgroup;     // How to determine NGG prims per subgroup
+    uint32_t              nggSubgroupCostModel;    // If set, choose NGG subgroup size by estimated occupancy when
+                                                   //  subgroup sizing is "Auto"
+    uint32_t              packInOut;               // If set, pack inputs/outputs of all supported stage interfaces;
+                                                   //  otherwise only where a cost model predicts fewer locations
+    uint32_t              disablePackInOutCostModel; // If set, inputs/outputs are only packed if packInOut is set
+    uint32_t              disableGsOnChip;         // If set, GS on-chip mode is never used
 };
 
 // Middle-end per-shader options to pass to SetShaderOptions.
@@ -56,6 +56,11 @@ static void SetGfx6BaseInfo(
     pTargetInfo->GetGpuProperty().maxSgprsAvailable = 104;
     pTargetInfo->GetGpuProperty().maxVgprsAvailable = 256;
 
+    pTargetInfo->GetGpuProperty().numSimdsPerCu = 4;
+    pTargetInfo->GetGpuProperty().maxWavesPerSimd = 10;
+    pTargetInfo->GetGpuProperty().vgprFileSizePerSimd = 256 * 64;
+    pTargetInfo->GetGpuProperty().vgprAllocGranularity = 4 * 64;
+
     //TODO: Setup gsPrimBufferDepth from hardware config option, will be done in another change.
     pTargetInfo->GetGpuProperty().gsPrimBufferDepth = 0x100;
 
@@ -281,6 +286,13 @@ static void SetGfx10Info(
     }
 
     pTargetInfo->GetGpuProperty().numShaderEngines = 2;
+
+    // A GFX10 CU has two SIMD32s, each with 1024 VGPRs per lane (allocated in granules of 8 in wave32)
+    pTargetInfo->GetGpuProperty().numSimdsPerCu = 2;
+    pTargetInfo->GetGpuProperty().maxWavesPerSimd = 20;
+    pTargetInfo->GetGpuProperty().vgprFileSizePerSimd = 1024 * 32;
+    pTargetInfo->GetGpuProperty().vgprAllocGranularity = 8 * 32;
+
     pTargetInfo->GetGpuProperty().supportShaderPowerProfiling = true;
     pTargetInfo->GetGpuProperty().tessFactorBufferSizePerSe = 8192;
     pTargetInfo->GetGpuProperty().supportSpiPrefPriority = true;
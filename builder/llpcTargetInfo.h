@@ -59,6 +59,10 @@ struct GpuProperty
     uint32_t maxSgprsAvailable;                 // Number of max available SGPRs
     uint32_t maxVgprsAvailable;                 // Number of max available VGPRs
     uint32_t tessFactorBufferSizePerSe;         // Size of the tessellation-factor buffer per SE, in DWORDs.
+    uint32_t numSimdsPerCu;                     // Number of SIMDs per compute unit
+    uint32_t maxWavesPerSimd;                   // Max number of waves resident on a SIMD
+    uint32_t vgprFileSizePerSimd;               // Size of the VGPR file of a SIMD, in DWORDs (VGPRs x lanes)
+    uint32_t vgprAllocGranularity;              // VGPR allocation granularity of a wave, in DWORDs (VGPRs x lanes)
 #if LLPC_BUILD_GFX10
     bool     supportShaderPowerProfiling;       // Hardware supports Shader Profiling for Power
     bool     supportSpiPrefPriority;            // Hardware supports SPI shader preference priority
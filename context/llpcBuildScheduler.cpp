@@ -0,0 +1,182 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcBuildScheduler.cpp
+ * @brief LLPC source file: contains implementation of class Llpc::BuildScheduler.
+ ***********************************************************************************************************************
+ */
+#include "llvm/Support/CommandLine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "llpcBuildScheduler.h"
+
+#define DEBUG_TYPE "llpc-build-scheduler"
+
+using namespace llvm;
+
+// -max-concurrent-builds: maximum count of pipeline builds that run at once, 0 means the count of hardware threads
+static cl::opt<uint32_t> MaxConcurrentBuilds("max-concurrent-builds",
+                                             cl::desc("Maximum count of pipeline builds that run at once "
+                                                      "(0 means the count of hardware threads)"),
+                                             cl::init(0));
+
+namespace Llpc
+{
+
+// Count of later builds that may start ahead of a pending build before it starts next regardless
+static const uint32_t MaxBypassCount = 8;
+
+// Interval to poll the cancellation token of a pending build
+static const std::chrono::milliseconds CancelPollInterval(10);
+
+// =====================================================================================================================
+// Gets the process-wide build scheduler.
+BuildScheduler* BuildScheduler::Get()
+{
+    static BuildScheduler scheduler;
+    return &scheduler;
+}
+
+// =====================================================================================================================
+// Checks whether a pending build should start ahead of another one.
+bool BuildScheduler::IsAhead(
+    const Ticket& lhs,  // [in] Ticket of one pending build
+    const Ticket& rhs)  // [in] Ticket of another pending build
+{
+    bool lhsStarved = (lhs.bypassCount >= MaxBypassCount);
+    bool rhsStarved = (rhs.bypassCount >= MaxBypassCount);
+    if (lhsStarved != rhsStarved)
+    {
+        return lhsStarved;
+    }
+
+    if (lhsStarved == false)
+    {
+        if (lhs.priority != rhs.priority)
+        {
+            return (lhs.priority > rhs.priority);
+        }
+        if (lhs.cost != rhs.cost)
+        {
+            return (lhs.cost < rhs.cost);
+        }
+    }
+    return (lhs.sequence < rhs.sequence);
+}
+
+// =====================================================================================================================
+// Checks whether the specified pending build is the one to start next. The scheduler lock must be held.
+bool BuildScheduler::IsNext(
+    const Ticket* pTicket   // [in] Ticket of the pending build
+    ) const
+{
+    for (const Ticket* pOther : m_waitingTickets)
+    {
+        if ((pOther != pTicket) && IsAhead(*pOther, *pTicket))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// =====================================================================================================================
+// Waits until the specified build may start, and counts it as running. Each successful call must be paired with a
+// call of Leave() once the build has finished.
+//
+// Returns false, without counting the build as running, if the client cancels the build while it waits. The deadline
+// of the build only starts once it is running.
+bool BuildScheduler::Enter(
+    const PipelineBuildControl& buildControl,   // [in] Priority and cancellation token of the build
+    uint32_t                    cost)           // Predicted compile cost of the build
+{
+    uint32_t maxRunningCount = MaxConcurrentBuilds;
+    if (maxRunningCount == 0)
+    {
+        maxRunningCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    Ticket ticket = {};
+    ticket.priority = buildControl.priority;
+    ticket.cost = cost;
+    ticket.sequence = m_nextSequence++;
+    m_waitingTickets.push_back(&ticket);
+
+    bool canceled = false;
+    while ((m_runningCount >= maxRunningCount) || (IsNext(&ticket) == false))
+    {
+        if ((buildControl.pCancelFlag != nullptr) && (*buildControl.pCancelFlag != 0))
+        {
+            canceled = true;
+            break;
+        }
+
+        if (buildControl.pCancelFlag != nullptr)
+        {
+            m_wakeup.wait_for(lock, CancelPollInterval);
+        }
+        else
+        {
+            m_wakeup.wait(lock);
+        }
+    }
+
+    m_waitingTickets.erase(std::find(m_waitingTickets.begin(), m_waitingTickets.end(), &ticket));
+
+    if (canceled == false)
+    {
+        // Builds that arrived earlier but are still pending have been passed over by this one.
+        for (Ticket* pOther : m_waitingTickets)
+        {
+            if (pOther->sequence < ticket.sequence)
+            {
+                ++pOther->bypassCount;
+            }
+        }
+        ++m_runningCount;
+    }
+
+    // The next pending build may be able to start too, or may have changed if this one was canceled.
+    m_wakeup.notify_all();
+    return (canceled == false);
+}
+
+// =====================================================================================================================
+// Counts a build that was started by Enter() as finished, and lets the next pending build start.
+void BuildScheduler::Leave()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+    LLPC_ASSERT(m_runningCount > 0);
+    --m_runningCount;
+    m_wakeup.notify_all();
+}
+
+} // Llpc
@@ -0,0 +1,82 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcBuildScheduler.h
+ * @brief LLPC header file: contains declaration of class Llpc::BuildScheduler.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "llpc.h"
+#include "llpcDebug.h"
+
+namespace Llpc
+{
+
+// =====================================================================================================================
+// Represents the process-wide scheduler of pipeline builds. It bounds the count of builds that run at once, and so the
+// count of LLPC contexts in use. When more builds are pending than may run, higher-priority builds start first, then
+// those with lower predicted compile cost, so that a few expensive pipelines do not hold up many cheap ones. A build
+// that has been passed over too many times starts next regardless, so expensive builds are not starved.
+class BuildScheduler
+{
+public:
+    static BuildScheduler* Get();
+
+    bool Enter(const PipelineBuildControl& buildControl, uint32_t cost);
+    void Leave();
+
+private:
+    LLPC_DISALLOW_COPY_AND_ASSIGN(BuildScheduler);
+
+    BuildScheduler() : m_runningCount(0), m_nextSequence(0) {}
+
+    // Represents a build that waits to start
+    struct Ticket
+    {
+        uint32_t priority;      // Scheduling priority, higher starts first
+        uint32_t cost;          // Predicted compile cost, lower starts first
+        uint64_t sequence;      // Arrival order, earlier starts first
+        uint32_t bypassCount;   // Count of later builds that have started ahead of this one
+    };
+
+    static bool IsAhead(const Ticket& lhs, const Ticket& rhs);
+    bool IsNext(const Ticket* pTicket) const;
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    std::mutex              m_lock;             // Lock of the scheduler state
+    std::condition_variable m_wakeup;           // Signaled when a build starts or finishes
+    std::vector<Ticket*>    m_waitingTickets;   // Tickets of builds that wait to start
+    uint32_t                m_runningCount;     // Count of builds that are running
+    uint64_t                m_nextSequence;     // Arrival order of the next build
+};
+
+} // Llpc
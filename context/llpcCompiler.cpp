@@ -48,6 +48,7 @@
 #include "SPIRVInternal.h"
 
 #include "llpcBuilder.h"
+#include "llpcBuildScheduler.h"
 #include "llpcCodeGenManager.h"
 #include "llpcCompiler.h"
 #include "llpcComputeContext.h"
@@ -67,6 +68,7 @@
 #include "llpcSpirvLowerResourceCollect.h"
 #include "llpcTargetInfo.h"
 #include "llpcTimerProfiler.h"
+#include "llpcTuningProfile.h"
 #include "llpcVertexFetch.h"
 #include <mutex>
 #include <set>
@@ -134,9 +136,6 @@ opt<uint32_t> ShadowDescTablePtrHigh("shadow-desc-table-ptr-high",
 opt<bool> EnableDynamicLoopUnroll("enable-dynamic-loop-unroll", desc("Enable dynamic loop unroll (deprecated)"), init(false));
 #endif
 
-// -force-loop-unroll-count: Force to set the loop unroll count.
-opt<int> ForceLoopUnrollCount("force-loop-unroll-count", cl::desc("Force loop unroll count"), init(0));
-
 // -enable-shader-module-opt: Enable translate & lower phase in shader module build.
 opt<bool> EnableShaderModuleOpt("enable-shader-module-opt",
                                 cl::desc("Enable translate & lower phase in shader module build."),
@@ -184,6 +183,7 @@ enum ShaderReplaceMode
 
 static ManagedStatic<sys::Mutex> s_compilerMutex;
 static MetroHash::Hash s_optionHash = {};
+static bool s_isOptionParsed = false;   // Whether LLVM options have been parsed before
 
 uint32_t Compiler::m_instanceCount = 0;
 uint32_t Compiler::m_outRedirectCount = 0;
@@ -201,6 +201,14 @@ static void FatalErrorHandler(
 #endif
 }
 
+// =====================================================================================================================
+// Checks whether the client has already canceled a pipeline build.
+static bool IsBuildCanceled(
+    const PipelineBuildControl& buildControl)   // [in] Cancellation token and deadline of the build
+{
+    return (buildControl.pCancelFlag != nullptr) && (*buildControl.pCancelFlag != 0);
+}
+
 // =====================================================================================================================
 // Handler for diagnosis in pass run, derived from the standard one.
 class LlpcDiagnosticHandler : public llvm::DiagnosticHandler
@@ -246,17 +254,29 @@ Result VKAPI_CALL ICompiler::Create(
 
     raw_null_ostream nullStream;
 
+    // LLPC-owned options are held per compiler. Only the remaining options go to the process-global LLVM option
+    // state, so only those have to agree across compiler instances.
+    CompilerOptions compilerOptions = {};
+    std::vector<const char*> globalOptions;
+
     std::lock_guard<sys::Mutex> lock(*s_compilerMutex);
+    if (ParseCompilerOptions(optionCount, options, &compilerOptions, &globalOptions) == false)
+    {
+        result = Result::ErrorInvalidValue;
+    }
+
     MetroHash::Hash optionHash = Compiler::GenerateHashForCompileOptions(optionCount, options);
+    MetroHash::Hash globalOptionHash = Compiler::GenerateHashForCompileOptions(globalOptions.size(),
+                                                                               globalOptions.data());
 
     // Initialize passes so they can be referenced by -print-after etc.
     InitializeLowerPasses(*PassRegistry::getPassRegistry());
     BuilderContext::Initialize();
 
-    bool parseCmdOption = true;
-    if (Compiler::GetInstanceCount() > 0)
+    bool parseCmdOption = (result == Result::Success);
+    if (parseCmdOption && ((Compiler::GetInstanceCount() > 0) || s_isOptionParsed))
     {
-        bool isSameOption = memcmp(&optionHash, &s_optionHash, sizeof(optionHash)) == 0;
+        bool isSameOption = memcmp(&globalOptionHash, &s_optionHash, sizeof(globalOptionHash)) == 0;
 
         parseCmdOption = false;
         if (isSameOption == false)
@@ -283,19 +303,22 @@ Result VKAPI_CALL ICompiler::Create(
     if (parseCmdOption)
     {
         // LLVM command options can't be parsed multiple times
-        if (cl::ParseCommandLineOptions(optionCount,
-                                        options,
+        s_isOptionParsed = true;
+        if (cl::ParseCommandLineOptions(globalOptions.size(),
+                                        globalOptions.data(),
                                         "AMD LLPC compiler",
                                         ignoreErrors ? &nullStream : nullptr) == false)
         {
+            // Options may be partially applied, so make sure the next compiler parses its options again.
+            s_optionHash = {};
             result = Result::ErrorInvalidValue;
         }
     }
 
     if (result == Result::Success)
     {
-        s_optionHash = optionHash;
-        *ppCompiler = new Compiler(gfxIp, optionCount, options, s_optionHash);
+        s_optionHash = globalOptionHash;
+        *ppCompiler = new Compiler(gfxIp, optionCount, options, optionHash, compilerOptions);
         LLPC_ASSERT(*ppCompiler != nullptr);
     }
     else
@@ -315,14 +338,165 @@ bool VKAPI_CALL ICompiler::IsVertexFormatSupported(
     return ((pInfo->dfmt == BUF_DATA_FORMAT_INVALID) && (pInfo->numChannels == 0)) ? false : true;
 }
 
+// =====================================================================================================================
+// Extracts resource usage statistics from a compiled pipeline ELF binary. Register counts, LDS and scratch sizes and
+// wave size come from the hardware stages in the PAL metadata note; code sizes come from the entry-point symbols and
+// the .text section.
+Result VKAPI_CALL ICompiler::GetPipelineStatistics(
+    GfxIpVersion        gfxIp,          // Graphics IP version info
+    const BinaryData&   pipelineBin,    // [in] Pipeline ELF binary
+    PipelineStatistics* pStats)         // [out] Statistics of the pipeline
+{
+    // Entry-point symbol of each hardware stage, in HwShaderStage order.
+    static const Util::Abi::PipelineSymbolType EntrySymbolTypes[] =
+    {
+        Util::Abi::PipelineSymbolType::LsMainEntry,
+        Util::Abi::PipelineSymbolType::HsMainEntry,
+        Util::Abi::PipelineSymbolType::EsMainEntry,
+        Util::Abi::PipelineSymbolType::GsMainEntry,
+        Util::Abi::PipelineSymbolType::VsMainEntry,
+        Util::Abi::PipelineSymbolType::PsMainEntry,
+        Util::Abi::PipelineSymbolType::CsMainEntry,
+    };
+    static_assert(sizeof(EntrySymbolTypes) / sizeof(EntrySymbolTypes[0]) == HwShaderStageCount, "Unexpected size");
+    static_assert(sizeof(HwStageNames) / sizeof(HwStageNames[0]) == HwShaderStageCount, "Unexpected size");
+
+    if ((pStats == nullptr) || (pipelineBin.pCode == nullptr))
+    {
+        return Result::ErrorInvalidPointer;
+    }
+
+    *pStats = {};
+
+    ElfReader<Elf64> reader(gfxIp);
+    size_t readSize = pipelineBin.codeSize;
+    Result result = reader.ReadFromBuffer(pipelineBin.pCode, &readSize);
+
+    if ((result == Result::Success) && (reader.IsSectionPresent(NoteName) == false))
+    {
+        result = Result::ErrorInvalidValue;
+    }
+
+    msgpack::Document document;
+    if (result == Result::Success)
+    {
+        const ElfNote metadataNote = reader.GetNote(Util::Abi::PipelineAbiNoteType::PalMetadata);
+        if ((metadataNote.pData == nullptr) ||
+            (document.readFromBlob(StringRef(reinterpret_cast<const char*>(metadataNote.pData),
+                                             metadataNote.hdr.descSize),
+                                   false) == false))
+        {
+            result = Result::ErrorInvalidValue;
+        }
+    }
+
+    // Look up amdpal.pipelines[0].hardware_stages without changing the document, so that malformed metadata is
+    // reported rather than read as zero usage.
+    msgpack::MapDocNode* pHwStagesNode = nullptr;
+    if ((result == Result::Success) && (document.getRoot().getKind() == msgpack::Type::Map))
+    {
+        auto& rootNode = document.getRoot().getMap();
+        auto pipelinesIt = rootNode.find(StringRef(Util::Abi::PalCodeObjectMetadataKey::Pipelines));
+        if ((pipelinesIt != rootNode.end()) &&
+            (pipelinesIt->second.getKind() == msgpack::Type::Array) &&
+            (pipelinesIt->second.getArray().empty() == false) &&
+            (pipelinesIt->second.getArray()[0].getKind() == msgpack::Type::Map))
+        {
+            auto& pipelineNode = pipelinesIt->second.getArray()[0].getMap();
+            auto hwStagesIt = pipelineNode.find(StringRef(Util::Abi::PipelineMetadataKey::HardwareStages));
+            if ((hwStagesIt != pipelineNode.end()) && (hwStagesIt->second.getKind() == msgpack::Type::Map))
+            {
+                pHwStagesNode = &hwStagesIt->second.getMap();
+            }
+        }
+    }
+
+    if ((result == Result::Success) && (pHwStagesNode == nullptr))
+    {
+        result = Result::ErrorInvalidValue;
+    }
+
+    if (result == Result::Success)
+    {
+        // Gets an unsigned integer value from a metadata map, or 0 if it is absent.
+        auto getUInt = [](msgpack::MapDocNode& map, const char* pKey) -> uint32_t
+        {
+            auto it = map.find(StringRef(pKey));
+            if (it == map.end())
+            {
+                return 0;
+            }
+            if (it->second.getKind() == msgpack::Type::UInt)
+            {
+                return static_cast<uint32_t>(it->second.getUInt());
+            }
+            return (it->second.getKind() == msgpack::Type::Int) ? static_cast<uint32_t>(it->second.getInt()) : 0;
+        };
+
+        for (uint32_t hwStage = 0; hwStage < HwShaderStageCount; ++hwStage)
+        {
+            auto it = pHwStagesNode->find(StringRef(HwStageNames[hwStage]));
+            if ((it == pHwStagesNode->end()) || (it->second.getKind() != msgpack::Type::Map))
+            {
+                continue;
+            }
+
+            auto& hwStageNode = it->second.getMap();
+            HwShaderStatistics& stats = pStats->hwStages[hwStage];
+            stats.valid             = true;
+            stats.vgprCount         = getUInt(hwStageNode, Util::Abi::HardwareStageMetadataKey::VgprCount);
+            stats.sgprCount         = getUInt(hwStageNode, Util::Abi::HardwareStageMetadataKey::SgprCount);
+            stats.vgprLimit         = getUInt(hwStageNode, Util::Abi::HardwareStageMetadataKey::VgprLimit);
+            stats.sgprLimit         = getUInt(hwStageNode, Util::Abi::HardwareStageMetadataKey::SgprLimit);
+            stats.ldsSize           = getUInt(hwStageNode, Util::Abi::HardwareStageMetadataKey::LdsSize);
+            stats.scratchMemorySize = getUInt(hwStageNode, Util::Abi::HardwareStageMetadataKey::ScratchMemorySize);
+            stats.wavefrontSize     = 64;
+#if LLPC_BUILD_GFX10 && (PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 495)
+            const uint32_t waveSize = getUInt(hwStageNode, Util::Abi::HardwareStageMetadataKey::WavefrontSize);
+            if (waveSize != 0)
+            {
+                stats.wavefrontSize = waveSize;
+            }
+#endif
+        }
+
+        // Code sizes come from the symbol table: the size of each stage's entry point, and the whole .text section.
+        for (uint32_t symIdx = 0, symCount = reader.GetSymbolCount(); symIdx < symCount; ++symIdx)
+        {
+            ElfSymbol symbol = {};
+            reader.GetSymbol(symIdx, &symbol);
+            for (uint32_t hwStage = 0; hwStage < HwShaderStageCount; ++hwStage)
+            {
+                const char* pEntryName =
+                    Util::Abi::PipelineAbiSymbolNameStrings[static_cast<uint32_t>(EntrySymbolTypes[hwStage])];
+                if ((symbol.pSymName != nullptr) && (strcmp(symbol.pSymName, pEntryName) == 0))
+                {
+                    pStats->hwStages[hwStage].isaSize = symbol.size;
+                }
+            }
+        }
+
+        const void* pTextData = nullptr;
+        size_t textSize = 0;
+        if (reader.GetSectionData(TextName, &pTextData, &textSize) == Result::Success)
+        {
+            pStats->isaSize = textSize;
+        }
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 Compiler::Compiler(
-    GfxIpVersion      gfxIp,        // Graphics IP version info
-    uint32_t          optionCount,  // Count of compilation-option strings
-    const char*const* pOptions,     // [in] An array of compilation-option strings
-    MetroHash::Hash   optionHash)   // Hash code of compilation options
+    GfxIpVersion           gfxIp,           // Graphics IP version info
+    uint32_t               optionCount,     // Count of compilation-option strings
+    const char*const*      pOptions,        // [in] An array of compilation-option strings
+    MetroHash::Hash        optionHash,      // Hash code of compilation options
+    const CompilerOptions& compilerOptions) // [in] LLPC-owned options of this compiler
     :
     m_optionHash(optionHash),
+    m_compilerOptions(compilerOptions),
     m_gfxIp(gfxIp)
 {
     for (uint32_t i = 0; i < optionCount; ++i)
@@ -439,6 +613,19 @@ Compiler::~Compiler()
     }
 }
 
+// =====================================================================================================================
+// Keeps process-wide LLVM state alive after the last compiler instance is destroyed. This is for long-lived clients
+// (e.g. the compile server of amdllpc) that destroy a compiler to create one with different options: it is counted as
+// a compiler instance that is never destroyed, so the options can be reset while LLVM stays initialized.
+//
+// NOTE: It must be called while a compiler instance exists.
+void Compiler::KeepResident()
+{
+    std::lock_guard<sys::Mutex> lock(*s_compilerMutex);
+    LLPC_ASSERT(m_instanceCount > 0);
+    ++m_instanceCount;
+}
+
 // =====================================================================================================================
 // Destroys the pipeline compiler.
 void Compiler::Destroy()
@@ -631,7 +818,7 @@ Result Compiler::BuildShaderModule(
                                           static_cast<ShaderStage>(entryNames[i].stage),
                                           *lowerPassMgr,
                                           timerProfiler.GetTimer(TimerLower),
-                                          cl::ForceLoopUnrollCount);
+                                          m_compilerOptions.forceLoopUnrollCount);
 
                     lowerPassMgr->add(createBitcodeWriterPass(moduleBinaryStream));
 
@@ -830,7 +1017,7 @@ Result Compiler::BuildShaderModule(
 Result Compiler::BuildPipelineInternal(
     Context*                            pContext,                   // [in] Acquired context
     ArrayRef<const PipelineShaderInfo*> shaderInfo,                 // [in] Shader info of this pipeline
-    uint32_t                            forceLoopUnrollCount,       // [in] Force loop unroll count (0 means disable)
+    const CompilerOptions&              compilerOptions,            // [in] Compiler options of this pipeline
     ElfPackage*                         pPipelineElf)               // [out] Output Elf package
 {
     Result          result = Result::Success;
@@ -838,6 +1025,12 @@ Result Compiler::BuildPipelineInternal(
     uint32_t passIndex = 0;
     TimerProfiler timerProfiler(pContext->GetPiplineHashCode(), "LLPC", TimerProfiler::PipelineTimerEnableMask);
 
+    // Arm the cancellation token and deadline of this build. They are checked at pass boundaries by the gate, and
+    // between the compile phases below.
+    BuildCancelGate& cancelGate = pContext->GetBuildCancelGate();
+    const PipelineBuildControl* pBuildControl = pContext->GetPipelineContext()->GetBuildControl();
+    cancelGate.Arm(pBuildControl->pCancelFlag, pBuildControl->timeoutMs);
+
     pContext->setDiagnosticHandler(std::make_unique<LlpcDiagnosticHandler>());
 
     // Set a couple of pipeline options for front-end use.
@@ -853,7 +1046,7 @@ Result Compiler::BuildPipelineInternal(
     // Set up middle-end objects.
     BuilderContext* pBuilderContext = pContext->GetBuilderContext();
     std::unique_ptr<Pipeline> pipeline(pBuilderContext->CreatePipeline());
-    pContext->GetPipelineContext()->SetPipelineState(&*pipeline);
+    pContext->GetPipelineContext()->SetPipelineState(&*pipeline, compilerOptions);
     pContext->SetBuilder(pBuilderContext->CreateBuilder(&*pipeline, UseBuilderRecorder));
 
     std::unique_ptr<Module> pipelineModule;
@@ -960,6 +1153,12 @@ Result Compiler::BuildPipelineInternal(
                 continue;
             }
 
+            if (cancelGate.IsCancelled())
+            {
+                result = Result::ErrorCanceled;
+                break;
+            }
+
             std::unique_ptr<PassManager> lowerPassMgr(PassManager::Create());
             lowerPassMgr->SetPassIndex(&passIndex);
 
@@ -1004,6 +1203,12 @@ Result Compiler::BuildPipelineInternal(
                 continue;
             }
 
+            if (cancelGate.IsCancelled())
+            {
+                result = Result::ErrorCanceled;
+                break;
+            }
+
             pContext->GetBuilder()->SetShaderStage(entryStage);
             std::unique_ptr<PassManager> lowerPassMgr(PassManager::Create());
             lowerPassMgr->SetPassIndex(&passIndex);
@@ -1012,7 +1217,7 @@ Result Compiler::BuildPipelineInternal(
                                   entryStage,
                                   *lowerPassMgr,
                                   timerProfiler.GetTimer(TimerLower),
-                                  forceLoopUnrollCount);
+                                  compilerOptions.forceLoopUnrollCount);
             // Run the passes.
             bool success = RunPasses(&*lowerPassMgr, modules[shaderIndex]);
             if (success == false)
@@ -1055,6 +1260,11 @@ Result Compiler::BuildPipelineInternal(
     // Generate pipeline.
     raw_svector_ostream elfStream(*pPipelineElf);
 
+    if ((result == Result::Success) && cancelGate.IsCancelled())
+    {
+        result = Result::ErrorCanceled;
+    }
+
     if (result == Result::Success)
     {
         result = Result::ErrorInvalidShader;
@@ -1078,6 +1288,13 @@ Result Compiler::BuildPipelineInternal(
 #endif
     }
 
+    // NOTE: Once the build has been abandoned, passes may have been skipped, so the output must not be used or cached.
+    if (cancelGate.HasCancelled())
+    {
+        result = Result::ErrorCanceled;
+    }
+    cancelGate.Disarm();
+
     if (checkPerStageCache)
     {
         // For graphics, update shader caches with results of compile, and merge ELF outputs if necessary.
@@ -1317,14 +1534,22 @@ uint32_t Compiler::ConvertColorBufferFormatToExportFormat(
 Result Compiler::BuildGraphicsPipelineInternal(
     GraphicsContext*                    pGraphicsContext,           // [in] Graphics context this graphics pipeline
     ArrayRef<const PipelineShaderInfo*> shaderInfo,                 // Shader info of this graphics pipeline
-    uint32_t                            forceLoopUnrollCount,       // [in] Force loop unroll count (0 means disable)
+    const CompilerOptions&              compilerOptions,            // [in] Compiler options of this pipeline
     ElfPackage*                         pPipelineElf)               // [out] Output Elf package
 {
-    Context* pContext = AcquireContext();
-    pContext->AttachPipelineContext(pGraphicsContext);
+    Result result = Result::ErrorCanceled;
 
-    Result result = BuildPipelineInternal(pContext, shaderInfo, forceLoopUnrollCount, pPipelineElf);
-    ReleaseContext(pContext);
+    // NOTE: Builds queue for a context in the build scheduler, which starts cheap or urgent builds first.
+    BuildScheduler* pScheduler = BuildScheduler::Get();
+    if (pScheduler->Enter(*pGraphicsContext->GetBuildControl(), EstimatePipelineCost(shaderInfo)))
+    {
+        Context* pContext = AcquireContext();
+        pContext->AttachPipelineContext(pGraphicsContext);
+
+        result = BuildPipelineInternal(pContext, shaderInfo, compilerOptions, pPipelineElf);
+        ReleaseContext(pContext);
+        pScheduler->Leave();
+    }
     return result;
 }
 
@@ -1357,11 +1582,15 @@ Result Compiler::BuildGraphicsPipeline(
     cacheHash = PipelineDumper::GenerateHashForGraphicsPipeline(pPipelineInfo, true);
     pipelineHash = PipelineDumper::GenerateHashForGraphicsPipeline(pPipelineInfo, false);
 
+    CompilerOptions compilerOptions = m_compilerOptions;
+    TuningProfile* pTuningProfile = SelectTuningOptions(&pipelineHash, true, &compilerOptions, &cacheHash);
+
     if ((result == Result::Success) && EnableOuts())
     {
         LLPC_OUTS("===============================================================================\n");
         LLPC_OUTS("// LLPC calculated hash results (graphics pipline)\n\n");
         LLPC_OUTS("PIPE : " << format("0x%016" PRIX64, MetroHash::Compact64(&pipelineHash)) << "\n");
+        LLPC_OUTS("COST : " << EstimatePipelineCost(shaderInfo) << "\n");
         for (uint32_t stage = 0; stage < ShaderStageGfxCount; ++stage)
         {
             const ShaderModuleData* pModuleData =
@@ -1393,32 +1622,46 @@ Result Compiler::BuildGraphicsPipeline(
     constexpr uint32_t ShaderCacheCount = 2;
     ShaderCache*     pShaderCache[ShaderCacheCount]  = { nullptr, nullptr };
     CacheEntryHandle hEntry[ShaderCacheCount]        = { nullptr, nullptr };
-
-    cacheEntryState = LookUpShaderCaches(pPipelineInfo->pShaderCache, &cacheHash, &elfBin, pShaderCache, hEntry);
 #else
     CacheEntryHandle hEntry = nullptr;
-    cacheEntryState = LookUpShaderCache(&cacheHash, &elfBin, &hEntry);
 #endif
 
+    // NOTE: A build that is canceled before it starts neither reserves a shader cache entry nor acquires a context.
+    if (IsBuildCanceled(pPipelineInfo->buildControl))
+    {
+        result = Result::ErrorCanceled;
+    }
+    else
+    {
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 38
+        cacheEntryState = LookUpShaderCaches(pPipelineInfo->pShaderCache, &cacheHash, &elfBin, pShaderCache, hEntry);
+#else
+        cacheEntryState = LookUpShaderCache(&cacheHash, &elfBin, &hEntry);
+#endif
+    }
+
     ElfPackage candidateElf;
 
     if (cacheEntryState == ShaderEntryState::Compiling)
     {
-        uint32_t                      forceLoopUnrollCount = cl::ForceLoopUnrollCount;
-
         GraphicsContext graphicsContext(m_gfxIp,
                                         pPipelineInfo,
                                         &pipelineHash,
                                         &cacheHash);
         result = BuildGraphicsPipelineInternal(&graphicsContext,
                                                shaderInfo,
-                                               forceLoopUnrollCount,
+                                               compilerOptions,
                                                &candidateElf);
 
         if (result == Result::Success)
         {
             elfBin.codeSize = candidateElf.size();
             elfBin.pCode = candidateElf.data();
+
+            if (pTuningProfile != nullptr)
+            {
+                pTuningProfile->Record(MetroHash::Compact64(&pipelineHash), compilerOptions, m_gfxIp, elfBin);
+            }
         }
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 38
         UpdateShaderCaches((result == Result::Success), &elfBin, pShaderCache, hEntry, ShaderCacheCount);
@@ -1455,12 +1698,9 @@ Result Compiler::BuildGraphicsPipeline(
 Result Compiler::BuildComputePipelineInternal(
     ComputeContext*                 pComputeContext,                // [in] Compute context this compute pipeline
     const ComputePipelineBuildInfo* pPipelineInfo,                  // [in] Pipeline info of this compute pipeline
-    uint32_t                        forceLoopUnrollCount,           // [in] Force loop unroll count (0 means disable)
+    const CompilerOptions&          compilerOptions,                // [in] Compiler options of this pipeline
     ElfPackage*                     pPipelineElf)                   // [out] Output Elf package
 {
-    Context* pContext = AcquireContext();
-    pContext->AttachPipelineContext(pComputeContext);
-
     const PipelineShaderInfo* shaderInfo[ShaderStageNativeStageCount] =
     {
         nullptr,
@@ -1471,8 +1711,19 @@ Result Compiler::BuildComputePipelineInternal(
         &pPipelineInfo->cs,
     };
 
-    Result result = BuildPipelineInternal(pContext, shaderInfo, forceLoopUnrollCount, pPipelineElf);
-    ReleaseContext(pContext);
+    Result result = Result::ErrorCanceled;
+
+    // NOTE: Builds queue for a context in the build scheduler, which starts cheap or urgent builds first.
+    BuildScheduler* pScheduler = BuildScheduler::Get();
+    if (pScheduler->Enter(pPipelineInfo->buildControl, EstimatePipelineCost(shaderInfo)))
+    {
+        Context* pContext = AcquireContext();
+        pContext->AttachPipelineContext(pComputeContext);
+
+        result = BuildPipelineInternal(pContext, shaderInfo, compilerOptions, pPipelineElf);
+        ReleaseContext(pContext);
+        pScheduler->Leave();
+    }
     return result;
 }
 
@@ -1498,13 +1749,19 @@ Result Compiler::BuildComputePipeline(
     cacheHash = PipelineDumper::GenerateHashForComputePipeline(pPipelineInfo, true);
     pipelineHash = PipelineDumper::GenerateHashForComputePipeline(pPipelineInfo, false);
 
+    CompilerOptions compilerOptions = m_compilerOptions;
+    TuningProfile* pTuningProfile = SelectTuningOptions(&pipelineHash, false, &compilerOptions, &cacheHash);
+
     if ((result == Result::Success) && EnableOuts())
     {
         const ShaderModuleData* pModuleData = reinterpret_cast<const ShaderModuleData*>(pPipelineInfo->cs.pModuleData);
         auto pModuleHash = reinterpret_cast<const MetroHash::Hash*>(&pModuleData->hash[0]);
+        const PipelineShaderInfo* shaderInfo[ShaderStageNativeStageCount] = {};
+        shaderInfo[ShaderStageCompute] = &pPipelineInfo->cs;
         LLPC_OUTS("\n===============================================================================\n");
         LLPC_OUTS("// LLPC calculated hash results (compute pipline)\n\n");
         LLPC_OUTS("PIPE : " << format("0x%016" PRIX64, MetroHash::Compact64(&pipelineHash)) << "\n");
+        LLPC_OUTS("COST : " << EstimatePipelineCost(shaderInfo) << "\n");
         LLPC_OUTS(format("%-4s : ", GetShaderStageAbbreviation(ShaderStageCompute, true)) <<
                   format("0x%016" PRIX64, MetroHash::Compact64(pModuleHash)) << "\n");
         LLPC_OUTS("\n");
@@ -1527,19 +1784,28 @@ Result Compiler::BuildComputePipeline(
     constexpr uint32_t ShaderCacheCount = 2;
     ShaderCache* pShaderCache[ShaderCacheCount] = { nullptr, nullptr };
     CacheEntryHandle hEntry[ShaderCacheCount] = { nullptr, nullptr };
-
-    cacheEntryState = LookUpShaderCaches(pPipelineInfo->pShaderCache, &cacheHash, &elfBin, pShaderCache, hEntry);
 #else
     CacheEntryHandle hEntry = nullptr;
-    cacheEntryState = LookUpShaderCache(&cacheHash, &elfBin, &hEntry);
 #endif
 
+    // NOTE: A build that is canceled before it starts neither reserves a shader cache entry nor acquires a context.
+    if (IsBuildCanceled(pPipelineInfo->buildControl))
+    {
+        result = Result::ErrorCanceled;
+    }
+    else
+    {
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 38
+        cacheEntryState = LookUpShaderCaches(pPipelineInfo->pShaderCache, &cacheHash, &elfBin, pShaderCache, hEntry);
+#else
+        cacheEntryState = LookUpShaderCache(&cacheHash, &elfBin, &hEntry);
+#endif
+    }
+
     ElfPackage candidateElf;
 
     if (cacheEntryState == ShaderEntryState::Compiling)
     {
-        uint32_t                      forceLoopUnrollCount = cl::ForceLoopUnrollCount;
-
         ComputeContext computeContext(m_gfxIp,
                                       pPipelineInfo,
                                       &pipelineHash,
@@ -1547,13 +1813,18 @@ Result Compiler::BuildComputePipeline(
 
         result = BuildComputePipelineInternal(&computeContext,
                                               pPipelineInfo,
-                                              forceLoopUnrollCount,
+                                              compilerOptions,
                                               &candidateElf);
 
         if (result == Result::Success)
         {
             elfBin.codeSize = candidateElf.size();
             elfBin.pCode = candidateElf.data();
+
+            if (pTuningProfile != nullptr)
+            {
+                pTuningProfile->Record(MetroHash::Compact64(&pipelineHash), compilerOptions, m_gfxIp, elfBin);
+            }
         }
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 38
         UpdateShaderCaches((result == Result::Success), &elfBin, pShaderCache, hEntry, ShaderCacheCount);
@@ -1591,6 +1862,41 @@ Result Compiler::BuildComputePipeline(
     return result;
 }
 
+// =====================================================================================================================
+// Selects the compiler options of a pipeline from the tuning profile, if one is specified with -tuning-profile. The
+// selected options are folded into the cache hash, so that each tuning configuration of a pipeline has its own cache
+// entry.
+//
+// Returns the tuning profile that the build result should be recorded into, or nullptr if there is none.
+TuningProfile* Compiler::SelectTuningOptions(
+    const MetroHash::Hash* pPipelineHash,       // [in] Pipeline hash code
+    bool                   isGraphics,          // Whether the pipeline is a graphics pipeline
+    CompilerOptions*       pCompilerOptions,    // [in,out] Compiler options of the pipeline
+    MetroHash::Hash*       pCacheHash           // [in,out] Cache hash code of the pipeline
+    ) const
+{
+    if (pCompilerOptions->tuningProfile.empty())
+    {
+        return nullptr;
+    }
+
+    TuningProfile* pTuningProfile = TuningProfile::Get(pCompilerOptions->tuningProfile);
+    pTuningProfile->SelectOptions(MetroHash::Compact64(pPipelineHash), isGraphics, pCompilerOptions);
+
+    MetroHash64 hasher;
+    hasher.Update(pCacheHash->bytes, sizeof(pCacheHash->bytes));
+    hasher.Update(pCompilerOptions->packInOut);
+    hasher.Update(pCompilerOptions->disableGsOnChip);
+    hasher.Update(pCompilerOptions->nggSubgroupCostModel);
+    hasher.Update(pCompilerOptions->forceLoopUnrollCount);
+
+    MetroHash::Hash cacheHash = {};
+    hasher.Finalize(cacheHash.bytes);
+    *pCacheHash = cacheHash;
+
+    return pTuningProfile;
+}
+
 // =====================================================================================================================
 // Builds hash code from compilation-options
 MetroHash::Hash Compiler::GenerateHashForCompileOptions(
@@ -1699,6 +2005,47 @@ Result Compiler::ValidatePipelineShaderInfo(
     return result;
 }
 
+// =====================================================================================================================
+// Estimates the compile cost of a pipeline from the counters that were collected from SPIR-V binaries when the shader
+// modules were built. The cost is in arbitrary units that grow with compile time. amdllpc -pipeline-stats reports it
+// along with the measured compile time, so that the weights below can be refitted against timings of shaderdb.
+uint32_t Compiler::EstimatePipelineCost(
+    ArrayRef<const PipelineShaderInfo*> shaderInfo)     // Shader info of the pipeline, indexed by shader stage
+{
+    static const uint32_t StageCost       = 2000;   // Per stage, for passes that run regardless of shader size
+    static const uint32_t InstructionCost = 10;     // Per instruction in function bodies
+    static const uint32_t LoopCost        = 400;    // Per loop, for loop unrolling and other loop optimizations
+    static const uint32_t FunctionCost    = 200;    // Per function, for inlining
+    static const uint32_t CopyShaderCost  = 1500;   // For the copy shader that comes with a geometry shader
+
+    uint64_t cost = 0;
+    uint32_t stageMask = 0;
+    for (uint32_t stage = 0; stage < shaderInfo.size(); ++stage)
+    {
+        const ShaderModuleData* pModuleData = (shaderInfo[stage] != nullptr) ?
+            reinterpret_cast<const ShaderModuleData*>(shaderInfo[stage]->pModuleData) : nullptr;
+        if (pModuleData == nullptr)
+        {
+            continue;
+        }
+
+        // NOTE: Modules of LLVM IR have no counters, so only their stage cost is counted.
+        const ShaderModuleUsage& usage = pModuleData->usage;
+        stageMask |= ShaderStageToMask(static_cast<ShaderStage>(stage));
+        cost += StageCost +
+                static_cast<uint64_t>(usage.instructionCount) * InstructionCost +
+                static_cast<uint64_t>(usage.loopCount) * LoopCost +
+                static_cast<uint64_t>(usage.functionCount) * FunctionCost;
+    }
+
+    if (stageMask & ShaderStageToMask(ShaderStageGeometry))
+    {
+        cost += CopyShaderCost;
+    }
+
+    return static_cast<uint32_t>(std::min<uint64_t>(cost, UINT32_MAX));
+}
+
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 38
 // =====================================================================================================================
 // Creates shader cache object with the requested properties.
@@ -31,6 +31,7 @@
 #pragma once
 
 #include "llpc.h"
+#include "llpcCompilerOptions.h"
 #include "llpcDebug.h"
 #include "llpcElfReader.h"
 #include "llpcInternal.h"
@@ -48,6 +49,7 @@ class ComputeContext;
 class Context;
 class GraphicsContext;
 class PassManager;
+class TuningProfile;
 
 // =====================================================================================================================
 // Object to manage checking and updating shader cache for graphics pipeline.
@@ -101,7 +103,11 @@ private:
 class Compiler: public ICompiler
 {
 public:
-    Compiler(GfxIpVersion gfxIp, uint32_t optionCount, const char*const* pOptions, MetroHash::Hash optionHash);
+    Compiler(GfxIpVersion           gfxIp,
+             uint32_t               optionCount,
+             const char*const*      pOptions,
+             MetroHash::Hash        optionHash,
+             const CompilerOptions& compilerOptions);
     ~Compiler();
 
     virtual void VKAPI_CALL Destroy();
@@ -121,17 +127,17 @@ public:
                                         void*                           pPipelineDumpFile = nullptr);
     Result BuildGraphicsPipelineInternal(GraphicsContext*                           pGraphicsContext,
                                          llvm::ArrayRef<const PipelineShaderInfo*>  shaderInfo,
-                                         uint32_t                                   forceLoopUnrollCount,
+                                         const CompilerOptions&                     compilerOptions,
                                          ElfPackage*                                pPipelineElf);
 
     Result BuildComputePipelineInternal(ComputeContext*                 pComputeContext,
                                         const ComputePipelineBuildInfo* pPipelineInfo,
-                                        uint32_t                        forceLoopUnrollCount,
+                                        const CompilerOptions&          compilerOptions,
                                         ElfPackage*                     pPipelineElf);
 
     Result BuildPipelineInternal(Context*                                   pContext,
                                  llvm::ArrayRef<const PipelineShaderInfo*>  shaderInfo,
-                                 uint32_t                                   forceLoopUnrollCount,
+                                 const CompilerOptions&                     compilerOptions,
                                  ElfPackage*                                pPipelineElf);
 
     // Gets the count of compiler instance.
@@ -140,9 +146,13 @@ public:
     // Gets the count of redirect output
     static uint32_t GetOutRedirectCount() { return m_outRedirectCount; }
 
+    static void KeepResident();
+
     static MetroHash::Hash GenerateHashForCompileOptions(uint32_t          optionCount,
                                                          const char*const* pOptions);
 
+    static uint32_t EstimatePipelineCost(llvm::ArrayRef<const PipelineShaderInfo*> shaderInfo);
+
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION < 38
     virtual Result CreateShaderCache(const ShaderCacheCreateInfo* pCreateInfo, IShaderCache** ppShaderCache);
 #endif
@@ -184,10 +194,16 @@ private:
     void ReleaseContext(Context* pContext) const;
 
     bool RunPasses(PassManager* pPassMgr, llvm::Module* pModule) const;
+
+    TuningProfile* SelectTuningOptions(const MetroHash::Hash* pPipelineHash,
+                                       bool                   isGraphics,
+                                       CompilerOptions*       pCompilerOptions,
+                                       MetroHash::Hash*       pCacheHash) const;
     // -----------------------------------------------------------------------------------------------------------------
 
     std::vector<std::string>      m_options;          // Compilation options
     MetroHash::Hash               m_optionHash;       // Hash code of compilation options
+    CompilerOptions               m_compilerOptions;  // LLPC-owned options of this compiler instance
     GfxIpVersion                  m_gfxIp;            // Graphics IP version info
     static uint32_t               m_instanceCount;    // The count of compiler instance
     static uint32_t               m_outRedirectCount; // The count of output redirect
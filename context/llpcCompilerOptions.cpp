@@ -0,0 +1,243 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcCompilerOptions.cpp
+ * @brief LLPC source file: contains implementation of LLPC-owned per-compiler options.
+ ***********************************************************************************************************************
+ */
+#include "llvm/Support/CommandLine.h"
+
+#include "llpcCompilerOptions.h"
+
+#define DEBUG_TYPE "llpc-compiler-options"
+
+using namespace llvm;
+
+// NOTE: The options below are registered to LLVM so that they show up in -help, but they are never parsed into their
+// global state. Their values are parsed per compiler instance by ParseCompilerOptions(), and the global state only
+// provides the default values.
+
+// -pack-in-out: pack input/output of all supported stage interfaces, rather than only where it saves locations
+static cl::opt<bool> PackInOut("pack-in-out",
+                               cl::desc("Pack input/output of all supported stage interfaces, rather than only where "
+                                        "it saves locations"),
+                               cl::init(false));
+
+// -disable-pack-in-out-cost-model: only pack input/output if -pack-in-out is on
+static cl::opt<bool> DisablePackInOutCostModel("disable-pack-in-out-cost-model",
+                                               cl::desc("Only pack input/output if -pack-in-out is on, rather than "
+                                                        "where a cost model predicts fewer locations"),
+                                               cl::init(false));
+
+// -disable-gs-onchip: disable geometry shader on-chip mode
+static cl::opt<bool> DisableGsOnChip("disable-gs-onchip",
+                                     cl::desc("Disable geometry shader on-chip mode"),
+                                     cl::init(false));
+
+#if LLPC_BUILD_GFX10
+// -ngg-subgroup-cost-model: choose NGG sub-group size by estimated occupancy when sub-group sizing is "Auto"
+static cl::opt<bool> NggSubgroupCostModel("ngg-subgroup-cost-model",
+                                          cl::desc("Choose NGG sub-group size by estimated occupancy when sub-group "
+                                                   "sizing is \"Auto\""),
+                                          cl::init(false));
+#endif
+
+// -force-loop-unroll-count: Force to set the loop unroll count.
+static cl::opt<int> ForceLoopUnrollCount("force-loop-unroll-count", cl::desc("Force loop unroll count"), cl::init(0));
+
+// -enable-load-scalarizer: Enable the optimization for load scalarizer.
+static cl::opt<bool> EnableScalarLoad("enable-load-scalarizer",
+                                      cl::desc("Enable the optimization for load scalarizer."),
+                                      cl::init(false));
+
+// -scalar-threshold: Set the vector size threshold for load scalarizer.
+static cl::opt<unsigned> ScalarThreshold("scalar-threshold",
+                                         cl::desc("The threshold for load scalarizer"),
+                                         cl::init(UINT32_MAX));
+
+// -tuning-profile: pick per-pipeline options from (and record compile results into) a feedback profile file
+static cl::opt<std::string> TuningProfile("tuning-profile",
+                                          cl::desc("Pick per-pipeline options from (and record compile results into) "
+                                                   "the specified feedback profile file"),
+                                          cl::value_desc("filename"),
+                                          cl::init(""));
+
+// -tuning-profile-explore: compile each pipeline with the tuning configurations not yet in the profile
+static cl::opt<bool> TuningProfileExplore("tuning-profile-explore",
+                                          cl::desc("Compile each pipeline with the tuning configurations not yet "
+                                                   "recorded in the feedback profile"),
+                                          cl::init(false));
+
+// Represents a per-compiler option as specified in the compilation-option strings.
+struct CompilerOptionArg
+{
+    StringRef   name;           // Option name as specified
+    StringRef   value;          // Option value as specified with "=", empty if not specified
+    bool        hasValue;       // Whether the value is specified with "="
+    const char* pNextOption;    // Next option string, nullptr if this is the last one
+    bool        useNextOption;  // Whether the next option string is consumed as the value
+};
+
+// =====================================================================================================================
+// Parses the value of a per-compiler option with the parser of its LLVM option, without touching the global state.
+// Like LLVM, an option that requires a value and has no "=value" takes the next option string as its value.
+// Returns false if the value is invalid.
+template<typename T, typename V>
+static bool ParseCompilerOption(
+    cl::opt<T>&        opt,     // [in] LLVM option that describes the per-compiler option
+    CompilerOptionArg* pArg,    // [in/out] Option as specified
+    V*                 pValue)  // [out] Parsed value
+{
+    StringRef value = pArg->value;
+    if ((pArg->hasValue == false) &&
+        (opt.getValueExpectedFlag() == cl::ValueRequired) &&
+        (pArg->pNextOption != nullptr))
+    {
+        value = pArg->pNextOption;
+        pArg->useNextOption = true;
+    }
+
+    T parsedValue = opt.getValue();
+    if (opt.getParser().parse(opt, pArg->name, value, parsedValue))
+    {
+        // LLVM parsers return true on error
+        return false;
+    }
+    *pValue = parsedValue;
+    return true;
+}
+
+namespace Llpc
+{
+
+// =====================================================================================================================
+// Parses per-compiler options out of the specified compilation-option strings. Options that are not owned per
+// compiler (including the client name in the first string) are returned in pGlobalOptions for LLVM to parse.
+//
+// Returns false if a per-compiler option has an invalid value.
+bool ParseCompilerOptions(
+    uint32_t                  optionCount,      // Count of compilation-option strings
+    const char*const*         pOptions,         // [in] An array of compilation-option strings
+    CompilerOptions*          pCompilerOptions, // [out] Per-compiler options
+    std::vector<const char*>* pGlobalOptions)   // [out] Process-global options
+{
+    CompilerOptions& options = *pCompilerOptions;
+    options = {};
+    options.packInOut = PackInOut;
+    options.disablePackInOutCostModel = DisablePackInOutCostModel;
+    options.disableGsOnChip = DisableGsOnChip;
+#if LLPC_BUILD_GFX10
+    options.nggSubgroupCostModel = NggSubgroupCostModel;
+#endif
+    options.forceLoopUnrollCount = ForceLoopUnrollCount;
+    options.enableLoadScalarizer = EnableScalarLoad;
+    options.scalarThreshold = ScalarThreshold;
+    options.tuningProfile = TuningProfile;
+    options.tuningProfileExplore = TuningProfileExplore;
+
+    bool success = true;
+    pGlobalOptions->clear();
+    for (uint32_t i = 0; i < optionCount; ++i)
+    {
+        StringRef option = pOptions[i];
+        if ((i == 0) || (option.startswith("-") == false))
+        {
+            pGlobalOptions->push_back(pOptions[i]);
+            continue;
+        }
+
+        // Accept both "-name" and "--name", with an optional "=value" or a separate "value".
+        auto nameValue = option.ltrim('-').split('=');
+        CompilerOptionArg arg = {};
+        arg.name = nameValue.first;
+        arg.value = nameValue.second;
+        arg.hasValue = (option.find('=') != StringRef::npos);
+        arg.pNextOption = ((i + 1) < optionCount) ? pOptions[i + 1] : nullptr;
+
+        bool isCompilerOption = true;
+        bool isValid = true;
+        if (arg.name == PackInOut.ArgStr)
+        {
+            isValid = ParseCompilerOption(PackInOut, &arg, &options.packInOut);
+        }
+        else if (arg.name == DisablePackInOutCostModel.ArgStr)
+        {
+            isValid = ParseCompilerOption(DisablePackInOutCostModel, &arg, &options.disablePackInOutCostModel);
+        }
+        else if (arg.name == DisableGsOnChip.ArgStr)
+        {
+            isValid = ParseCompilerOption(DisableGsOnChip, &arg, &options.disableGsOnChip);
+        }
+#if LLPC_BUILD_GFX10
+        else if (arg.name == NggSubgroupCostModel.ArgStr)
+        {
+            isValid = ParseCompilerOption(NggSubgroupCostModel, &arg, &options.nggSubgroupCostModel);
+        }
+#endif
+        else if (arg.name == ForceLoopUnrollCount.ArgStr)
+        {
+            isValid = ParseCompilerOption(ForceLoopUnrollCount, &arg, &options.forceLoopUnrollCount);
+        }
+        else if (arg.name == EnableScalarLoad.ArgStr)
+        {
+            isValid = ParseCompilerOption(EnableScalarLoad, &arg, &options.enableLoadScalarizer);
+        }
+        else if (arg.name == ScalarThreshold.ArgStr)
+        {
+            isValid = ParseCompilerOption(ScalarThreshold, &arg, &options.scalarThreshold);
+        }
+        else if (arg.name == TuningProfile.ArgStr)
+        {
+            isValid = ParseCompilerOption(TuningProfile, &arg, &options.tuningProfile);
+        }
+        else if (arg.name == TuningProfileExplore.ArgStr)
+        {
+            isValid = ParseCompilerOption(TuningProfileExplore, &arg, &options.tuningProfileExplore);
+        }
+        else
+        {
+            isCompilerOption = false;
+        }
+
+        if (isCompilerOption == false)
+        {
+            pGlobalOptions->push_back(pOptions[i]);
+        }
+        else if (isValid == false)
+        {
+            success = false;
+        }
+
+        if (arg.useNextOption)
+        {
+            ++i;
+        }
+    }
+
+    return success;
+}
+
+} // Llpc
@@ -0,0 +1,62 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcCompilerOptions.h
+ * @brief LLPC header file: contains declaration of LLPC-owned per-compiler options.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include "llpc.h"
+
+namespace Llpc
+{
+
+// =====================================================================================================================
+// Represents LLPC-owned compilation options that are held by each compiler instance, rather than by process-global
+// LLVM option state. Compilers created with different values of these options can coexist in one process.
+struct CompilerOptions
+{
+    bool     packInOut;             // Always pack input/output (-pack-in-out)
+    bool     disablePackInOutCostModel; // Only pack input/output if packInOut is set (-disable-pack-in-out-cost-model)
+    bool     disableGsOnChip;       // Disable geometry shader on-chip mode (-disable-gs-onchip)
+    bool     nggSubgroupCostModel;  // Choose NGG sub-group size by estimated occupancy (-ngg-subgroup-cost-model)
+    int32_t  forceLoopUnrollCount;  // Force loop unroll count, 0 means disable (-force-loop-unroll-count)
+    bool     enableLoadScalarizer;  // Enable the load scalarizer (-enable-load-scalarizer)
+    uint32_t scalarThreshold;       // Vector size threshold of the load scalarizer (-scalar-threshold)
+    std::string tuningProfile;      // Feedback-directed tuning profile file, empty if none (-tuning-profile)
+    bool     tuningProfileExplore;  // Compile untried tuning configurations (-tuning-profile-explore)
+};
+
+// Parses per-compiler options out of compilation-option strings, the remaining strings are process-global options
+bool ParseCompilerOptions(uint32_t                  optionCount,
+                          const char*const*         pOptions,
+                          CompilerOptions*          pCompilerOptions,
+                          std::vector<const char*>* pGlobalOptions);
+
+} // Llpc
@@ -71,6 +71,9 @@ public:
     // Gets per pipeline options
     virtual const PipelineOptions* GetPipelineOptions() const { return &m_pPipelineInfo->options; }
 
+    // Gets the cancellation token and deadline of the pipeline build
+    virtual const PipelineBuildControl* GetBuildControl() const { return &m_pPipelineInfo->buildControl; }
+
 private:
     LLPC_DISALLOW_DEFAULT_CTOR(ComputeContext);
     LLPC_DISALLOW_COPY_AND_ASSIGN(ComputeContext);
@@ -65,7 +65,8 @@ Context::Context(
     :
     LLVMContext(),
     m_gfxIp(gfxIp),
-    m_glslEmuLib(this)
+    m_glslEmuLib(this),
+    m_buildCancelGate(*this)
 {
     m_pEmptyMetaNode = MDNode::get(*this, {});
 
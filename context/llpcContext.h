@@ -41,6 +41,7 @@
 
 #include "llpcBuilderContext.h"
 #include "llpcEmuLib.h"
+#include "llpcPassManager.h"
 #include "llpcPipelineContext.h"
 
 namespace Llpc
@@ -213,6 +214,9 @@ public:
     // Sets triple and data layout in specified module from the context's target machine.
     void SetModuleTargetMachine(llvm::Module* pModule);
 
+    // Gets the gate that abandons the current pipeline build on cancellation or deadline
+    BuildCancelGate& GetBuildCancelGate() { return m_buildCancelGate; }
+
 private:
     LLPC_DISALLOW_DEFAULT_CTOR(Context);
     LLPC_DISALLOW_COPY_AND_ASSIGN(Context);
@@ -225,6 +229,7 @@ private:
     volatile  bool                m_isInUse;           // Whether this context is in use
     Builder*                      m_pBuilder = nullptr; // LLPC builder object
     std::unique_ptr<BuilderContext> m_builderContext;  // Builder context
+    BuildCancelGate               m_buildCancelGate;   // Pass gate for build cancellation and deadline
 
     std::unique_ptr<llvm::TargetMachine> m_pTargetMachine; // Target machine
     bool                          m_scalarBlockLayout = false;  // scalarBlockLayout option from last pipeline compile
@@ -72,6 +72,9 @@ public:
     // Gets per pipeline options
     virtual const PipelineOptions* GetPipelineOptions() const { return &m_pPipelineInfo->options; }
 
+    // Gets the cancellation token and deadline of the pipeline build
+    virtual const PipelineBuildControl* GetBuildControl() const { return &m_pPipelineInfo->buildControl; }
+
     void InitShaderInfoForNullFs();
 
 private:
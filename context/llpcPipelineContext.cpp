@@ -70,19 +70,9 @@ static cl::opt<uint32_t> WavesPerEu("waves-per-eu",
                                     cl::desc("Maximum number of waves per EU for this shader"),
                                     cl::init(0));
 
-// -enable-load-scalarizer: Enable the optimization for load scalarizer.
-static cl::opt<bool> EnableScalarLoad("enable-load-scalarizer",
-                                      cl::desc("Enable the optimization for load scalarizer."),
-                                      cl::init(false));
-
 // The max threshold of load scalarizer.
 static const uint32_t MaxScalarThreshold = 0xFFFFFFFF;
 
-// -scalar-threshold: Set the vector size threshold for load scalarizer.
-static cl::opt<unsigned> ScalarThreshold("scalar-threshold",
-                                         cl::desc("The threshold for load scalarizer"),
-                                         cl::init(MaxScalarThreshold));
-
 // -enable-si-scheduler: enable target option si-scheduler
 static cl::opt<bool> EnableSiScheduler("enable-si-scheduler",
                                        cl::desc("Enable target option si-scheduler"),
@@ -294,14 +284,16 @@ ShaderHash PipelineContext::GetShaderHashCode(
 // =====================================================================================================================
 // Set pipeline state in Pipeline object for middle-end
 void PipelineContext::SetPipelineState(
-    Pipeline*    pPipeline) const   // [in/out] Middle-end pipeline object
+    Pipeline*              pPipeline,           // [in/out] Middle-end pipeline object
+    const CompilerOptions& compilerOptions      // [in] Options of the compiler building this pipeline
+    ) const
 {
     // Give the shader stage mask to the middle-end.
     uint32_t stageMask = GetShaderStageMask();
     pPipeline->SetShaderStageMask(stageMask);
 
     // Give the pipeline options to the middle-end.
-    SetOptionsInPipeline(pPipeline);
+    SetOptionsInPipeline(pPipeline, compilerOptions);
 
     // Give the user data nodes to the middle-end.
     SetUserDataInPipeline(pPipeline);
@@ -310,7 +302,9 @@ void PipelineContext::SetPipelineState(
 // =====================================================================================================================
 // Give the pipeline options to the middle-end.
 void PipelineContext::SetOptionsInPipeline(
-    Pipeline*    pPipeline) const   // [in/out] Middle-end pipeline object
+    Pipeline*              pPipeline,           // [in/out] Middle-end pipeline object
+    const CompilerOptions& compilerOptions      // [in] Options of the compiler building this pipeline
+    ) const
 {
     Options options = {};
     options.hash[0] = GetPiplineHashCode();
@@ -355,6 +349,11 @@ void PipelineContext::SetOptionsInPipeline(
     }
 #endif
 
+    options.nggSubgroupCostModel = compilerOptions.nggSubgroupCostModel;
+    options.packInOut = compilerOptions.packInOut;
+    options.disablePackInOutCostModel = compilerOptions.disablePackInOutCostModel;
+    options.disableGsOnChip = compilerOptions.disableGsOnChip;
+
     pPipeline->SetOptions(options);
 
     // Give the shader options (including the hash) to the middle-end.
@@ -420,9 +419,9 @@ void PipelineContext::SetOptionsInPipeline(
 #endif
 
             shaderOptions.loadScalarizerThreshold = 0;
-            if (EnableScalarLoad)
+            if (compilerOptions.enableLoadScalarizer)
             {
-                shaderOptions.loadScalarizerThreshold = ScalarThreshold;
+                shaderOptions.loadScalarizerThreshold = compilerOptions.scalarThreshold;
             }
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 33
             if (pShaderInfo->options.enableLoadScalarizer)
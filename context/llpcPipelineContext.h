@@ -449,8 +449,12 @@ struct ResourceUsage
                 uint32_t esGsLdsSize;               // ES -> GS ring LDS size (GS in)
                 uint32_t gsOnChipLdsSize;           // Total LDS size for GS on-chip mode.
                 uint32_t inputVertices;             // Number of GS input vertices
+                uint32_t gsWavesPerCu;              // Estimated on-chip GS waves per CU (0 if sub-group size is not
+                                                    // chosen by the cost model)
 #if LLPC_BUILD_GFX10
                 uint32_t primAmpFactor;             // GS primitive amplification factor
+                uint32_t nggWavesPerCu;             // Estimated NGG waves per CU (0 if sub-group size is not chosen
+                                                    // by the cost model)
 #endif
             } calcFactor;
 
@@ -729,8 +733,11 @@ public:
     // Gets per pipeline options
     virtual const PipelineOptions* GetPipelineOptions() const = 0;
 
+    // Gets the cancellation token and deadline of the pipeline build
+    virtual const PipelineBuildControl* GetBuildControl() const = 0;
+
     // Set pipeline state in Pipeline object for middle-end
-    void SetPipelineState(Pipeline* pPipeline) const;
+    void SetPipelineState(Pipeline* pPipeline, const CompilerOptions& compilerOptions) const;
 
     static void InitShaderResourceUsage(ShaderStage shaderStage, ResourceUsage* pResUsage);
 
@@ -760,7 +767,7 @@ private:
     LLPC_DISALLOW_COPY_AND_ASSIGN(PipelineContext);
 
     // Give the pipeline options to the middle-end.
-    void SetOptionsInPipeline(Pipeline* pPipeline) const;
+    void SetOptionsInPipeline(Pipeline* pPipeline, const CompilerOptions& compilerOptions) const;
 
     // Give the user data nodes and descriptor range values to the middle-end.
     void SetUserDataInPipeline(Pipeline* pPipeline) const;
@@ -31,6 +31,7 @@
 #define DEBUG_TYPE "llpc-shader-cache"
 
 #include <string.h>
+#include <vector>
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/FileSystem.h"
 #include "llpcShaderCache.h"
@@ -123,6 +124,8 @@ ShaderCache::ShaderCache()
     m_disableCache(true),
     m_shaderDataEnd(sizeof(ShaderCacheSerializedHeader)),
     m_totalShaders(0),
+    m_fileDataEnd(sizeof(ShaderCacheSerializedHeader)),
+    m_fileShaderCount(0),
     m_serializedSize(sizeof(ShaderCacheSerializedHeader)),
     m_pfnGetValueFunc(nullptr),
     m_pfnStoreValueFunc(nullptr)
@@ -336,9 +339,12 @@ Result ShaderCache::Init(
                     }
                 }
                 else
-                // Create the storage file if it does not exist
+                // Create the storage file if it does not exist. Not in append mode: entries are placed with
+                // positional writes, which append mode would redirect to the end of the file. And not in write mode
+                // either, which would truncate the file if another process has created it in the meantime.
                 {
-                    result = m_onDiskFile.Open(m_fileFullPath, (FileAccessRead | FileAccessAppend | FileAccessBinary));
+                    result = m_onDiskFile.Open(m_fileFullPath,
+                                               (FileAccessReadUpdate | FileAccessCreate | FileAccessBinary));
                 }
             }
 
@@ -357,7 +363,8 @@ Result ShaderCache::Init(
                 }
                 else
                 {
-                    ResetCacheFile();
+                    const ShaderCacheSerializedHeader noHeader = {};
+                    ResetCacheFile(&noHeader);
                 }
             }
 
@@ -420,21 +427,44 @@ Result ShaderCache::BuildFileName(
 }
 
 // =====================================================================================================================
-// Resets the contents of the cache file, assumes the shader cache has been locked for writes.
-void ShaderCache::ResetCacheFile()
+// Resets the contents of the cache file, assumes the shader cache has been locked for writes. The file is left alone
+// if, by the time it is locked, another process has already reset it or created it with a valid header; shaders in it
+// are then picked up by the next AddShaderToFile().
+//
+// NOTE: An existing file is not truncated, as another process may be reading it; rewriting the header under the file
+// lock is enough to discard its contents, since data past shaderDataEnd is unused.
+void ShaderCache::ResetCacheFile(
+    const ShaderCacheSerializedHeader* pSeenHeader) // [in] Header this cache found invalid, zero if the file was empty
 {
     m_onDiskFile.Close();
-    Result fileResult = m_onDiskFile.Open(m_fileFullPath, (FileAccessRead | FileAccessWrite | FileAccessBinary));
+    Result fileResult = m_onDiskFile.Open(m_fileFullPath, (FileAccessReadUpdate | FileAccessCreate | FileAccessBinary));
     LLPC_ASSERT(fileResult == Result::Success);
     LLPC_UNUSED(fileResult);
 
-    ShaderCacheSerializedHeader header = {};
-    header.headerSize    = sizeof(ShaderCacheSerializedHeader);
-    header.shaderCount   = 0;
-    header.shaderDataEnd = header.headerSize;
-    GetBuildTime(&header.buildId);
+    m_fileDataEnd     = sizeof(ShaderCacheSerializedHeader);
+    m_fileShaderCount = 0;
+
+    if (m_onDiskFile.Lock(true) == Result::Success)
+    {
+        ShaderCacheSerializedHeader header = {};
+        const bool changed =
+            (m_onDiskFile.ReadAt(&header, sizeof(ShaderCacheSerializedHeader), 0, nullptr) == Result::Success) &&
+            IsValidHeader(&header) &&
+            (header.shaderDataEnd <= File::GetFileSize(m_fileFullPath)) &&
+            (memcmp(&header, pSeenHeader, sizeof(ShaderCacheSerializedHeader)) != 0);
+
+        if (changed == false)
+        {
+            header = {};
+            header.headerSize    = sizeof(ShaderCacheSerializedHeader);
+            header.shaderCount   = 0;
+            header.shaderDataEnd = header.headerSize;
+            GetBuildTime(&header.buildId);
 
-    m_onDiskFile.Write(&header, header.headerSize);
+            m_onDiskFile.WriteAt(&header, header.headerSize, 0);
+        }
+        m_onDiskFile.Unlock();
+    }
 }
 
 // =====================================================================================================================
@@ -728,32 +758,108 @@ Result ShaderCache::RetrieveShader(
 }
 
 // =====================================================================================================================
-// Adds data for a new shader to the on-disk file
+// Adds data for a new shader to the on-disk file. Several processes may share the file, so the append is done under
+// an exclusive file lock: the end of the file is re-read from its header, shaders appended by other processes since we
+// last looked are merged into this cache, then the new shader is written after them and the header is updated last,
+// so readers never see a partial entry.
+//
+// NOTE: This function assumes that a write lock has already been taken by the calling function, and that the new
+// shader has already been counted in m_totalShaders.
 void ShaderCache::AddShaderToFile(
     const ShaderIndex* pIndex)    // [in] A new shader
 {
     LLPC_ASSERT(m_onDiskFile.IsOpen());
 
-    // We only need to update the parts of the file that changed, which is the number of shaders, the new data section,
-    // and the shaderDataEnd.
+    // The in-memory copy always holds the new shader, whether or not the file can be updated.
+    m_shaderDataEnd += pIndex->header.size;
 
-    // Calculate the header offsets, then write the relavent data to the file.
-    const uint32_t shaderCountOffset = offsetof(struct ShaderCacheSerializedHeader, shaderCount);
-    const uint32_t dataEndOffset     = offsetof(struct ShaderCacheSerializedHeader, shaderDataEnd);
+    if (m_onDiskFile.Lock(true) != Result::Success)
+    {
+        return;
+    }
 
-    m_onDiskFile.Seek(shaderCountOffset, true);
-    m_onDiskFile.Write(&m_totalShaders, sizeof(size_t));
+    ShaderCacheSerializedHeader header = {};
+    bool validFile =
+        (m_onDiskFile.ReadAt(&header, sizeof(ShaderCacheSerializedHeader), 0, nullptr) == Result::Success) &&
+        IsValidHeader(&header) &&
+        (header.shaderDataEnd <= File::GetFileSize(m_fileFullPath));
 
-    // Write the new shader data at the current end of the data section
-    m_onDiskFile.Seek(static_cast<uint32_t>(m_shaderDataEnd), true);
-    m_onDiskFile.Write(pIndex->pDataBlob, pIndex->header.size);
+    if (validFile && ((header.shaderDataEnd < m_fileDataEnd) || (header.shaderCount < m_fileShaderCount)))
+    {
+        // Another process has reset the file since we last looked, so all of the shaders in it are new to us.
+        m_fileDataEnd     = sizeof(ShaderCacheSerializedHeader);
+        m_fileShaderCount = 0;
+    }
 
-    // Then update the data end value and write it out to the file.
-    m_shaderDataEnd += pIndex->header.size;
-    m_onDiskFile.Seek(dataEndOffset, true);
-    m_onDiskFile.Write(&m_shaderDataEnd, sizeof(size_t));
+    // Pick up the shaders other processes have appended, so we neither overwrite them nor compile them again.
+    if (validFile && (header.shaderDataEnd > m_fileDataEnd))
+    {
+        validFile = (LoadAppendedShaders(m_fileDataEnd,
+                                         header.shaderDataEnd - m_fileDataEnd,
+                                         header.shaderCount - m_fileShaderCount) == Result::Success);
+    }
+
+    if (validFile == false)
+    {
+        // The file is empty or its contents are invalid, so start it over with the new shader.
+        header = {};
+        header.headerSize    = sizeof(ShaderCacheSerializedHeader);
+        header.shaderCount   = 0;
+        header.shaderDataEnd = header.headerSize;
+        GetBuildTime(&header.buildId);
+    }
+
+    // The file is in sync with the header now, even if the new shader fails to be written.
+    m_fileDataEnd     = header.shaderDataEnd;
+    m_fileShaderCount = header.shaderCount;
+
+    // Write the new shader data at the current end of the data section, then publish it through the header.
+    if (m_onDiskFile.WriteAt(pIndex->pDataBlob, pIndex->header.size, header.shaderDataEnd) == Result::Success)
+    {
+        header.shaderCount   += 1;
+        header.shaderDataEnd += pIndex->header.size;
+        if (m_onDiskFile.WriteAt(&header, sizeof(ShaderCacheSerializedHeader), 0) == Result::Success)
+        {
+            m_fileDataEnd     = header.shaderDataEnd;
+            m_fileShaderCount = header.shaderCount;
+        }
+    }
 
-    m_onDiskFile.Flush();
+    m_onDiskFile.Unlock();
+}
+
+// =====================================================================================================================
+// Loads the shaders appended to the on-disk file by other processes into the local cache copy. The file is left
+// untouched and nothing is loaded if the appended data is invalid.
+//
+// NOTE: This function assumes that a write lock has already been taken by the calling function, and that the file is
+// locked.
+Result ShaderCache::LoadAppendedShaders(
+    size_t dataOffset,      // Offset of the appended data in the file
+    size_t dataSize,        // Size of the appended data in bytes
+    size_t shaderCount)     // Number of shaders in the appended data
+{
+    std::vector<uint8_t> data(dataSize);
+    Result result = m_onDiskFile.ReadAt(data.data(), dataSize, dataOffset, nullptr);
+
+    if (result == Result::Success)
+    {
+        result = ValidateShaderData(data.data(), dataSize, shaderCount);
+    }
+
+    if (result == Result::Success)
+    {
+        void* pDataMem = GetCacheSpace(dataSize);
+        memcpy(pDataMem, data.data(), dataSize);
+
+        result = PopulateIndexMap(pDataMem, dataSize, shaderCount);
+        LLPC_ASSERT(result == Result::Success);
+
+        m_totalShaders  += shaderCount;
+        m_shaderDataEnd += dataSize;
+    }
+
+    return result;
 }
 
 // =====================================================================================================================
@@ -766,30 +872,35 @@ Result ShaderCache::LoadCacheFromFile()
 {
     LLPC_ASSERT(m_onDiskFile.IsOpen());
 
+    // Hold a shared lock while reading, so that another process appending to the file can't be seen half-way.
+    Result result = m_onDiskFile.Lock(false);
+
     // Read the header from the file and validate it
     ShaderCacheSerializedHeader header = {};
-    m_onDiskFile.Rewind();
-    m_onDiskFile.Read(&header, sizeof(ShaderCacheSerializedHeader), nullptr);
+    if (result == Result::Success)
+    {
+        result = m_onDiskFile.ReadAt(&header, sizeof(ShaderCacheSerializedHeader), 0, nullptr);
+    }
 
-    const size_t fileSize = File::GetFileSize(m_fileFullPath);
-    const size_t dataSize = fileSize - sizeof(ShaderCacheSerializedHeader);
-    Result result = ValidateAndLoadHeader(&header, fileSize);
+    if (result == Result::Success)
+    {
+        const size_t fileSize = File::GetFileSize(m_fileFullPath);
+        result = ValidateAndLoadHeader(&header, fileSize);
+    }
 
+    // Only the data section is loaded; anything past its end is space left over by a reset of the file.
+    const size_t dataSize = m_shaderDataEnd - sizeof(ShaderCacheSerializedHeader);
     void* pDataMem = nullptr;
-    if (result == Result::Success)
+    if ((result == Result::Success) && (dataSize > 0))
     {
         // The header is valid, so allocate space to fit all of the shader data.
         pDataMem = GetCacheSpace(dataSize);
-    }
 
-    if (result == Result::Success)
-    {
         if (pDataMem != nullptr)
         {
             // Read the shader data into the allocated memory.
-            m_onDiskFile.Seek(sizeof(ShaderCacheSerializedHeader), true);
             size_t bytesRead = 0;
-            result = m_onDiskFile.Read(pDataMem, dataSize, &bytesRead);
+            result = m_onDiskFile.ReadAt(pDataMem, dataSize, sizeof(ShaderCacheSerializedHeader), &bytesRead);
 
             // If we didn't read the correct number of bytes then something went wrong and we should return a failure
             if (bytesRead != dataSize)
@@ -803,16 +914,23 @@ Result ShaderCache::LoadCacheFromFile()
         }
     }
 
-    if (result == Result::Success)
+    m_onDiskFile.Unlock();
+
+    if ((result == Result::Success) && (dataSize > 0))
     {
         // Now setup the shader index hash map.
-        result = PopulateIndexMap(pDataMem, dataSize);
+        result = PopulateIndexMap(pDataMem, dataSize, m_totalShaders);
     }
 
-    if (result != Result::Success)
+    if (result == Result::Success)
+    {
+        m_fileDataEnd     = m_shaderDataEnd;
+        m_fileShaderCount = m_totalShaders;
+    }
+    else
     {
         // Something went wrong in loading the file, so reset it
-        ResetCacheFile();
+        ResetCacheFile(&header);
     }
 
     return result;
@@ -843,7 +961,7 @@ Result ShaderCache::LoadCacheFromBlob(
         {
             // Then copy the data and setup the shader index hash map.
             memcpy(pDataMem, VoidPtrInc(pInitialData, pHeader->headerSize), dataSize);
-            result = PopulateIndexMap(pDataMem, dataSize);
+            result = PopulateIndexMap(pDataMem, dataSize, m_totalShaders);
         }
         else
         {
@@ -854,12 +972,49 @@ Result ShaderCache::LoadCacheFromBlob(
     return result;
 }
 
+// =====================================================================================================================
+// Validates shader data without adding it to the index hash map: each entry must lie within the data and match its
+// CRC.
+Result ShaderCache::ValidateShaderData(
+    const void* pDataStart,     // [in] Start pointer of shader data
+    size_t      dataSize,       // Shader data size in bytes
+    size_t      shaderCount)    // Number of shaders in the data
+{
+    Result result = Result::Success;
+    size_t offset = 0;
+
+    for (size_t shader = 0; ((shader < shaderCount) && (result == Result::Success)); ++shader)
+    {
+        const auto* pHeader = static_cast<const ShaderHeader*>(VoidPtrInc(pDataStart, offset));
+
+        if ((offset + sizeof(ShaderHeader) > dataSize) ||
+            (pHeader->size < sizeof(ShaderHeader)) ||
+            (pHeader->size > dataSize - offset))
+        {
+            result = Result::ErrorUnknown;
+        }
+        else
+        {
+            const uint64_t crc = CalculateCrc(reinterpret_cast<const uint8_t*>(pHeader + 1),
+                                              (pHeader->size - sizeof(ShaderHeader)));
+            if (crc != pHeader->crc)
+            {
+                result = Result::ErrorUnknown;
+            }
+            offset += pHeader->size;
+        }
+    }
+
+    return result;
+}
+
 // =====================================================================================================================
 // Validates shader data (from a file or a blob) by checking the CRCs and adding index hash map entries if successful.
 // Will return a failure if any of the shader data is invalid.
 Result ShaderCache::PopulateIndexMap(
     void*  pDataStart,    // [in] Start pointer of cached shader data
-    size_t dataSize)      // Shader data size in bytes
+    size_t dataSize,      // Shader data size in bytes
+    size_t shaderCount)   // Number of shaders in the data
 {
     Result result = Result::Success;
 
@@ -868,7 +1023,7 @@ Result ShaderCache::PopulateIndexMap(
     // take the hit each time we add shader data to the file.
     auto* pHeader = static_cast<ShaderHeader*>(pDataStart);
 
-    for (uint32_t shader = 0; ((shader < m_totalShaders) && (result == Result::Success)); ++shader)
+    for (size_t shader = 0; ((shader < shaderCount) && (result == Result::Success)); ++shader)
     {
         // Guard against buffer overruns.
         LLPC_ASSERT(VoidPtrDiff(pHeader, pDataStart) <= dataSize);
@@ -914,7 +1069,7 @@ uint64_t ShaderCache::CalculateCrc(
     size_t         numBytes)      // Data size in bytes
 {
     uint64_t crc = CrcInitialValue;
-    for (uint32_t byte = 0; byte < numBytes; ++byte)
+    for (size_t byte = 0; byte < numBytes; ++byte)
     {
         uint8_t tableIndex = static_cast<uint8_t>(crc >> (CrcWidth - 8)) & 0xFF;
         crc = (crc << 8) ^ CrcLookup[tableIndex] ^ pData[byte];
@@ -923,6 +1078,22 @@ uint64_t ShaderCache::CalculateCrc(
     return crc;
 }
 
+// =====================================================================================================================
+// Checks whether the provided header was written by this build of LLPC with the same options.
+bool ShaderCache::IsValidHeader(
+    const ShaderCacheSerializedHeader* pHeader)     // [in] Cache file header
+{
+    BuildUniqueId buildId;
+    GetBuildTime(&buildId);
+
+    return (pHeader->headerSize == sizeof(ShaderCacheSerializedHeader)) &&
+           (pHeader->shaderDataEnd >= sizeof(ShaderCacheSerializedHeader)) &&
+           (memcmp(pHeader->buildId.buildDate, buildId.buildDate, sizeof(buildId.buildDate)) == 0) &&
+           (memcmp(pHeader->buildId.buildTime, buildId.buildTime, sizeof(buildId.buildTime)) == 0) &&
+           (memcmp(&pHeader->buildId.gfxIp, &buildId.gfxIp, sizeof(buildId.gfxIp)) == 0) &&
+           (memcmp(&pHeader->buildId.hash, &buildId.hash, sizeof(buildId.hash)) == 0);
+}
+
 // =====================================================================================================================
 // Validates the provided header and stores the data contained within it if valid.
 Result ShaderCache::ValidateAndLoadHeader(
@@ -931,16 +1102,9 @@ Result ShaderCache::ValidateAndLoadHeader(
 {
     LLPC_ASSERT(pHeader != nullptr);
 
-    BuildUniqueId buildId;
-    GetBuildTime(&buildId);
-
     Result result = Result::Success;
 
-    if (pHeader->headerSize == sizeof(ShaderCacheSerializedHeader) &&
-        (memcmp(pHeader->buildId.buildDate, buildId.buildDate, sizeof(buildId.buildDate)) == 0) &&
-        (memcmp(pHeader->buildId.buildTime, buildId.buildTime, sizeof(buildId.buildTime)) == 0) &&
-        (memcmp(&pHeader->buildId.gfxIp, &buildId.gfxIp, sizeof(buildId.gfxIp)) == 0) &&
-        (memcmp(&pHeader->buildId.hash, &buildId.hash, sizeof(buildId.hash)) == 0))
+    if (IsValidHeader(pHeader))
     {
         // The header appears valid so copy the header data to the runtime cache
         m_totalShaders  = pHeader->shaderCount;
@@ -165,14 +165,17 @@ private:
                          const char*  pCacheFilePath,
                          GfxIpVersion gfxIp,
                          bool*        pCacheFileExists);
+    bool IsValidHeader(const ShaderCacheSerializedHeader* pHeader);
     Result ValidateAndLoadHeader(const ShaderCacheSerializedHeader* pHeader, size_t dataSourceSize);
     Result LoadCacheFromBlob(const void* pInitialData, size_t initialDataSize);
-    Result PopulateIndexMap(void* pDataStart, size_t dataSize);
+    Result ValidateShaderData(const void* pDataStart, size_t dataSize, size_t shaderCount);
+    Result PopulateIndexMap(void* pDataStart, size_t dataSize, size_t shaderCount);
     uint64_t CalculateCrc(const uint8_t* pData, size_t numBytes);
 
     Result LoadCacheFromFile();
-    void ResetCacheFile();
+    void ResetCacheFile(const ShaderCacheSerializedHeader* pSeenHeader);
     void AddShaderToFile(const ShaderIndex* pIndex);
+    Result LoadAppendedShaders(size_t dataOffset, size_t dataSize, size_t shaderCount);
 
     void* GetCacheSpace(size_t numBytes);
 
@@ -203,10 +206,15 @@ private:
     size_t          m_shaderDataEnd;
     size_t          m_totalShaders;
 
+    // Data end and shader count of the on-disk file as of when this cache last loaded from or wrote to it. Other
+    // processes may append to the file, or reset it, in the meantime.
+    size_t          m_fileDataEnd;
+    size_t          m_fileShaderCount;
+
     char            m_fileFullPath[MaxFilePathLen]; // Full path/filename of the shader cache on-disk file
 
     std::list<std::pair<uint8_t*, size_t> > m_allocationList;  // Memory allcoated by GetCacheSpace
-    uint32_t                 m_serializedSize;      // Serialized byte size of whole shader cache
+    size_t                   m_serializedSize;      // Serialized byte size of whole shader cache
     std::mutex               m_conditionMutex;      // Mutex that will be used with the condition variable
     std::condition_variable  m_conditionVariable;   // Condition variable that will be used to wait compile finish
     const void*              m_pClientData;         // Client data that will be used by function GetValue and StoreValue
@@ -0,0 +1,390 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcTuningProfile.cpp
+ * @brief LLPC source file: contains implementation of class Llpc::TuningProfile.
+ ***********************************************************************************************************************
+ */
+#include <algorithm>
+#include <inttypes.h>
+#include <map>
+#include <memory>
+#include <stdio.h>
+
+#include "llpcFile.h"
+#include "llpcPipelineContext.h"
+#include "llpcTargetInfo.h"
+#include "llpcTuningProfile.h"
+
+#define DEBUG_TYPE "llpc-tuning-profile"
+
+namespace Llpc
+{
+
+// =====================================================================================================================
+// Gets the process-wide tuning profile for the specified file.
+TuningProfile* TuningProfile::Get(
+    const std::string& fileName)    // [in] Name of the profile file
+{
+    static std::mutex profilesLock;
+    static std::map<std::string, std::unique_ptr<TuningProfile>> profiles;
+
+    std::lock_guard<std::mutex> lock(profilesLock);
+    auto& pProfile = profiles[fileName];
+    if (pProfile == nullptr)
+    {
+        pProfile.reset(new TuningProfile(fileName));
+    }
+    return pProfile.get();
+}
+
+// =====================================================================================================================
+TuningProfile::TuningProfile(
+    const std::string& fileName)    // [in] Name of the profile file
+    :
+    m_fileName(fileName),
+    m_loadedSize(0)
+{
+}
+
+// =====================================================================================================================
+// Loads the records that have been appended to the profile file since it was last read, by this or another process.
+// The caller must hold the file lock. Each line records one compile:
+//
+//   <pipeline hash> <packInOut> <disableGsOnChip> <nggSubgroupCostModel> <forceLoopUnrollCount>
+//       <scratchMemorySize> <vgprCount> <sgprCount> <isaSize> <occupancy>
+//
+// Lines starting with '#' and lines that cannot be parsed (including lines too long for any record) are ignored. A line
+// that is not yet terminated is left to be read again by the next refresh.
+void TuningProfile::Refresh(
+    File* pProfileFile)             // [in] Opened profile file
+{
+    pProfileFile->Seek(static_cast<int64_t>(m_loadedSize), true);
+
+    char line[256] = {};
+    size_t lineLength = 0;
+    Result result = Result::Success;
+    while (result == Result::Success)
+    {
+        result = pProfileFile->ReadLine(line, sizeof(line) - 1, &lineLength);
+        if (result == Result::ErrorInvalidValue)
+        {
+            // The line does not fit in the buffer, so it is not a valid record. Skip the rest of it, so that the records
+            // after it are still read.
+            size_t skippedLength = lineLength;
+            while (result == Result::ErrorInvalidValue)
+            {
+                result = pProfileFile->ReadLine(line, sizeof(line) - 1, &lineLength);
+                skippedLength += lineLength;
+            }
+
+            if (result == Result::Success)
+            {
+                m_loadedSize += skippedLength + 1;
+            }
+            continue;
+        }
+        else if (result != Result::Success)
+        {
+            break;
+        }
+
+        m_loadedSize += lineLength + 1;
+
+        line[lineLength] = '\0';
+        if (line[0] == '#')
+        {
+            continue;
+        }
+
+        uint64_t pipelineHash = 0;
+        uint32_t packInOut = 0;
+        uint32_t disableGsOnChip = 0;
+        uint32_t nggSubgroupCostModel = 0;
+        TuningRecord record = {};
+        if (sscanf(line,
+                   "%" SCNx64 " %u %u %u %d %u %u %u %" SCNu64 " %u",
+                   &pipelineHash,
+                   &packInOut,
+                   &disableGsOnChip,
+                   &nggSubgroupCostModel,
+                   &record.config.forceLoopUnrollCount,
+                   &record.scratchMemorySize,
+                   &record.vgprCount,
+                   &record.sgprCount,
+                   &record.isaSize,
+                   &record.occupancy) == 10)
+        {
+            record.config.packInOut = (packInOut != 0);
+            record.config.disableGsOnChip = (disableGsOnChip != 0);
+            record.config.nggSubgroupCostModel = (nggSubgroupCostModel != 0);
+
+            // Each configuration is only recorded once per pipeline, the first record stands.
+            if (FindRecord(pipelineHash, record.config) == nullptr)
+            {
+                m_records[pipelineHash].push_back(record);
+            }
+        }
+    }
+}
+
+// =====================================================================================================================
+// Finds the record of a pipeline compiled with the specified tuning configuration, nullptr if it has not been tried.
+const TuningRecord* TuningProfile::FindRecord(
+    uint64_t            pipelineHash,   // Pipeline hash code
+    const TuningConfig& config)         // [in] Tuning configuration
+{
+    auto recordsIt = m_records.find(pipelineHash);
+    if (recordsIt == m_records.end())
+    {
+        return nullptr;
+    }
+
+    const auto& records = recordsIt->second;
+    auto it = std::find_if(records.begin(),
+                           records.end(),
+                           [&](const TuningRecord& record) { return IsSameConfig(record.config, config); });
+    return (it != records.end()) ? &*it : nullptr;
+}
+
+// =====================================================================================================================
+// Gets the tuning configurations to try for a pipeline: the configuration from the compiler options first, then that
+// configuration with one choice changed at a time.
+void TuningProfile::GetCandidates(
+    const TuningConfig&        baseConfig,  // [in] Tuning configuration from the compiler options
+    bool                       isGraphics,  // Whether the pipeline is a graphics pipeline
+    std::vector<TuningConfig>* pCandidates) // [out] Tuning configurations to try
+{
+    pCandidates->clear();
+    pCandidates->push_back(baseConfig);
+
+    // Loop unrolling trades code size and registers against loop overhead: try the opposite of the default.
+    TuningConfig config = baseConfig;
+    config.forceLoopUnrollCount = (baseConfig.forceLoopUnrollCount == 1) ? 0 : 1;
+    pCandidates->push_back(config);
+
+    if (isGraphics)
+    {
+        config = baseConfig;
+        config.packInOut = (baseConfig.packInOut == false);
+        pCandidates->push_back(config);
+
+#if LLPC_BUILD_GFX10
+        config = baseConfig;
+        config.nggSubgroupCostModel = (baseConfig.nggSubgroupCostModel == false);
+        pCandidates->push_back(config);
+#endif
+    }
+}
+
+// =====================================================================================================================
+// Estimates the number of waves per SIMD that the VGPR usage of a pipeline allows, on the target of the specified
+// graphics IP. This is the minimum over the hardware stages, each at its own wavefront size.
+uint32_t TuningProfile::EstimateOccupancy(
+    GfxIpVersion              gfxIp,    // Graphics IP version info
+    const PipelineStatistics& stats)    // [in] Statistics of the pipeline
+{
+    std::string gpuName;
+    PipelineContext::GetGpuNameString(gfxIp, gpuName);
+
+    TargetInfo targetInfo;
+    if (targetInfo.SetTargetInfo(gpuName) == false)
+    {
+        return 0;
+    }
+
+    const GpuProperty& gpuProperty = targetInfo.GetGpuProperty();
+    uint32_t occupancy = gpuProperty.maxWavesPerSimd;
+    for (const HwShaderStatistics& stageStats : stats.hwStages)
+    {
+        if (stageStats.valid && (stageStats.wavefrontSize != 0))
+        {
+            // The VGPR file and its allocation granularity are in DWORDs, shared by the lanes of a wave.
+            const uint32_t vgprGranularity = gpuProperty.vgprAllocGranularity / stageStats.wavefrontSize;
+            const uint32_t vgprsPerSimd = gpuProperty.vgprFileSizePerSimd / stageStats.wavefrontSize;
+            const uint32_t vgprCount = std::max(stageStats.vgprCount, 1u);
+            const uint32_t allocatedVgprs = (vgprCount + vgprGranularity - 1) / vgprGranularity * vgprGranularity;
+            occupancy = std::min(occupancy, vgprsPerSimd / allocatedVgprs);
+        }
+    }
+    return occupancy;
+}
+
+// =====================================================================================================================
+// Checks whether a compile scored better than the best compile so far. Spilling to scratch memory is worst, then low
+// occupancy; otherwise the earlier (default) configuration is kept, so tuning only deviates from the compiler options
+// where it pays off.
+bool TuningProfile::IsBetter(
+    const TuningRecord& record,     // [in] Record of a compile
+    const TuningRecord& bestRecord) // [in] Record of the best compile so far
+{
+    if (record.scratchMemorySize != bestRecord.scratchMemorySize)
+    {
+        return record.scratchMemorySize < bestRecord.scratchMemorySize;
+    }
+    return record.occupancy > bestRecord.occupancy;
+}
+
+// =====================================================================================================================
+// Selects the tuning configuration to compile a pipeline with, and applies it to the compiler options. With
+// exploration (-tuning-profile-explore), that is the first candidate that has not been tried yet, or the best-scoring
+// one when all have been tried. Otherwise untried candidates are never compiled: it is the best-scoring one of those
+// that have been recorded, which leaves the compiler options unchanged until an exploring run has found a better one.
+void TuningProfile::SelectOptions(
+    uint64_t         pipelineHash,  // Pipeline hash code
+    bool             isGraphics,    // Whether the pipeline is a graphics pipeline
+    CompilerOptions* pOptions)      // [in,out] Compiler options
+{
+    TuningConfig baseConfig = {};
+    baseConfig.packInOut = pOptions->packInOut;
+    baseConfig.disableGsOnChip = pOptions->disableGsOnChip;
+    baseConfig.nggSubgroupCostModel = pOptions->nggSubgroupCostModel;
+    baseConfig.forceLoopUnrollCount = pOptions->forceLoopUnrollCount;
+
+    std::vector<TuningConfig> candidates;
+    GetCandidates(baseConfig, isGraphics, &candidates);
+
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    // Pick up the records that other processes have added since the last compile.
+    File profileFile;
+    if (profileFile.Open(m_fileName.c_str(), FileAccessRead | FileAccessBinary) == Result::Success)
+    {
+        profileFile.Lock(false);
+        Refresh(&profileFile);
+        profileFile.Unlock();
+    }
+
+    const TuningConfig* pSelected = nullptr;
+    const TuningRecord* pBest = nullptr;
+    for (const TuningConfig& candidate : candidates)
+    {
+        const TuningRecord* pRecord = FindRecord(pipelineHash, candidate);
+        if (pRecord == nullptr)
+        {
+            if (pOptions->tuningProfileExplore)
+            {
+                // Not tried yet.
+                pSelected = &candidate;
+                break;
+            }
+        }
+        else if ((pBest == nullptr) || IsBetter(*pRecord, *pBest))
+        {
+            pBest = pRecord;
+        }
+    }
+
+    if ((pSelected == nullptr) && (pBest != nullptr))
+    {
+        pSelected = &pBest->config;
+    }
+
+    if (pSelected != nullptr)
+    {
+        pOptions->packInOut = pSelected->packInOut;
+        pOptions->disableGsOnChip = pSelected->disableGsOnChip;
+        pOptions->nggSubgroupCostModel = pSelected->nggSubgroupCostModel;
+        pOptions->forceLoopUnrollCount = pSelected->forceLoopUnrollCount;
+    }
+}
+
+// =====================================================================================================================
+// Records the resource usage of a pipeline compiled with the specified compiler options, in memory and in the profile
+// file. Nothing is recorded if the profile already has a record of the configuration, so the profile grows by at most
+// one line per candidate configuration of each pipeline.
+void TuningProfile::Record(
+    uint64_t                pipelineHash,   // Pipeline hash code
+    const CompilerOptions&  options,        // [in] Compiler options the pipeline was compiled with
+    GfxIpVersion            gfxIp,          // Graphics IP version info
+    const BinaryData&       pipelineBin)    // [in] Pipeline ELF binary
+{
+    TuningRecord record = {};
+    record.config.packInOut = options.packInOut;
+    record.config.disableGsOnChip = options.disableGsOnChip;
+    record.config.nggSubgroupCostModel = options.nggSubgroupCostModel;
+    record.config.forceLoopUnrollCount = options.forceLoopUnrollCount;
+
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    if (FindRecord(pipelineHash, record.config) != nullptr)
+    {
+        return;
+    }
+
+    PipelineStatistics stats = {};
+    if (ICompiler::GetPipelineStatistics(gfxIp, pipelineBin, &stats) != Result::Success)
+    {
+        // Not an ELF (e.g. ISA text or LLVM IR output), nothing to learn from.
+        return;
+    }
+
+    record.isaSize = stats.isaSize;
+    record.occupancy = EstimateOccupancy(gfxIp, stats);
+    for (const HwShaderStatistics& stageStats : stats.hwStages)
+    {
+        if (stageStats.valid)
+        {
+            record.scratchMemorySize += stageStats.scratchMemorySize;
+            record.vgprCount = std::max(record.vgprCount, stageStats.vgprCount);
+            record.sgprCount = std::max(record.sgprCount, stageStats.sgprCount);
+        }
+    }
+
+    // Check again and append the record under the file lock, so that processes sharing the profile neither record the
+    // same configuration twice nor interleave their lines.
+    File profileFile;
+    if (profileFile.Open(m_fileName.c_str(), FileAccessRead | FileAccessAppend | FileAccessBinary) == Result::Success)
+    {
+        profileFile.Lock(true);
+        Refresh(&profileFile);
+        if (FindRecord(pipelineHash, record.config) == nullptr)
+        {
+            profileFile.Printf("%016" PRIx64 " %u %u %u %d %u %u %u %" PRIu64 " %u\n",
+                               pipelineHash,
+                               record.config.packInOut,
+                               record.config.disableGsOnChip,
+                               record.config.nggSubgroupCostModel,
+                               record.config.forceLoopUnrollCount,
+                               record.scratchMemorySize,
+                               record.vgprCount,
+                               record.sgprCount,
+                               record.isaSize,
+                               record.occupancy);
+            profileFile.Flush();
+
+            // Read back the line just appended, so that it isn't loaded again.
+            Refresh(&profileFile);
+        }
+        profileFile.Unlock();
+    }
+    else
+    {
+        m_records[pipelineHash].push_back(record);
+    }
+}
+
+} // Llpc
@@ -0,0 +1,113 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcTuningProfile.h
+ * @brief LLPC header file: contains declaration of class Llpc::TuningProfile.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "llpc.h"
+#include "llpcCompilerOptions.h"
+#include "llpcDebug.h"
+
+namespace Llpc
+{
+
+class File;
+
+// Represents the tuning choices that the tuning profile may vary per pipeline.
+struct TuningConfig
+{
+    bool     packInOut;             // Pack input/output
+    bool     disableGsOnChip;       // Disable geometry shader on-chip mode
+    bool     nggSubgroupCostModel;  // Choose NGG sub-group size by estimated occupancy
+    int32_t  forceLoopUnrollCount;  // Force loop unroll count, 0 means disable
+};
+
+// Represents the result of compiling a pipeline with one tuning configuration.
+struct TuningRecord
+{
+    TuningConfig config;            // Tuning configuration the pipeline was compiled with
+    uint32_t     scratchMemorySize; // Total scratch memory size of all hardware stages, mostly from spilling
+    uint32_t     vgprCount;         // Maximum VGPR count of all hardware stages
+    uint32_t     sgprCount;         // Maximum SGPR count of all hardware stages
+    uint64_t     isaSize;           // Size in bytes of the pipeline code
+    uint32_t     occupancy;         // Estimated waves per SIMD that the VGPR usage of the pipeline allows
+};
+
+// =====================================================================================================================
+// Represents a profile of past compiles, keyed by pipeline hash, that records the tuning configurations tried for each
+// pipeline and the resource usage they produced. Each configuration is recorded once. With exploration enabled, each
+// compile of a pipeline tries the next untried configuration until all have been tried; the best recorded one is used
+// otherwise. The profile is a text file that is appended to, and may be shared by several processes.
+class TuningProfile
+{
+public:
+    static TuningProfile* Get(const std::string& fileName);
+
+    void SelectOptions(uint64_t pipelineHash, bool isGraphics, CompilerOptions* pOptions);
+    void Record(uint64_t                pipelineHash,
+                const CompilerOptions&  options,
+                GfxIpVersion            gfxIp,
+                const BinaryData&       pipelineBin);
+
+private:
+    LLPC_DISALLOW_DEFAULT_CTOR(TuningProfile);
+    LLPC_DISALLOW_COPY_AND_ASSIGN(TuningProfile);
+
+    explicit TuningProfile(const std::string& fileName);
+
+    void Refresh(File* pProfileFile);
+    const TuningRecord* FindRecord(uint64_t pipelineHash, const TuningConfig& config);
+
+    static void GetCandidates(const TuningConfig& baseConfig, bool isGraphics, std::vector<TuningConfig>* pCandidates);
+    static uint32_t EstimateOccupancy(GfxIpVersion gfxIp, const PipelineStatistics& stats);
+    static bool IsBetter(const TuningRecord& record, const TuningRecord& bestRecord);
+
+    // Checks whether two tuning configurations are the same
+    static bool IsSameConfig(const TuningConfig& lhs, const TuningConfig& rhs)
+    {
+        return (lhs.packInOut == rhs.packInOut) &&
+               (lhs.disableGsOnChip == rhs.disableGsOnChip) &&
+               (lhs.nggSubgroupCostModel == rhs.nggSubgroupCostModel) &&
+               (lhs.forceLoopUnrollCount == rhs.forceLoopUnrollCount);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    std::string                                             m_fileName;   // Name of the profile file
+    std::mutex                                              m_lock;       // Lock of the records
+    std::unordered_map<uint64_t, std::vector<TuningRecord>> m_records;    // Records of each pipeline, by pipeline hash
+    uint64_t                                                m_loadedSize; // Size in bytes of the file loaded so far
+};
+
+} // Llpc
@@ -43,7 +43,7 @@
 #define LLPC_INTERFACE_MAJOR_VERSION 38
 
 /// LLPC minor interface version.
-#define LLPC_INTERFACE_MINOR_VERSION 1
+#define LLPC_INTERFACE_MINOR_VERSION 5
 
 //**
 //**********************************************************************************************************************
@@ -51,6 +51,9 @@
 //* %Version History
 //* | %Version | Change Description                                                                                    |
 //* | -------- | ----------------------------------------------------------------------------------------------------- |
+//* |     38.5 | Added priority to PipelineBuildControl and code size counters to ShaderModuleUsage                    |
+//* |     38.4 | Added buildControl to pipeline build info and Result::ErrorCanceled                                   |
+//* |     38.3 | Added ICompiler::GetPipelineStatistics                                                                |
 //* |     38.2 | Added scalarThreshold to PipelineShaderOptions                                                        |
 //* |     38.1 | Added unrollThreshold to PipelineShaderOptions                                                        |
 //* |     38.0 | Removed CreateShaderCache in ICompiler and pShaderCache in pipeline build info                        |
@@ -114,6 +117,8 @@ enum class Result : int32_t
     ErrorInvalidPointer             = -(0x00000005),
     /// The operaton encountered an unknown error
     ErrorUnknown                    = -(0x00000006),
+    /// The operation was canceled by the client or did not complete before its deadline
+    ErrorCanceled                   = -(0x00000007),
 };
 
 /// Enumerates LLPC shader stages.
@@ -309,6 +314,9 @@ struct ShaderModuleUsage
     bool                  useHelpInvocation;       ///< Whether fragment shader has helper-invocation for subgroup
     bool                  useSpecConstant;         ///< Whether specializaton constant is used
     bool                  keepUnusedFunctions;     ///< Whether to keep unused function
+    uint32_t              instructionCount;        ///< Count of instructions in function bodies, excluding debug ones
+    uint32_t              loopCount;               ///< Count of structured loops
+    uint32_t              functionCount;           ///< Count of functions
 };
 
 /// Represents common part of shader module data
@@ -634,6 +642,19 @@ struct ColorTarget
     VkFormat        format;               ///< Color attachment format
 };
 
+/// Represents controls to abandon a pipeline build that is in flight, e.g. a speculative compile that is no longer
+/// wanted. An abandoned build returns Result::ErrorCanceled and leaves no shader cache entry behind.
+struct PipelineBuildControl
+{
+    const volatile uint32_t* pCancelFlag;   ///< If non-null, the build is abandoned once the client sets the value
+                                            ///  it points to to non-zero (from any thread)
+    uint32_t                 timeoutMs;     ///< If non-zero, the build is abandoned once it has run for longer than
+                                            ///  this many milliseconds
+    uint32_t                 priority;      ///< Scheduling priority of the build. When more builds are pending than
+                                            ///  may run at once, higher priority ones start first, then those with
+                                            ///  lower predicted compile cost
+};
+
 /// Represents info to build a graphics pipeline.
 struct GraphicsPipelineBuildInfo
 {
@@ -699,6 +720,7 @@ struct GraphicsPipelineBuildInfo
 #endif
 
     PipelineOptions     options;            ///< Per pipeline tuning/debugging options
+    PipelineBuildControl buildControl;      ///< Cancellation token and deadline of this build
 };
 
 /// Represents info to build a compute pipeline.
@@ -713,6 +735,7 @@ struct ComputePipelineBuildInfo
     uint32_t            deviceIndex;        ///< Device index for device group
     PipelineShaderInfo  cs;                 ///< Compute shader
     PipelineOptions     options;            ///< Per pipeline tuning options
+    PipelineBuildControl buildControl;      ///< Cancellation token and deadline of this build
 };
 
 /// Represents output of building a compute pipeline.
@@ -721,6 +744,40 @@ struct ComputePipelineBuildOut
     BinaryData          pipelineBin;        ///< Output pipeline binary data
 };
 
+/// Enumerates hardware shader stages of a compiled pipeline (in the order of the PAL pipeline ABI).
+enum HwShaderStage : uint32_t
+{
+    HwShaderStageLs = 0,                    ///< Hardware local shader
+    HwShaderStageHs,                        ///< Hardware hull shader
+    HwShaderStageEs,                        ///< Hardware export shader
+    HwShaderStageGs,                        ///< Hardware geometry shader
+    HwShaderStageVs,                        ///< Hardware vertex shader
+    HwShaderStagePs,                        ///< Hardware pixel shader
+    HwShaderStageCs,                        ///< Hardware compute shader
+    HwShaderStageCount,                     ///< Count of hardware shader stages
+};
+
+/// Represents resource usage statistics of one hardware shader stage of a compiled pipeline.
+struct HwShaderStatistics
+{
+    bool                valid;              ///< Whether this hardware stage is present in the pipeline
+    uint32_t            vgprCount;          ///< Number of VGPRs used
+    uint32_t            sgprCount;          ///< Number of SGPRs used
+    uint32_t            vgprLimit;          ///< Number of VGPRs available to the stage
+    uint32_t            sgprLimit;          ///< Number of SGPRs available to the stage
+    uint32_t            ldsSize;            ///< LDS size in bytes
+    uint32_t            scratchMemorySize;  ///< Scratch memory size in bytes per thread
+    uint32_t            wavefrontSize;      ///< Wavefront size
+    uint64_t            isaSize;            ///< Size in bytes of the stage's entry-point code
+};
+
+/// Represents statistics of a compiled pipeline, as extracted from its ELF binary.
+struct PipelineStatistics
+{
+    HwShaderStatistics  hwStages[HwShaderStageCount];   ///< Statistics of each hardware shader stage
+    uint64_t            isaSize;                        ///< Size in bytes of all code in the pipeline
+};
+
 // =====================================================================================================================
 /// Represents the unified of a pipeline create info.
 struct PipelineBuildInfo
@@ -914,6 +971,18 @@ public:
     /// @return TRUE if the specified format is supported by fetch shader. Otherwise, FALSE is returned.
     static bool VKAPI_CALL IsVertexFormatSupported(VkFormat format);
 
+    /// Extracts resource usage statistics from a compiled pipeline ELF binary, using its PAL metadata and symbols.
+    ///
+    /// @param [in]  gfxIp        Graphics IP version info
+    /// @param [in]  pipelineBin  Pipeline ELF binary, as returned in the pipeline build output
+    /// @param [out] pStats       Statistics of the pipeline
+    ///
+    /// @returns Result::Success if successful. Other return codes indicate failure, e.g. if the binary is not an ELF, or
+    ///          Result::ErrorInvalidValue if its PAL metadata has no amdpal.pipelines[0].hardware_stages map.
+    static Result VKAPI_CALL GetPipelineStatistics(GfxIpVersion        gfxIp,
+                                                   const BinaryData&   pipelineBin,
+                                                   PipelineStatistics* pStats);
+
     /// Destroys the pipeline compiler.
     virtual void VKAPI_CALL Destroy() = 0;
 
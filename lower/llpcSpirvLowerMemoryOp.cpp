@@ -28,9 +28,14 @@
  * @brief LLPC source file: contains implementation of class Llpc::SpirvLowerMemoryOp.
  ***********************************************************************************************************************
  */
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/KnownBits.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include "SPIRVInternal.h"
@@ -43,6 +48,12 @@ using namespace llvm;
 using namespace SPIRV;
 using namespace Llpc;
 
+// -dyn-index-cost-model: choose between dynamic index expansion and keeping the dynamic index by estimated cost
+static cl::opt<bool> DynIndexCostModel("dyn-index-cost-model",
+                                       cl::desc("Choose between dynamic index expansion and keeping the dynamic index "
+                                                "of local arrays by estimated cost"),
+                                       cl::init(true));
+
 namespace Llpc
 {
 
@@ -60,7 +71,8 @@ ModulePass* CreateSpirvLowerMemoryOp()
 // =====================================================================================================================
 SpirvLowerMemoryOp::SpirvLowerMemoryOp()
     :
-    SpirvLower(ID)
+    SpirvLower(ID),
+    m_pLoopInfo(nullptr)
 {
     initializeSpirvLowerMemoryOpPass(*PassRegistry::getPassRegistry());
 }
@@ -74,7 +86,24 @@ bool SpirvLowerMemoryOp::runOnModule(
 
     SpirvLower::Init(&module);
 
-    visit(m_pModule);
+    // Visit function by function, so that the loop info of the current function is available to the cost model of
+    // dynamic index expansion.
+    for (auto& func : module)
+    {
+        if (func.empty())
+        {
+            continue;
+        }
+
+        DominatorTree domTree(func);
+        LoopInfo loopInfo(domTree);
+        m_pLoopInfo = &loopInfo;
+        visit(func);
+        m_pLoopInfo = nullptr;
+    }
+
+    OutputDynIndexStrategies();
+    m_dynIndexAccesses.clear();
 
     // Remove those instructions that are replaced by this lower pass
     for (auto pInst : m_preRemoveInsts)
@@ -211,8 +240,7 @@ void SpirvLowerMemoryOp::visitGetElementPtrInst(
 bool SpirvLowerMemoryOp::NeedExpandDynamicIndex(
     GetElementPtrInst* pGetElemPtr,       // [in] "GetElementPtr" instruction
     uint32_t*          pOperandIndex,     // [out] Index of the operand that represents a dynamic index
-    uint32_t*          pDynIndexBound     // [out] Upper bound of dynamic index
-    ) const
+    uint32_t*          pDynIndexBound)    // [out] Upper bound of dynamic index
 {
     static const uint32_t MaxDynIndexBound = 8;
 
@@ -221,6 +249,7 @@ bool SpirvLowerMemoryOp::NeedExpandDynamicIndex(
     bool     needExpand   = false;
     bool     allowExpand  = true;
     auto     pPtrVal      = pGetElemPtr->getPointerOperand();
+    Type*    pArrayTy     = nullptr; // Indexed array type whose expansion is left to the cost model
 
     // NOTE: We only handle local variables.
     if (pPtrVal->getType()->getPointerAddressSpace() != SPIRAS_Private)
@@ -246,15 +275,20 @@ bool SpirvLowerMemoryOp::NeedExpandDynamicIndex(
                     // Check the upper bound of dynamic index
                     if (isa<ArrayType>(pIndexedTy))
                     {
-                        auto pArrayTy = dyn_cast<ArrayType>(pIndexedTy);
-                        if (pArrayTy->getArrayNumElements() > MaxDynIndexBound)
+                        if (DynIndexCostModel)
+                        {
+                            // Decide after all users are known to be "load" or "store"
+                            pArrayTy = pIndexedTy;
+                            *pDynIndexBound = pIndexedTy->getArrayNumElements();
+                        }
+                        else if (pIndexedTy->getArrayNumElements() > MaxDynIndexBound)
                         {
                             // Skip expand if array size greater than threshold
                             allowExpand = false;
                         }
                         else
                         {
-                            *pDynIndexBound = pArrayTy->getArrayNumElements();
+                            *pDynIndexBound = pIndexedTy->getArrayNumElements();
                         }
                     }
                     else if (isa<VectorType>(pIndexedTy))
@@ -300,10 +334,143 @@ bool SpirvLowerMemoryOp::NeedExpandDynamicIndex(
         }
     }
 
+    if (needExpand && allowExpand && (pArrayTy != nullptr))
+    {
+        allowExpand = (SelectDynIndexStrategy(pGetElemPtr, pArrayTy, *pDynIndexBound) == DynIndexStrategy::Expand);
+    }
+
     *pOperandIndex = operandIndex;
     return needExpand && allowExpand;
 }
 
+// =====================================================================================================================
+// Estimates the cost of the possible strategies to access a local array through a dynamic index, and returns the
+// cheapest one. The decision is recorded for dumping.
+//
+// NOTE: Only expansion is done by this pass. Otherwise the dynamic index is kept, and whether the array ends up in
+// indexed VGPRs or in scratch memory is decided by the backend (alloca promotion). The cost of keeping the index is
+// estimated as indexed VGPR access if the array fits in the VGPR budget, and as scratch access if it does not.
+DynIndexStrategy SpirvLowerMemoryOp::SelectDynIndexStrategy(
+    GetElementPtrInst* pGetElemPtr,       // [in] "GetElementPtr" instruction with a dynamic index
+    Type*              pIndexedTy,        // [in] Array type indexed by the dynamic index
+    uint32_t           dynIndexBound)     // Upper bound of dynamic index
+{
+    // All costs are in units of roughly one ALU instruction.
+    static const uint32_t IndexedAccessCodeSize = 10;  // Code to set the GPR index, in a waterfall loop
+    static const uint32_t IndexedAccessOverhead = 16;  // Setting the GPR index, with a waterfall loop when divergent
+    static const uint32_t IndexedDwordCost      = 2;   // Per-dword cost of a VGPR-indexed move
+    static const uint32_t ScratchAccessOverhead = 4;   // Address calculation of a scratch access
+    static const uint32_t ScratchDwordCost      = 32;  // Per-dword cost of a scratch access, weighted by latency
+    static const uint32_t MaxRegisterDwords     = 64;  // Beyond this, keeping the array in VGPRs is assumed to spill
+    static const uint32_t MaxExpandCodeSize     = 256; // Beyond this, expansion bloats code and compile time too much
+    static const uint32_t LoopWeight            = 8;   // Assumed iteration count of each level of loop
+    static const uint32_t MaxWeightedLoopDepth  = 2;
+
+    const DataLayout& dataLayout = m_pModule->getDataLayout();
+    const uint32_t elemSize = dataLayout.getTypeStoreSize(pIndexedTy->getArrayElementType());
+    const uint32_t elemDwords = std::max((elemSize + 3) / 4, 1u);
+    const uint32_t arrayDwords = elemDwords * dynIndexBound;
+
+    DynIndexAccessInfo accessInfo = {};
+    accessInfo.pIndexedTy = pIndexedTy;
+    accessInfo.accessCount = pGetElemPtr->getNumUses();
+    accessInfo.loopDepth = (m_pLoopInfo != nullptr) ? m_pLoopInfo->getLoopDepth(pGetElemPtr->getParent()) : 0;
+
+    uint32_t weight = 1;
+    for (uint32_t i = 0; i < std::min(accessInfo.loopDepth, MaxWeightedLoopDepth); ++i)
+    {
+        weight *= LoopWeight;
+    }
+
+    // Each strategy is charged its code size once plus its dynamic instruction count weighted by loop depth, so the
+    // deeper the access is nested, the more the choice depends on the dynamic instruction count alone.
+    //
+    // Expansion: one compare and one select per element dword for each possible index value other than the first.
+    const uint32_t expandCodeSizePerAccess = (dynIndexBound - 1) * (1 + elemDwords);
+    const uint32_t expandCostPerAccess = expandCodeSizePerAccess;
+
+    uint32_t indexedCodeSizePerAccess = 0;
+    uint32_t indexedCostPerAccess = 0;
+    if (arrayDwords <= MaxRegisterDwords)
+    {
+        // Indexed VGPRs: set the GPR index (in a waterfall loop if the index is divergent) and move element dwords.
+        indexedCodeSizePerAccess = IndexedAccessCodeSize + elemDwords;
+        indexedCostPerAccess = IndexedAccessOverhead + IndexedDwordCost * elemDwords;
+    }
+    else
+    {
+        // Scratch: address calculation and a memory access per element dword, whose latency is rarely hidden.
+        indexedCodeSizePerAccess = ScratchAccessOverhead + elemDwords;
+        indexedCostPerAccess = ScratchAccessOverhead + ScratchDwordCost * elemDwords;
+    }
+
+    uint32_t* pCost = accessInfo.cost;
+    pCost[static_cast<uint32_t>(DynIndexStrategy::Expand)] =
+        accessInfo.accessCount * (expandCodeSizePerAccess + expandCostPerAccess * weight);
+    pCost[static_cast<uint32_t>(DynIndexStrategy::Indexed)] =
+        accessInfo.accessCount * (indexedCodeSizePerAccess + indexedCostPerAccess * weight);
+
+    if ((accessInfo.accessCount * expandCodeSizePerAccess > MaxExpandCodeSize) || (arrayDwords > MaxRegisterDwords))
+    {
+        // Expansion keeps the whole array in VGPRs
+        pCost[static_cast<uint32_t>(DynIndexStrategy::Expand)] = UINT32_MAX;
+    }
+
+    // Prefer the earlier strategy on a tie, expansion being the first
+    accessInfo.strategy = DynIndexStrategy::Expand;
+    for (uint32_t i = 1; i < static_cast<uint32_t>(DynIndexStrategy::Count); ++i)
+    {
+        if (pCost[i] < pCost[static_cast<uint32_t>(accessInfo.strategy)])
+        {
+            accessInfo.strategy = static_cast<DynIndexStrategy>(i);
+        }
+    }
+
+    m_dynIndexAccesses.push_back(accessInfo);
+    return accessInfo.strategy;
+}
+
+// =====================================================================================================================
+// Outputs the strategies chosen for dynamically-indexed accesses of local arrays.
+void SpirvLowerMemoryOp::OutputDynIndexStrategies() const
+{
+    static const char* StrategyNames[] =
+    {
+        "Expand",
+        "Indexed",
+    };
+    static_assert(sizeof(StrategyNames) / sizeof(StrategyNames[0]) == static_cast<uint32_t>(DynIndexStrategy::Count),
+                  "Unexpected strategy count");
+
+    if (m_dynIndexAccesses.empty())
+    {
+        return;
+    }
+
+    LLPC_OUTS("\n===============================================================================\n");
+    LLPC_OUTS("// LLPC dynamic index strategy results (" << GetShaderStageName(m_shaderStage) << " shader)\n\n");
+
+    for (const auto& accessInfo : m_dynIndexAccesses)
+    {
+        LLPC_OUTS(*accessInfo.pIndexedTy << ": accessCount = " << accessInfo.accessCount <<
+                  ", loopDepth = " << accessInfo.loopDepth);
+        for (uint32_t i = 0; i < static_cast<uint32_t>(DynIndexStrategy::Count); ++i)
+        {
+            LLPC_OUTS(", " << StrategyNames[i] << " = ");
+            if (accessInfo.cost[i] == UINT32_MAX)
+            {
+                LLPC_OUTS("N/A");
+            }
+            else
+            {
+                LLPC_OUTS(accessInfo.cost[i]);
+            }
+        }
+        LLPC_OUTS(" => " << StrategyNames[static_cast<uint32_t>(accessInfo.strategy)] << "\n");
+    }
+    LLPC_OUTS("\n");
+}
+
 // =====================================================================================================================
 // Expands "load" instruction with constant-index "getelementptr" instructions.
 void SpirvLowerMemoryOp::ExpandLoadInst(
@@ -371,11 +538,19 @@ void SpirvLowerMemoryOp::ExpandStoreInst(
     ArrayRef<GetElementPtrInst*> getElemPtrs,    // [in] A group of "getelementptr" with constant indices
     Value*                       pDynIndex)      // [in] Dynamic index
 {
-    const bool robustBufferAccess = m_pContext->GetRobustBufferAccess();
     const uint32_t getElemPtrCount = getElemPtrs.size();
     bool isType64 = (pDynIndex->getType()->getPrimitiveSizeInBits() == 64);
     Value* pFirstStoreDest = getElemPtrs[0];
 
+    // With robust buffer access, the out-of-bound store must be skipped, unless value-range analysis proves the
+    // dynamic index is always in bound (e.g. it is masked or taken modulo the array size).
+    bool robustBufferAccess = m_pContext->GetRobustBufferAccess();
+    if (robustBufferAccess)
+    {
+        const KnownBits indexKnown = computeKnownBits(pDynIndex, pStoreInst->getModule()->getDataLayout());
+        robustBufferAccess = indexKnown.getMaxValue().uge(getElemPtrCount);
+    }
+
     if (robustBufferAccess)
     {
         // The .entry will be splitted into three blocks, .entry, .store and .endStore
@@ -30,6 +30,7 @@
  */
 #pragma once
 
+#include "llvm/Analysis/LoopInfo.h"
 #include "llvm/IR/InstVisitor.h"
 
 #include <unordered_set>
@@ -47,6 +48,26 @@ struct StoreExpandInfo
     Value*                              pDynIndex;   ///< Dynamic index of destination.
 };
 
+// =====================================================================================================================
+// Enumerates the strategies to lower an access to a local variable through a dynamic index.
+enum class DynIndexStrategy : uint32_t
+{
+    Expand = 0,         // Expand to a group of constant-index accesses, selected by the dynamic index
+    Indexed,            // Keep the dynamic index, the backend places the array in indexed VGPRs or in scratch memory
+    Count,
+};
+
+// =====================================================================================================================
+// Represents the decision made for one "getelementptr" with a dynamic index, recorded for dumping.
+struct DynIndexAccessInfo
+{
+    llvm::Type*      pIndexedTy;   ///< Type indexed by the dynamic index
+    uint32_t         accessCount;  ///< Count of "load"/"store" instructions through the pointer
+    uint32_t         loopDepth;    ///< Loop depth of the "getelementptr"
+    uint32_t         cost[static_cast<uint32_t>(DynIndexStrategy::Count)]; ///< Estimated cost of each strategy
+    DynIndexStrategy strategy;     ///< Chosen strategy
+};
+
 // =====================================================================================================================
 // Represents the pass of SPIR-V lowering memory operations.
 class SpirvLowerMemoryOp:
@@ -68,7 +89,11 @@ private:
 
     bool NeedExpandDynamicIndex(llvm::GetElementPtrInst* pGetElemPtr,
                                 uint32_t*                pOperandIndex,
-                                uint32_t*                pDynIndexBound) const;
+                                uint32_t*                pDynIndexBound);
+    DynIndexStrategy SelectDynIndexStrategy(llvm::GetElementPtrInst* pGetElemPtr,
+                                            llvm::Type*              pIndexedTy,
+                                            uint32_t                 dynIndexBound);
+    void OutputDynIndexStrategies() const;
     void ExpandLoadInst(llvm::LoadInst*                          pLoadInst,
                         llvm::ArrayRef<llvm::GetElementPtrInst*> getElemPtrs,
                         llvm::Value*                             pDynIndex);
@@ -82,6 +107,9 @@ private:
     std::unordered_set<llvm::Instruction*> m_removeInsts;
     std::unordered_set<llvm::Instruction*> m_preRemoveInsts;
     SmallVector<StoreExpandInfo, 1>        m_storeExpandInfo;
+
+    llvm::LoopInfo*                        m_pLoopInfo;         // Loop info of the function being visited
+    std::vector<DynIndexAccessInfo>        m_dynIndexAccesses;  // Decisions made for dynamically-indexed accesses
 };
 
 } // Llpc
@@ -2647,6 +2647,10 @@ Value* NggPrimShader::DoCulling(
         return pCullFlag;
     }
 
+    // NOTE: All cullers are emitted into the same block, so a culling-control register fetched by one culler can be
+    // reused by the following ones.
+    m_cullingControlRegs.clear();
+
     auto pEsGsOffset0 = m_pBuilder->CreateIntrinsic(Intrinsic::amdgcn_ubfe,
                                                     m_pBuilder->getInt32Ty(),
                                                     {
@@ -4927,18 +4931,26 @@ Value* NggPrimShader::FetchCullingControlRegister(
     Module*     pModule,        // [in] LLVM module
     uint32_t    regOffset)      // Register offset in the primitive shader table (in BYTEs)
 {
+    auto it = m_cullingControlRegs.find(regOffset);
+    if (it != m_cullingControlRegs.end())
+    {
+        return it->second;
+    }
+
     auto pFetchCullingRegister = pModule->getFunction(LlpcName::NggCullingFetchReg);
     if (pFetchCullingRegister == nullptr)
     {
         pFetchCullingRegister = CreateFetchCullingRegister(pModule);
     }
 
-    return m_pBuilder->CreateCall(pFetchCullingRegister,
-                                  {
-                                      m_nggFactor.pPrimShaderTableAddrLow,
-                                      m_nggFactor.pPrimShaderTableAddrHigh,
-                                      m_pBuilder->getInt32(regOffset)
-                                  });
+    auto pRegValue = m_pBuilder->CreateCall(pFetchCullingRegister,
+                                            {
+                                                m_nggFactor.pPrimShaderTableAddrLow,
+                                                m_nggFactor.pPrimShaderTableAddrHigh,
+                                                m_pBuilder->getInt32(regOffset)
+                                            });
+    m_cullingControlRegs[regOffset] = pRegValue;
+    return pRegValue;
 }
 
 // =====================================================================================================================
@@ -32,6 +32,8 @@
 
 #include "llvm/IR/Module.h"
 
+#include <map>
+
 #include "llpc.h"
 #include "llpcInternal.h"
 #include "llpcNggLdsManager.h"
@@ -258,6 +260,9 @@ private:
     bool        m_hasTes;       // Whether the pipeline has tessellation evaluation shader
     bool        m_hasGs;        // Whether the pipeline has geometry shader
 
+    // Culling-control registers already fetched from primitive shader table (keyed by register offset)
+    std::map<uint32_t, llvm::Value*> m_cullingControlRegs;
+
     std::unique_ptr<llvm::IRBuilder<>>  m_pBuilder; // LLVM IR builder
 };
 
@@ -30,18 +30,198 @@
  */
 #define DEBUG_TYPE "llpc-config-builder-base"
 
+#include "llvm/BinaryFormat/MsgPackWriter.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include "llpcConfigBuilderBase.h"
 #include "llpcAbiMetadata.h"
 #include "llpcPipelineState.h"
 #include "llpcTargetInfo.h"
 
+#include <algorithm>
+
 using namespace Llpc;
 using namespace llvm;
 
+// Names of the pipeline map keys, in ConfigBuilderBase::PipelineKey order
+static const char* const PipelineKeyNames[] =
+{
+    Util::Abi::PipelineMetadataKey::Api,
+    Util::Abi::PipelineMetadataKey::Type,
+    Util::Abi::PipelineMetadataKey::InternalPipelineHash,
+    Util::Abi::PipelineMetadataKey::UserDataLimit,
+    Util::Abi::PipelineMetadataKey::SpillThreshold,
+    Util::Abi::PipelineMetadataKey::UsesViewportArrayIndex,
+    Util::Abi::PipelineMetadataKey::EsGsLdsSize,
+#if LLPC_BUILD_GFX10
+    Util::Abi::PipelineMetadataKey::CalcWaveBreakSizeAtDrawTime,
+#endif
+};
+
+// Names of the API shader map keys, in ConfigBuilderBase::ApiShaderKey order
+static const char* const ApiShaderKeyNames[] =
+{
+    Util::Abi::ShaderMetadataKey::ApiShaderHash,
+    Util::Abi::ShaderMetadataKey::HardwareMapping,
+};
+
+// Names of the hardware shader map keys, in ConfigBuilderBase::HwShaderKey order
+static const char* const HwShaderKeyNames[] =
+{
+    Util::Abi::HardwareStageMetadataKey::SgprLimit,
+    Util::Abi::HardwareStageMetadataKey::VgprLimit,
+    Util::Abi::HardwareStageMetadataKey::UsesUavs,
+    Util::Abi::HardwareStageMetadataKey::WritesUavs,
+    Util::Abi::HardwareStageMetadataKey::WritesDepth,
+    Util::Abi::HardwareStageMetadataKey::LdsSize,
+#if LLPC_BUILD_GFX10
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 495
+    Util::Abi::HardwareStageMetadataKey::WavefrontSize,
+#endif
+#endif
+};
+
+static const char RegistersKeyName[] = ".registers";
+
+// Represents an entry of a MsgPack map to be streamed out
+struct PalMetadataMapEntry
+{
+    StringRef               key;      // Key
+    const PalMetadataValue* pValue;   // Value, or nullptr if the value is a nested map
+    uint32_t                mapId;    // ID of the nested map, if pValue is nullptr
+};
+
+// =====================================================================================================================
+// Sets an unsigned integer PAL metadata value.
+static void SetUInt(
+    PalMetadataValue* pValue,   // [out] Metadata value
+    uint64_t          value)    // Value to set
+{
+    pValue->kind = PalMetadataValueKind::UInt;
+    pValue->value[0] = value;
+}
+
+// =====================================================================================================================
+// Sets a boolean PAL metadata value.
+static void SetBool(
+    PalMetadataValue* pValue,   // [out] Metadata value
+    bool              value)    // Value to set
+{
+    pValue->kind = PalMetadataValueKind::Bool;
+    pValue->value[0] = value;
+}
+
+// =====================================================================================================================
+// Sets a string PAL metadata value.
+static void SetString(
+    PalMetadataValue* pValue,   // [out] Metadata value
+    const char*       pString)  // [in] Value to set, must be a string literal
+{
+    pValue->kind = PalMetadataValueKind::String;
+    pValue->pString = pString;
+}
+
+// =====================================================================================================================
+// Sets a PAL metadata value that is an array of two unsigned integers.
+static void SetUIntPair(
+    PalMetadataValue* pValue,   // [out] Metadata value
+    uint64_t          value0,   // First element
+    uint64_t          value1)   // Second element
+{
+    pValue->kind = PalMetadataValueKind::UIntPair;
+    pValue->value[0] = value0;
+    pValue->value[1] = value1;
+}
+
+// =====================================================================================================================
+// Writes a PAL metadata value to the MsgPack stream.
+static void WriteValue(
+    msgpack::Writer&        writer,   // [in/out] MsgPack writer
+    const PalMetadataValue& value)    // [in] Metadata value
+{
+    switch (value.kind)
+    {
+    case PalMetadataValueKind::UInt:
+        writer.write(value.value[0]);
+        break;
+    case PalMetadataValueKind::Bool:
+        writer.write(value.value[0] != 0);
+        break;
+    case PalMetadataValueKind::String:
+        writer.write(StringRef(value.pString));
+        break;
+    case PalMetadataValueKind::UIntPair:
+        writer.writeArraySize(2);
+        writer.write(value.value[0]);
+        writer.write(value.value[1]);
+        break;
+    case PalMetadataValueKind::HwStageMask:
+        writer.writeArraySize(countPopulation(value.value[0]));
+        for (uint32_t hwStage = 0; hwStage < uint32_t(Util::Abi::HardwareStage::Count); ++hwStage)
+        {
+            if ((value.value[0] & (1ull << hwStage)) != 0)
+            {
+                writer.write(StringRef(HwStageNames[hwStage]));
+            }
+        }
+        break;
+    default:
+        LLPC_NEVER_CALLED();
+        break;
+    }
+}
+
+// =====================================================================================================================
+// Sorts the entries of a MsgPack map by key and writes the map header. Keys are written in the order that
+// llvm::msgpack::Document writes them, so the blob does not depend on the order values were set in.
+static void BeginMap(
+    msgpack::Writer&                      writer,    // [in/out] MsgPack writer
+    MutableArrayRef<PalMetadataMapEntry>  entries)   // [in/out] Map entries
+{
+    std::sort(entries.begin(),
+              entries.end(),
+              [](const PalMetadataMapEntry& lhs, const PalMetadataMapEntry& rhs) { return lhs.key < rhs.key; });
+    writer.writeMapSize(entries.size());
+}
+
+// =====================================================================================================================
+// Writes a MsgPack map of the PAL metadata values that are set.
+static void WriteValueMap(
+    msgpack::Writer&                writer,     // [in/out] MsgPack writer
+    ArrayRef<const char*>           keyNames,   // Key table of the map
+    ArrayRef<PalMetadataValue>      values)     // Values of the map, in key table order
+{
+    SmallVector<PalMetadataMapEntry, 16> entries;
+    for (uint32_t key = 0; key < values.size(); ++key)
+    {
+        if (values[key].kind != PalMetadataValueKind::None)
+        {
+            entries.push_back({ keyNames[key], &values[key], 0 });
+        }
+    }
+
+    BeginMap(writer, entries);
+    for (const auto& entry : entries)
+    {
+        writer.write(entry.key);
+        WriteValue(writer, *entry.pValue);
+    }
+}
+
+// =====================================================================================================================
+// Checks whether any of the PAL metadata values is set.
+static bool HasValue(
+    ArrayRef<PalMetadataValue> values)  // Values of a map
+{
+    return std::any_of(values.begin(),
+                       values.end(),
+                       [](const PalMetadataValue& value) { return value.kind != PalMetadataValueKind::None; });
+}
+
 // =====================================================================================================================
 ConfigBuilderBase::ConfigBuilderBase(
     llvm::Module*   pModule,        // [in/out] LLVM module
@@ -50,8 +230,15 @@ ConfigBuilderBase::ConfigBuilderBase(
     m_pModule(pModule),
     m_pPipelineState(pPipelineState),
     m_userDataLimit(0),
-    m_spillThreshold(UINT32_MAX)
+    m_spillThreshold(UINT32_MAX),
+    m_pipelineValues(),
+    m_apiShaderValues(),
+    m_hwShaderValues()
 {
+    static_assert(sizeof(PipelineKeyNames) / sizeof(PipelineKeyNames[0]) == PipelineKeyCount, "Unexpected size");
+    static_assert(sizeof(ApiShaderKeyNames) / sizeof(ApiShaderKeyNames[0]) == ApiShaderKeyCount, "Unexpected size");
+    static_assert(sizeof(HwShaderKeyNames) / sizeof(HwShaderKeyNames[0]) == HwShaderKeyCount, "Unexpected size");
+
     m_pContext = static_cast<Context*>(&pModule->getContext());
 
     m_hasVs = m_pPipelineState->HasShaderStage(ShaderStageVertex);
@@ -61,18 +248,13 @@ ConfigBuilderBase::ConfigBuilderBase(
 
     m_gfxIp = m_pPipelineState->GetTargetInfo().GetGfxIpVersion();
 
-#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 477
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION < 477
     // Only generate MsgPack PAL metadata for PAL client 477 onwards. PAL changed the .note record type
     // from 13 to 32 at that point, and not using MsgPack metadata before that avoids some compatibility
     // problems.
-    m_document = std::make_unique<msgpack::Document>();
-#else
     LLPC_NEVER_CALLED();
 #endif
 
-    m_pipelineNode = m_document->getRoot().getMap(true)[Util::Abi::PalCodeObjectMetadataKey::Pipelines]
-                                              .getArray(true)[0].getMap(true);
-
     SetApiName("Vulkan"); // TODO: Client API name should be from ICD.
 }
 
@@ -91,41 +273,13 @@ void ConfigBuilderBase::AddApiHwShaderMapping(
     ShaderStage apiStage,
     uint32_t hwStages)
 {
-    auto hwMappingNode = GetApiShaderNode(apiStage)[Util::Abi::ShaderMetadataKey::HardwareMapping]
-                            .getArray(true);
-    for (uint32_t hwStage = 0; hwStage < uint32_t(Util::Abi::HardwareStage::Count); ++hwStage)
-    {
-        if (hwStages & (1 << hwStage))
-        {
-            hwMappingNode.push_back(m_document->getNode(HwStageNames[hwStage]));
-        }
-    }
-}
-
-// =====================================================================================================================
-// Get the MsgPack map node for the specified API shader in the ".shaders" map
-msgpack::MapDocNode ConfigBuilderBase::GetApiShaderNode(
-    uint32_t apiStage)  // API shader stage
-{
-    if (m_apiShaderNodes[apiStage].isEmpty())
-    {
-        m_apiShaderNodes[apiStage] = m_pipelineNode[Util::Abi::PipelineMetadataKey::Shaders]
-                                                   .getMap(true)[ApiStageNames[apiStage]].getMap(true);
-    }
-    return m_apiShaderNodes[apiStage];
-}
-
-// =====================================================================================================================
-// Get the MsgPack map node for the specified hardware shader in the ".hardware_stages" map
-msgpack::MapDocNode ConfigBuilderBase::GetHwShaderNode(
-    Util::Abi::HardwareStage hwStage)   // Hardware shader stage
-{
-    if (m_hwShaderNodes[uint32_t(hwStage)].isEmpty())
+    auto pValue = &m_apiShaderValues[apiStage][ApiShaderKeyHardwareMapping];
+    if (pValue->kind != PalMetadataValueKind::HwStageMask)
     {
-        m_hwShaderNodes[uint32_t(hwStage)] = m_pipelineNode[Util::Abi::PipelineMetadataKey::HardwareStages]
-                                                .getMap(true)[HwStageNames[uint32_t(hwStage)]].getMap(true);
+        pValue->kind = PalMetadataValueKind::HwStageMask;
+        pValue->value[0] = 0;
     }
-    return m_hwShaderNodes[uint32_t(hwStage)];
+    pValue->value[0] |= hwStages & ((1u << uint32_t(Util::Abi::HardwareStage::Count)) - 1);
 }
 
 // =====================================================================================================================
@@ -135,9 +289,7 @@ uint32_t ConfigBuilderBase::SetShaderHash(
     ShaderStage   apiStage) // API shader stage
 {
     const ShaderOptions& shaderOptions = m_pPipelineState->GetShaderOptions(apiStage);
-    auto hashNode = GetApiShaderNode(uint32_t(apiStage))[Util::Abi::ShaderMetadataKey::ApiShaderHash].getArray(true);
-    hashNode[0] = hashNode.getDocument()->getNode(shaderOptions.hash[0]);
-    hashNode[1] = hashNode.getDocument()->getNode(shaderOptions.hash[1]);
+    SetUIntPair(&m_apiShaderValues[apiStage][ApiShaderKeyApiShaderHash], shaderOptions.hash[0], shaderOptions.hash[1]);
     return shaderOptions.hash[0] >> 32 ^ shaderOptions.hash[0] ^ shaderOptions.hash[1] >> 32 ^ shaderOptions.hash[1];
 }
 
@@ -147,8 +299,7 @@ void ConfigBuilderBase::SetNumAvailSgprs(
     Util::Abi::HardwareStage hwStage, // Hardware shader stage
     uint32_t value)                   // Number of available SGPRs
 {
-    auto hwShaderNode = GetHwShaderNode(hwStage);
-    hwShaderNode[Util::Abi::HardwareStageMetadataKey::SgprLimit] = hwShaderNode.getDocument()->getNode(value);
+    SetUInt(&m_hwShaderValues[uint32_t(hwStage)][HwShaderKeySgprLimit], value);
 }
 
 // =====================================================================================================================
@@ -157,8 +308,7 @@ void ConfigBuilderBase::SetNumAvailVgprs(
     Util::Abi::HardwareStage hwStage, // Hardware shader stage
     uint32_t value)                   // Number of available VGPRs
 {
-    auto hwShaderNode = GetHwShaderNode(hwStage);
-    hwShaderNode[Util::Abi::HardwareStageMetadataKey::VgprLimit] = hwShaderNode.getDocument()->getNode(value);
+    SetUInt(&m_hwShaderValues[uint32_t(hwStage)][HwShaderKeyVgprLimit], value);
 }
 
 // =====================================================================================================================
@@ -171,7 +321,7 @@ void ConfigBuilderBase::SetUsesViewportArrayIndex(
         return; // Optional
     }
 
-    m_pipelineNode[Util::Abi::PipelineMetadataKey::UsesViewportArrayIndex] = m_document->getNode(value);
+    SetBool(&m_pipelineValues[PipelineKeyUsesViewportArrayIndex], value);
 }
 
 // =====================================================================================================================
@@ -184,8 +334,7 @@ void ConfigBuilderBase::SetPsUsesUavs(
         return; // Optional
     }
 
-    GetHwShaderNode(Util::Abi::HardwareStage::Ps)[Util::Abi::HardwareStageMetadataKey::UsesUavs] =
-        m_document->getNode(value);
+    SetBool(&m_hwShaderValues[uint32_t(Util::Abi::HardwareStage::Ps)][HwShaderKeyUsesUavs], value);
 }
 
 // =====================================================================================================================
@@ -198,9 +347,7 @@ void ConfigBuilderBase::SetPsWritesUavs(
         return; // Optional
     }
 
-    GetHwShaderNode(Util::Abi::HardwareStage::Ps)[Util::Abi::HardwareStageMetadataKey::WritesUavs] =
-        m_document->getNode(value);
-
+    SetBool(&m_hwShaderValues[uint32_t(Util::Abi::HardwareStage::Ps)][HwShaderKeyWritesUavs], value);
 }
 
 // =====================================================================================================================
@@ -213,8 +360,7 @@ void ConfigBuilderBase::SetPsWritesDepth(
         return; // Optional
     }
 
-    GetHwShaderNode(Util::Abi::HardwareStage::Ps)[Util::Abi::HardwareStageMetadataKey::WritesDepth] =
-        m_document->getNode(value);
+    SetBool(&m_hwShaderValues[uint32_t(Util::Abi::HardwareStage::Ps)][HwShaderKeyWritesDepth], value);
 }
 
 // =====================================================================================================================
@@ -222,7 +368,7 @@ void ConfigBuilderBase::SetPsWritesDepth(
 void ConfigBuilderBase::SetEsGsLdsByteSize(
     uint32_t value)   // Value to set
 {
-    m_pipelineNode[Util::Abi::PipelineMetadataKey::EsGsLdsSize] = m_document->getNode(value);
+    SetUInt(&m_pipelineValues[PipelineKeyEsGsLdsSize], value);
 }
 
 #if LLPC_BUILD_GFX10
@@ -231,7 +377,7 @@ void ConfigBuilderBase::SetEsGsLdsByteSize(
 void ConfigBuilderBase::SetCalcWaveBreakSizeAtDrawTime(
     bool value)   // Value to set
 {
-    m_pipelineNode[Util::Abi::PipelineMetadataKey::CalcWaveBreakSizeAtDrawTime] = m_document->getNode(value);
+    SetBool(&m_pipelineValues[PipelineKeyCalcWaveBreakSizeAtDrawTime], value);
 }
 
 #if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 495
@@ -241,8 +387,7 @@ void ConfigBuilderBase::SetWaveFrontSize(
     Util::Abi::HardwareStage hwStage,   // Hardware shader stage
     uint32_t                 value)     // Value to set
 {
-    auto hwShaderNode = GetHwShaderNode(hwStage);
-    hwShaderNode[Util::Abi::HardwareStageMetadataKey::WavefrontSize] = m_document->getNode(value);
+    SetUInt(&m_hwShaderValues[uint32_t(hwStage)][HwShaderKeyWavefrontSize], value);
 }
 
 #endif
@@ -251,9 +396,9 @@ void ConfigBuilderBase::SetWaveFrontSize(
 // =====================================================================================================================
 // Set API name
 void ConfigBuilderBase::SetApiName(
-    const char* pValue) // [in] Value to set
+    const char* pValue) // [in] Value to set, must be a string literal
 {
-    m_pipelineNode[Util::Abi::PipelineMetadataKey::Api] = m_document->getNode(pValue);
+    SetString(&m_pipelineValues[PipelineKeyApi], pValue);
 }
 
 // =====================================================================================================================
@@ -288,7 +433,7 @@ void ConfigBuilderBase::SetPipelineType(
     default:
         break;
     }
-    m_pipelineNode[Util::Abi::PipelineMetadataKey::Type] = m_document->getNode(pValue);
+    SetString(&m_pipelineValues[PipelineKeyType], pValue);
 }
 
 // =====================================================================================================================
@@ -302,8 +447,7 @@ void ConfigBuilderBase::SetLdsSizeByteSize(
         return; // Optional
     }
 
-    auto hwShaderNode = GetHwShaderNode(hwStage);
-    hwShaderNode[Util::Abi::HardwareStageMetadataKey::LdsSize] = hwShaderNode.getDocument()->getNode(value);
+    SetUInt(&m_hwShaderValues[uint32_t(hwStage)][HwShaderKeyLdsSize], value);
 }
 
 // =====================================================================================================================
@@ -316,21 +460,21 @@ void ConfigBuilderBase::SetEsGsLdsSize(
         return; // Optional
     }
 
-    m_pipelineNode[Util::Abi::PipelineMetadataKey::EsGsLdsSize] = m_document->getNode(value);
+    SetUInt(&m_pipelineValues[PipelineKeyEsGsLdsSize], value);
 }
 
 // =====================================================================================================================
 // Set USER_DATA_LIMIT (called once for the whole pipeline)
 void ConfigBuilderBase::SetUserDataLimit()
 {
-    m_pipelineNode[Util::Abi::PipelineMetadataKey::UserDataLimit] = m_document->getNode(m_userDataLimit);
+    SetUInt(&m_pipelineValues[PipelineKeyUserDataLimit], m_userDataLimit);
 }
 
 // =====================================================================================================================
 // Set SPILL_THRESHOLD (called once for the whole pipeline)
 void ConfigBuilderBase::SetSpillThreshold()
 {
-    m_pipelineNode[Util::Abi::PipelineMetadataKey::SpillThreshold] = m_document->getNode(m_spillThreshold);
+    SetUInt(&m_pipelineValues[PipelineKeySpillThreshold], m_spillThreshold);
 }
 
 // =====================================================================================================================
@@ -338,10 +482,7 @@ void ConfigBuilderBase::SetSpillThreshold()
 void ConfigBuilderBase::SetPipelineHash()
 {
     const auto& options = m_pPipelineState->GetOptions();
-
-    auto pipelineHashNode = m_pipelineNode[Util::Abi::PipelineMetadataKey::InternalPipelineHash].getArray(true);
-    pipelineHashNode[0] = m_document->getNode(options.hash[0]);
-    pipelineHashNode[1] = m_document->getNode(options.hash[1]);
+    SetUIntPair(&m_pipelineValues[PipelineKeyInternalPipelineHash], options.hash[0], options.hash[1]);
 }
 
 // =====================================================================================================================
@@ -385,8 +526,133 @@ void ConfigBuilderBase::AppendConfig(llvm::ArrayRef<Util::Abi::PalMetadataNoteEn
     }
 }
 
+// =====================================================================================================================
+// Write the ".registers" map to the MsgPack stream. Registers are written in ascending order and, for a register
+// appended more than once, the last value wins.
+void ConfigBuilderBase::WriteRegisterMap(
+    msgpack::Writer& writer)    // [in/out] MsgPack writer
+{
+    std::stable_sort(m_config.begin(),
+                     m_config.end(),
+                     [](const Util::Abi::PalMetadataNoteEntry& lhs, const Util::Abi::PalMetadataNoteEntry& rhs)
+                     {
+                         return lhs.key < rhs.key;
+                     });
+
+    // Compact to the last entry of each key.
+    uint32_t count = 0;
+    for (uint32_t idx = 0; idx < m_config.size(); ++idx)
+    {
+        LLPC_ASSERT(m_config[idx].key != InvalidMetadataKey);
+        if ((count > 0) && (m_config[count - 1].key == m_config[idx].key))
+        {
+            m_config[count - 1] = m_config[idx];
+        }
+        else
+        {
+            m_config[count++] = m_config[idx];
+        }
+    }
+    m_config.resize(count);
+
+    writer.writeMapSize(m_config.size());
+    for (const auto& entry : m_config)
+    {
+        writer.write(uint64_t(entry.key));
+        writer.write(uint64_t(entry.value));
+    }
+}
+
+// =====================================================================================================================
+// Write the pipeline map (amdpal.pipelines[0]) to the MsgPack stream.
+void ConfigBuilderBase::WritePipelineMap(
+    msgpack::Writer& writer)    // [in/out] MsgPack writer
+{
+    // IDs of nested maps in the pipeline map
+    enum : uint32_t
+    {
+        HardwareStagesMap,
+        RegistersMap,
+        ShadersMap,
+    };
+
+    SmallVector<PalMetadataMapEntry, PipelineKeyCount + 3> entries;
+    for (uint32_t key = 0; key < PipelineKeyCount; ++key)
+    {
+        if (m_pipelineValues[key].kind != PalMetadataValueKind::None)
+        {
+            entries.push_back({ PipelineKeyNames[key], &m_pipelineValues[key], 0 });
+        }
+    }
+
+    SmallVector<PalMetadataMapEntry, uint32_t(Util::Abi::HardwareStage::Count)> hwStageEntries;
+    for (uint32_t hwStage = 0; hwStage < uint32_t(Util::Abi::HardwareStage::Count); ++hwStage)
+    {
+        if (HasValue(m_hwShaderValues[hwStage]))
+        {
+            hwStageEntries.push_back({ HwStageNames[hwStage], nullptr, hwStage });
+        }
+    }
+
+    SmallVector<PalMetadataMapEntry, ShaderStageNativeStageCount> apiStageEntries;
+    for (uint32_t apiStage = 0; apiStage < ShaderStageNativeStageCount; ++apiStage)
+    {
+        if (HasValue(m_apiShaderValues[apiStage]))
+        {
+            apiStageEntries.push_back({ ApiStageNames[apiStage], nullptr, apiStage });
+        }
+    }
+
+    if (hwStageEntries.empty() == false)
+    {
+        entries.push_back({ Util::Abi::PipelineMetadataKey::HardwareStages, nullptr, HardwareStagesMap });
+    }
+    entries.push_back({ RegistersKeyName, nullptr, RegistersMap });
+    if (apiStageEntries.empty() == false)
+    {
+        entries.push_back({ Util::Abi::PipelineMetadataKey::Shaders, nullptr, ShadersMap });
+    }
+
+    BeginMap(writer, entries);
+    for (const auto& entry : entries)
+    {
+        writer.write(entry.key);
+        if (entry.pValue != nullptr)
+        {
+            WriteValue(writer, *entry.pValue);
+        }
+        else if (entry.mapId == HardwareStagesMap)
+        {
+            BeginMap(writer, hwStageEntries);
+            for (const auto& hwStageEntry : hwStageEntries)
+            {
+                writer.write(hwStageEntry.key);
+                WriteValueMap(writer, HwShaderKeyNames, m_hwShaderValues[hwStageEntry.mapId]);
+            }
+        }
+        else if (entry.mapId == RegistersMap)
+        {
+            WriteRegisterMap(writer);
+        }
+        else
+        {
+            LLPC_ASSERT(entry.mapId == ShadersMap);
+            BeginMap(writer, apiStageEntries);
+            for (const auto& apiStageEntry : apiStageEntries)
+            {
+                writer.write(apiStageEntry.key);
+                WriteValueMap(writer, ApiShaderKeyNames, m_apiShaderValues[apiStageEntry.mapId]);
+            }
+        }
+    }
+}
+
 // =====================================================================================================================
 // Write the config into PAL metadata in the LLVM IR module
+//
+// NOTE: The metadata is streamed out as MsgPack straight from the recorded values, rather than built up as an
+// llvm::msgpack::Document. A document is only built where the metadata is merged with others, i.e. by the back-end
+// with its own PAL metadata, and by ElfWriter when merging pipeline ELFs.
 void ConfigBuilderBase::WritePalMetadata()
 {
     // Set whole-pipeline values.
@@ -394,27 +660,26 @@ void ConfigBuilderBase::WritePalMetadata()
     SetSpillThreshold();
     SetPipelineHash();
 
-    // Generating MsgPack metadata.
-    // Add the register values to the MsgPack document.
-    msgpack::MapDocNode registers = m_pipelineNode[".registers"].getMap(true);
-    for (const auto& entry : m_config)
-    {
-        LLPC_ASSERT(entry.key != InvalidMetadataKey);
-        auto key   = m_document->getNode(entry.key);
-        auto value = m_document->getNode(entry.value);
-        registers[key] = value;
+    std::string blob;
+    raw_string_ostream blobStream(blob);
+    msgpack::Writer writer(blobStream);
 
-    }
+    // Root map: "amdpal.pipelines" sorts before "amdpal.version".
+    writer.writeMapSize(2);
+
+    writer.write(StringRef(Util::Abi::PalCodeObjectMetadataKey::Pipelines));
+    writer.writeArraySize(1);
+    WritePipelineMap(writer);
 
     // Add the metadata version number.
-    auto versionNode = m_document->getRoot().getMap(true)[Util::Abi::PalCodeObjectMetadataKey::Version]
-                            .getArray(true);
-    versionNode[0] = m_document->getNode(Util::Abi::PipelineMetadataMajorVersion);
-    versionNode[1] = m_document->getNode(Util::Abi::PipelineMetadataMinorVersion);
+    writer.write(StringRef(Util::Abi::PalCodeObjectMetadataKey::Version));
+    writer.writeArraySize(2);
+    writer.write(uint64_t(Util::Abi::PipelineMetadataMajorVersion));
+    writer.write(uint64_t(Util::Abi::PipelineMetadataMinorVersion));
 
-    // Write the MsgPack document into an IR metadata node.
-    std::string blob;
-    m_document->writeToBlob(blob);
+    blobStream.flush();
+
+    // Write the MsgPack blob into an IR metadata node.
     auto pAbiMetaString = MDString::get(m_pModule->getContext(), blob);
     auto pAbiMetaNode = MDNode::get(m_pModule->getContext(), pAbiMetaString);
     auto pNamedMeta = m_pModule->getOrInsertNamedMetadata("amdgpu.pal.metadata.msgpack");
@@ -31,13 +31,39 @@
 #pragma once
 
 #include "llpcContext.h"
-#include "llvm/BinaryFormat/MsgPackDocument.h"
+
+namespace llvm
+{
+namespace msgpack
+{
+class Writer;
+} // msgpack
+} // llvm
 
 namespace Llpc
 {
 
 class PipelineState;
 
+// Kind of a PAL metadata value recorded by the config builder
+enum class PalMetadataValueKind : uint32_t
+{
+    None,           // Not set, the key is omitted
+    UInt,           // Unsigned integer
+    Bool,           // Boolean
+    String,         // String
+    UIntPair,       // Array of two unsigned integers (e.g. 128-bit hash)
+    HwStageMask,    // Array of hardware stage names, from a mask of Util::Abi::HardwareStageFlagBits
+};
+
+// Represents a PAL metadata value recorded by the config builder, streamed out by WritePalMetadata()
+struct PalMetadataValue
+{
+    PalMetadataValueKind  kind;       // Kind of value
+    uint64_t              value[2];   // Integer value(s), or boolean or hardware stage mask in value[0]
+    const char*           pString;    // String value (must be a string literal)
+};
+
 // =====================================================================================================================
 // Register configuration builder base class.
 class ConfigBuilderBase
@@ -102,10 +128,47 @@ protected:
     uint32_t                        m_spillThreshold;     // Spill threshold for shaders seen so far
 
 private:
-    // Get the MsgPack map node for the specified API shader in the ".shaders" map
-    llvm::msgpack::MapDocNode GetApiShaderNode(uint32_t apiStage);
-    // Get the MsgPack map node for the specified HW shader in the ".hardware_stages" map
-    llvm::msgpack::MapDocNode GetHwShaderNode(Util::Abi::HardwareStage hwStage);
+    // Keys of the pipeline map that the config builder writes, indices into its key table
+    enum PipelineKey : uint32_t
+    {
+        PipelineKeyApi,
+        PipelineKeyType,
+        PipelineKeyInternalPipelineHash,
+        PipelineKeyUserDataLimit,
+        PipelineKeySpillThreshold,
+        PipelineKeyUsesViewportArrayIndex,
+        PipelineKeyEsGsLdsSize,
+#if LLPC_BUILD_GFX10
+        PipelineKeyCalcWaveBreakSizeAtDrawTime,
+#endif
+        PipelineKeyCount
+    };
+
+    // Keys of an API shader map in ".shaders", indices into its key table
+    enum ApiShaderKey : uint32_t
+    {
+        ApiShaderKeyApiShaderHash,
+        ApiShaderKeyHardwareMapping,
+        ApiShaderKeyCount
+    };
+
+    // Keys of a hardware shader map in ".hardware_stages", indices into its key table
+    enum HwShaderKey : uint32_t
+    {
+        HwShaderKeySgprLimit,
+        HwShaderKeyVgprLimit,
+        HwShaderKeyUsesUavs,
+        HwShaderKeyWritesUavs,
+        HwShaderKeyWritesDepth,
+        HwShaderKeyLdsSize,
+#if LLPC_BUILD_GFX10
+#if PAL_CLIENT_INTERFACE_MAJOR_VERSION >= 495
+        HwShaderKeyWavefrontSize,
+#endif
+#endif
+        HwShaderKeyCount
+    };
+
     // Set USER_DATA_LIMIT (called once for the whole pipeline)
     void SetUserDataLimit();
     // Set SPILL_THRESHOLD (called once for the whole pipeline)
@@ -113,15 +176,17 @@ private:
     // Set PIPELINE_HASH (called once for the whole pipeline)
     void SetPipelineHash();
 
+    // Stream the recorded metadata out as MsgPack
+    void WritePipelineMap(llvm::msgpack::Writer& writer);
+    void WriteRegisterMap(llvm::msgpack::Writer& writer);
+
     // -----------------------------------------------------------------------------------------------------------------
-    std::unique_ptr<llvm::msgpack::Document>  m_document;       // The MsgPack document
-    llvm::msgpack::MapDocNode                 m_pipelineNode;   // MsgPack map node for amdpal.pipelines[0]
-    llvm::msgpack::MapDocNode                 m_apiShaderNodes[ShaderStageNativeStageCount];
-                                                                // MsgPack map node for each API shader's node in
-                                                                //  ".shaders"
-    llvm::msgpack::MapDocNode                 m_hwShaderNodes[uint32_t(Util::Abi::HardwareStage::Count)];
-                                                                // MsgPack map node for each HW shader's node in
-                                                                //  ".hardware_stages"
+    PalMetadataValue  m_pipelineValues[PipelineKeyCount];     // Values of the pipeline map (amdpal.pipelines[0])
+    PalMetadataValue  m_apiShaderValues[ShaderStageNativeStageCount][ApiShaderKeyCount];
+                                                              // Values of each API shader's map in ".shaders"
+    PalMetadataValue  m_hwShaderValues[uint32_t(Util::Abi::HardwareStage::Count)][HwShaderKeyCount];
+                                                              // Values of each HW shader's map in
+                                                              //  ".hardware_stages"
 
     llvm::SmallVector<Util::Abi::PalMetadataNoteEntry, 128> m_config; // Register/metadata configuration
 };
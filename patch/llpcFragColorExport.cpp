@@ -1192,22 +1192,17 @@ Value* FragColorExport::Run(
     Type* pOutputTy = pOutput->getType();
     const uint32_t origLoc = pResUsage->inOutUsage.fs.outputOrigLocs[location];
 
-    ExportFormat expFmt = EXP_FORMAT_ZERO;
-    if (pPipelineInfo->cbState.dualSourceBlendEnable)
-    {
-        // Dual source blending is enabled
-        expFmt= ComputeExportFormat(pOutputTy, 0);
-    }
-    else
-    {
-        expFmt = ComputeExportFormat(pOutputTy, origLoc);
-    }
+    // NOTE: When dual source blending is enabled, both outputs are exported against the format of color target 0.
+    const uint32_t cbLoc = pPipelineInfo->cbState.dualSourceBlendEnable ? 0 : origLoc;
+
+    const ExportFormat expFmt = ComputeExportFormat(pOutputTy, cbLoc);
 
     pResUsage->inOutUsage.fs.expFmts[location] = expFmt;
     if (expFmt == EXP_FORMAT_ZERO)
     {
         // Clear channel mask if shader export format is ZERO
         pResUsage->inOutUsage.fs.cbShaderMask &= ~(0xF << (4 * origLoc));
+        return nullptr;
     }
 
     const uint32_t bitWidth = pOutputTy->getScalarSizeInBits();
@@ -1219,38 +1214,43 @@ Value* FragColorExport::Run(
     auto pCompTy = pOutputTy->isVectorTy() ? pOutputTy->getVectorElementType() : pOutputTy;
     uint32_t compCount = pOutputTy->isVectorTy() ? pOutputTy->getVectorNumElements() : 1;
 
+    // Components the color target does not consume are neither converted nor exported
+    const uint32_t liveMask = ComputeLiveComponentMask(cbLoc) & ((1 << compCount) - 1);
+
+    // NOTE: 8-bit and 16-bit outputs exported as FP16 are packed directly from the output vector, so the components
+    // are only extracted for the other export formats.
+    const bool packFromVector = ((expFmt == EXP_FORMAT_FP16_ABGR) && (bitWidth <= 16));
+
     Value* comps[4] = { nullptr };
     if (compCount == 1)
     {
         comps[0] = pOutput;
     }
-    else
+    else if (packFromVector == false)
     {
         for (uint32_t i = 0; i < compCount; ++i)
         {
-            comps[i] = ExtractElementInst::Create(pOutput,
-                                                  ConstantInt::get(m_pContext->Int32Ty(), i),
-                                                  "",
-                                                  pInsertPos);
+            if ((liveMask & (1 << i)) != 0)
+            {
+                comps[i] = ExtractElementInst::Create(pOutput,
+                                                      ConstantInt::get(m_pContext->Int32Ty(), i),
+                                                      "",
+                                                      pInsertPos);
+            }
         }
     }
 
     bool comprExp = false;
-    bool needPack = false;
+    uint32_t expMask = 0;
 
     const auto pUndefFloat     = UndefValue::get(m_pContext->FloatTy());
-    const auto pUndefFloat16   = UndefValue::get(m_pContext->Float16Ty());
     const auto pUndefFloat16x2 = UndefValue::get(m_pContext->Float16x2Ty());
 
     switch (expFmt)
     {
-    case EXP_FORMAT_ZERO:
-        {
-            break;
-        }
     case EXP_FORMAT_32_R:
         {
-            compCount = 1;
+            expMask = 0x1;
             comps[0] = ConvertToFloat(comps[0], signedness, pInsertPos);
             comps[1] = pUndefFloat;
             comps[2] = pUndefFloat;
@@ -1261,7 +1261,7 @@ Value* FragColorExport::Run(
         {
             if (compCount >= 2)
             {
-                compCount = 2;
+                expMask = 0x3;
                 comps[0] = ConvertToFloat(comps[0], signedness, pInsertPos);
                 comps[1] = ConvertToFloat(comps[1], signedness, pInsertPos);
                 comps[2] = pUndefFloat;
@@ -1269,7 +1269,7 @@ Value* FragColorExport::Run(
             }
             else
             {
-                compCount = 1;
+                expMask = 0x1;
                 comps[0] = ConvertToFloat(comps[0], signedness, pInsertPos);
                 comps[1] = pUndefFloat;
                 comps[2] = pUndefFloat;
@@ -1281,15 +1281,18 @@ Value* FragColorExport::Run(
         {
             if (compCount == 4)
             {
-                compCount = 2;
+                // NOTE: Alpha is not live for a one-component format that doesn't export alpha but still uses this
+                // export format, as R16 UNORM/SNORM with blending does when RB+ is enabled. It is not exported then.
+                const bool alphaLive = ((liveMask & ChannelMask::W) != 0);
+                expMask = alphaLive ? 0x3 : 0x1;
                 comps[0] = ConvertToFloat(comps[0], signedness, pInsertPos);
-                comps[1] = ConvertToFloat(comps[3], signedness, pInsertPos);
+                comps[1] = alphaLive ? ConvertToFloat(comps[3], signedness, pInsertPos) : pUndefFloat;
                 comps[2] = pUndefFloat;
                 comps[3] = pUndefFloat;
             }
             else
             {
-                compCount = 1;
+                expMask = 0x1;
                 comps[0] = ConvertToFloat(comps[0], signedness, pInsertPos);
                 comps[1] = pUndefFloat;
                 comps[2] = pUndefFloat;
@@ -1299,14 +1302,11 @@ Value* FragColorExport::Run(
         }
     case EXP_FORMAT_32_ABGR:
        {
-            for (uint32_t i = 0; i < compCount; ++i)
+            expMask = liveMask;
+            for (uint32_t i = 0; i < 4; ++i)
             {
-                comps[i] = ConvertToFloat(comps[i], signedness, pInsertPos);
-            }
-
-            for (uint32_t i = compCount; i < 4; ++i)
-            {
-                comps[i] = pUndefFloat;
+                comps[i] = ((liveMask & (1 << i)) != 0) ? ConvertToFloat(comps[i], signedness, pInsertPos) :
+                                                          pUndefFloat;
             }
             break;
         }
@@ -1314,92 +1314,102 @@ Value* FragColorExport::Run(
         {
             comprExp = true;
 
-            if (bitWidth == 8)
+            if (packFromVector)
             {
-                needPack = true;
-
-                // Cast i8 to float16
-                LLPC_ASSERT(pCompTy->isIntegerTy());
-                for (uint32_t i = 0; i < compCount; ++i)
+                // Reinterpret the output as float16 values, then split it into two <2 x half> halves without
+                // going through individual components
+                Type* pFloat16Ty = m_pContext->Float16Ty();
+                Value* pOutput16 = pOutput;
+                if (bitWidth == 8)
                 {
+                    // Cast i8 to float16
+                    LLPC_ASSERT(pCompTy->isIntegerTy());
+                    Type* pInt16Ty = (compCount > 1) ? VectorType::get(m_pContext->Int16Ty(), compCount) :
+                                                       m_pContext->Int16Ty();
                     if (signedness)
                     {
-                        // %comp = sext i8 %comp to i16
-                        comps[i] = new SExtInst(comps[i], m_pContext->Int16Ty(), "", pInsertPos);
+                        // %output = sext <n x i8> %output to <n x i16>
+                        pOutput16 = new SExtInst(pOutput16, pInt16Ty, "", pInsertPos);
                     }
                     else
                     {
-                        // %comp = zext i8 %comp to i16
-                        comps[i] = new ZExtInst(comps[i], m_pContext->Int16Ty(), "", pInsertPos);
+                        // %output = zext <n x i8> %output to <n x i16>
+                        pOutput16 = new ZExtInst(pOutput16, pInt16Ty, "", pInsertPos);
                     }
-
-                    // %comp = bitcast i16 %comp to half
-                    comps[i] = new BitCastInst(comps[i], m_pContext->Float16Ty(), "", pInsertPos);
                 }
 
-                for (uint32_t i = compCount; i < 4; ++i)
+                if (pOutput16->getType()->getScalarType()->isIntegerTy())
                 {
-                    comps[i] = pUndefFloat16;
+                    // %output = bitcast <n x i16> %output to <n x half>
+                    Type* pHalfTy = (compCount > 1) ? VectorType::get(pFloat16Ty, compCount) : pFloat16Ty;
+                    pOutput16 = new BitCastInst(pOutput16, pHalfTy, "", pInsertPos);
                 }
-            }
-            else if (bitWidth == 16)
-            {
-                needPack = true;
 
-                if (pCompTy->isIntegerTy())
+                const auto pUndefIdx = UndefValue::get(m_pContext->Int32Ty());
+                for (uint32_t i = 0; i < 2; ++i)
                 {
-                    // Cast i16 to float16
-                    for (uint32_t i = 0; i < compCount; ++i)
+                    if ((liveMask & (0x3 << (2 * i))) == 0)
                     {
-                        // %comp = bitcast i16 %comp to half
-                        comps[i] = new BitCastInst(comps[i], m_pContext->Float16Ty(), "", pInsertPos);
+                        comps[i] = pUndefFloat16x2;
+                    }
+                    else if (compCount == 1)
+                    {
+                        // %comp = insertelement <2 x half> undef, half %output, i32 0
+                        comps[i] = InsertElementInst::Create(pUndefFloat16x2,
+                                                             pOutput16,
+                                                             ConstantInt::get(m_pContext->Int32Ty(), 0),
+                                                             "",
+                                                             pInsertPos);
+                    }
+                    else
+                    {
+                        // %comp = shufflevector <n x half> %output, <n x half> undef, <2 x i32> <i, i + 1>
+                        Constant* shuffleMask[2] = {};
+                        for (uint32_t j = 0; j < 2; ++j)
+                        {
+                            const uint32_t compIdx = 2 * i + j;
+                            shuffleMask[j] = ((liveMask & (1 << compIdx)) != 0) ?
+                                                 ConstantInt::get(m_pContext->Int32Ty(), compIdx) :
+                                                 pUndefIdx;
+                        }
+
+                        comps[i] = new ShuffleVectorInst(pOutput16,
+                                                         UndefValue::get(pOutput16->getType()),
+                                                         ConstantVector::get(shuffleMask),
+                                                         "",
+                                                         pInsertPos);
                     }
-                }
-
-                for (uint32_t i = compCount; i < 4; ++i)
-                {
-                    comps[i] = pUndefFloat16;
                 }
             }
             else
             {
-                if (pCompTy->isIntegerTy())
+                for (uint32_t i = 0; i < 4; ++i)
                 {
-                    // Cast i32 to float
-                    for (uint32_t i = 0; i < compCount; ++i)
+                    if ((liveMask & (1 << i)) == 0)
+                    {
+                        comps[i] = pUndefFloat;
+                    }
+                    else if (pCompTy->isIntegerTy())
                     {
                         // %comp = bitcast i32 %comp to float
                         comps[i] = new BitCastInst(comps[i], m_pContext->FloatTy(), "", pInsertPos);
                     }
                 }
 
-                for (uint32_t i = compCount; i < 4; ++i)
-                {
-                    comps[i] = pUndefFloat;
-                }
-
                 Attribute::AttrKind attribs[] = {
                     Attribute::ReadNone
                 };
 
                 // Do packing
-                comps[0] = EmitCall("llvm.amdgcn.cvt.pkrtz",
-                                    m_pContext->Float16x2Ty(),
-                                    { comps[0], comps[1] },
-                                    attribs,
-                                    pInsertPos);
-
-                if (compCount > 2)
-                {
-                    comps[1] = EmitCall("llvm.amdgcn.cvt.pkrtz",
-                                        m_pContext->Float16x2Ty(),
-                                        { comps[2], comps[3] },
-                                        attribs,
-                                        pInsertPos);
-                }
-                else
+                for (uint32_t i = 0; i < 2; ++i)
                 {
-                    comps[1] = pUndefFloat16x2;
+                    comps[i] = ((liveMask & (0x3 << (2 * i))) != 0) ?
+                                   EmitCall("llvm.amdgcn.cvt.pkrtz",
+                                            m_pContext->Float16x2Ty(),
+                                            { comps[2 * i], comps[2 * i + 1] },
+                                            attribs,
+                                            pInsertPos) :
+                                   pUndefFloat16x2;
                 }
             }
 
@@ -1407,103 +1417,61 @@ Value* FragColorExport::Run(
         }
     case EXP_FORMAT_UNORM16_ABGR:
     case EXP_FORMAT_SNORM16_ABGR:
-        {
-            comprExp = true;
-            needPack = true;
-
-            for (uint32_t i = 0; i < compCount; ++i)
-            {
-                // Convert the components to float value if necessary
-                comps[i] = ConvertToFloat(comps[i], signedness, pInsertPos);
-            }
-
-            LLPC_ASSERT(compCount <= 4);
-            // Make even number of components;
-            if ((compCount % 2) != 0)
-            {
-                comps[compCount] = ConstantFP::get(m_pContext->FloatTy(), 0.0);
-                compCount++;
-            }
-
-            StringRef funcName = (expFmt == EXP_FORMAT_SNORM16_ABGR) ?
-                ("llvm.amdgcn.cvt.pknorm.i16") : ("llvm.amdgcn.cvt.pknorm.u16");
-
-            for (uint32_t i = 0; i < compCount; i += 2)
-            {
-                Value* pComps = EmitCall(funcName,
-                                         m_pContext->Int16x2Ty(),
-                                         { comps[i], comps[i + 1] },
-                                         NoAttrib,
-                                         pInsertPos);
-
-                pComps = new BitCastInst(pComps, m_pContext->Float16x2Ty(), "", pInsertPos);
-
-                comps[i] = ExtractElementInst::Create(pComps,
-                                                        ConstantInt::get(m_pContext->Int32Ty(), 0),
-                                                        "",
-                                                        pInsertPos);
-
-                comps[i + 1] = ExtractElementInst::Create(pComps,
-                                                            ConstantInt::get(m_pContext->Int32Ty(), 1),
-                                                            "",
-                                                            pInsertPos);
-
-            }
-
-            for (uint32_t i = compCount; i < 4; ++i)
-            {
-                comps[i] = pUndefFloat16;
-            }
-
-            break;
-        }
     case EXP_FORMAT_UINT16_ABGR:
     case EXP_FORMAT_SINT16_ABGR:
         {
             comprExp = true;
-            needPack = true;
 
-            for (uint32_t i = 0; i < compCount; ++i)
+            const bool isNorm = ((expFmt == EXP_FORMAT_UNORM16_ABGR) || (expFmt == EXP_FORMAT_SNORM16_ABGR));
+            StringRef funcName;
+            switch (expFmt)
             {
-                // Convert the components to int value if necessary
-                comps[i] = ConvertToInt(comps[i], signedness, pInsertPos);
+            case EXP_FORMAT_UNORM16_ABGR:
+                funcName = "llvm.amdgcn.cvt.pknorm.u16";
+                break;
+            case EXP_FORMAT_SNORM16_ABGR:
+                funcName = "llvm.amdgcn.cvt.pknorm.i16";
+                break;
+            case EXP_FORMAT_UINT16_ABGR:
+                funcName = "llvm.amdgcn.cvt.pk.u16";
+                break;
+            default:
+                funcName = "llvm.amdgcn.cvt.pk.i16";
+                break;
             }
 
-            LLPC_ASSERT(compCount <= 4);
-            // Make even number of components;
-            if ((compCount % 2) != 0)
+            for (uint32_t i = 0; i < 4; ++i)
             {
-                comps[compCount] = ConstantInt::get(m_pContext->Int32Ty(), 0),
-                compCount++;
+                if ((liveMask & (1 << i)) == 0)
+                {
+                    // Discarded components are packed as zero
+                    comps[i] = isNorm ? ConstantFP::get(m_pContext->FloatTy(), 0.0) :
+                                        ConstantInt::get(m_pContext->Int32Ty(), 0);
+                }
+                else
+                {
+                    // Convert the components to float or int value if necessary
+                    comps[i] = isNorm ? ConvertToFloat(comps[i], signedness, pInsertPos) :
+                                        ConvertToInt(comps[i], signedness, pInsertPos);
+                }
             }
 
-            StringRef funcName = (expFmt == EXP_FORMAT_SINT16_ABGR) ?
-                ("llvm.amdgcn.cvt.pk.i16") : ("llvm.amdgcn.cvt.pk.u16");
-
-            for (uint32_t i = 0; i < compCount; i += 2)
+            // The packed result is exported as it is, without splitting it into float16 components
+            for (uint32_t i = 0; i < 2; ++i)
             {
+                if ((liveMask & (0x3 << (2 * i))) == 0)
+                {
+                    comps[i] = pUndefFloat16x2;
+                    continue;
+                }
+
                 Value* pComps = EmitCall(funcName,
                                          m_pContext->Int16x2Ty(),
-                                         { comps[i], comps[i + 1] },
+                                         { comps[2 * i], comps[2 * i + 1] },
                                          NoAttrib,
                                          pInsertPos);
 
-                pComps = new BitCastInst(pComps, m_pContext->Float16x2Ty(), "", pInsertPos);
-
-                comps[i] = ExtractElementInst::Create(pComps,
-                                                        ConstantInt::get(m_pContext->Int32Ty(), 0),
-                                                        "",
-                                                        pInsertPos);
-
-                comps[i + 1] = ExtractElementInst::Create(pComps,
-                                                            ConstantInt::get(m_pContext->Int32Ty(), 1),
-                                                            "",
-                                                            pInsertPos);
-            }
-
-            for (uint32_t i = compCount; i < 4; ++i)
-            {
-                comps[i] = pUndefFloat16;
+                comps[i] = new BitCastInst(pComps, m_pContext->Float16x2Ty(), "", pInsertPos);
             }
 
             break;
@@ -1517,56 +1485,14 @@ Value* FragColorExport::Run(
 
     Value* pExport = nullptr;
 
-    if (expFmt == EXP_FORMAT_ZERO)
+    if (comprExp)
     {
-        // Do nothing
-    }
-    else if (comprExp)
-    {
-        // 16-bit export (compressed)
-        if (needPack)
-        {
-            // Do packing
-
-            // %comp[0] = insertelement <2 x half> undef, half %comp[0], i32 0
-            comps[0] = InsertElementInst::Create(pUndefFloat16x2,
-                                                 comps[0],
-                                                 ConstantInt::get(m_pContext->Int32Ty(), 0),
-                                                 "",
-                                                 pInsertPos);
-
-            // %comp[0] = insertelement <2 x half> %comp[0], half %comp[1], i32 1
-            comps[0] = InsertElementInst::Create(comps[0],
-                                                 comps[1],
-                                                 ConstantInt::get(m_pContext->Int32Ty(), 1),
-                                                 "",
-                                                 pInsertPos);
-
-            if (compCount > 2)
-            {
-                // %comp[1] = insertelement <2 x half> undef, half %comp[2], i32 0
-                comps[1] = InsertElementInst::Create(pUndefFloat16x2,
-                                                     comps[2],
-                                                     ConstantInt::get(m_pContext->Int32Ty(), 0),
-                                                     "",
-                                                     pInsertPos);
-
-                // %comp[1] = insertelement <2 x half> %comp[1], half %comp[3], i32 1
-                comps[1] = InsertElementInst::Create(comps[1],
-                                                     comps[3],
-                                                     ConstantInt::get(m_pContext->Int32Ty(), 1),
-                                                     "",
-                                                     pInsertPos);
-            }
-            else
-            {
-                comps[1] = pUndefFloat16x2;
-            }
-        }
+        // 16-bit export (compressed), each enabled half of the mask covers one <2 x half> source
+        expMask = (((liveMask & 0x3) != 0) ? 0x3 : 0) | (((liveMask & 0xC) != 0) ? 0xC : 0);
 
         Value* args[] = {
             ConstantInt::get(m_pContext->Int32Ty(), EXP_TARGET_MRT_0 + location), // tgt
-            ConstantInt::get(m_pContext->Int32Ty(), (compCount > 2) ? 0xF : 0x3), // en
+            ConstantInt::get(m_pContext->Int32Ty(), expMask),                     // en
             comps[0],                                                             // src0
             comps[1],                                                             // src1
             ConstantInt::get(m_pContext->BoolTy(), false),                        // done
@@ -1580,7 +1506,7 @@ Value* FragColorExport::Run(
         // 32-bit export
         Value* args[] = {
             ConstantInt::get(m_pContext->Int32Ty(), EXP_TARGET_MRT_0 + location), // tgt
-            ConstantInt::get(m_pContext->Int32Ty(), (1 << compCount) - 1),        // en
+            ConstantInt::get(m_pContext->Int32Ty(), expMask),                     // en
             comps[0],                                                             // src0
             comps[1],                                                             // src1
             comps[2],                                                             // src2
@@ -1615,6 +1541,31 @@ ExportFormat FragColorExport::ComputeExportFormat(
                                                   outputMask, enableAlphaToCoverage);
 }
 
+// =====================================================================================================================
+// Gets the mask of fragment output components that are consumed by the specified color target. Components outside
+// the mask are discarded by the color buffer, so they need not be converted or exported.
+uint32_t FragColorExport::ComputeLiveComponentMask(
+    uint32_t location   // Location of color target
+    ) const
+{
+    const auto pCbState = &pPipelineInfo->cbState;
+    const auto pTarget = &pCbState->target[location];
+
+    uint32_t liveMask = GetColorFormatInfo(pTarget->format)->channelMask;
+
+    // NOTE: Alpha is still needed if the format lacks it but it is blended to color channels, feeds alpha-to-coverage
+    // (color target 0 only) or might be used as a second source blend factor.
+    if (HasAlpha(pTarget->format) ||
+        pTarget->blendSrcAlphaToColor ||
+        (pCbState->alphaToCoverageEnable && (location == 0)) ||
+        pCbState->dualSourceBlendEnable)
+    {
+        liveMask |= ChannelMask::W;
+    }
+
+    return liveMask;
+}
+
 // =====================================================================================================================
 // Get an export format from vk format
 ExportFormat FragColorExport::ConvertColorBufferFormatToExportFormat(
@@ -116,6 +116,7 @@ private:
     LLPC_DISALLOW_COPY_AND_ASSIGN(FragColorExport);
 
     ExportFormat ComputeExportFormat(llvm::Type* pOutputTy, uint32_t location) const;
+    uint32_t ComputeLiveComponentMask(uint32_t location) const;
     static CompSetting ComputeCompSetting(VkFormat format);
     static ColorSwap ComputeColorSwap(VkFormat format);
 
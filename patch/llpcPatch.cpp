@@ -79,6 +79,11 @@ opt<bool> UseLlvmOpt("use-llvm-opt",
                      desc("Use LLVM's standard optimization set instead of the curated optimization set"),
                      init(false));
 
+// -disable-waterfall-merge: disable merging of adjacent waterfall loops keyed on the same non-uniform index
+opt<bool> DisableWaterfallMerge("disable-waterfall-merge",
+                                desc("Disable merging of adjacent waterfall loops on the same non-uniform index"),
+                                init(false));
+
 } // cl
 
 } // llvm
@@ -177,6 +182,12 @@ void Patch::AddPasses(
         passMgr.add(CreateStartStopTimer(pPatchTimer, true));
     }
 
+    // Merge adjacent waterfall loops on the same non-uniform index (after optimizations have CSEd the indices)
+    if (cl::DisableWaterfallMerge == false)
+    {
+        passMgr.add(CreatePatchWaterfallMerge());
+    }
+
     // Patch buffer operations (must be after optimizations)
     passMgr.add(CreatePatchBufferOp());
     passMgr.add(createInstructionCombiningPass(false));
@@ -63,7 +63,9 @@ void initializePatchPeepholeOptPass(PassRegistry&);
 void initializePatchPreparePipelineAbiPass(PassRegistry&);
 void initializePatchPushConstOpPass(PassRegistry&);
 void initializePatchResourceCollectPass(PassRegistry&);
+void initializePatchScalarLoadCombinePass(PassRegistry&);
 void initializePatchSetupTargetFeaturesPass(PassRegistry&);
+void initializePatchWaterfallMergePass(PassRegistry&);
 
 } // llvm
 
@@ -90,7 +92,9 @@ inline static void InitializePatchPasses(
   initializePatchPreparePipelineAbiPass(passRegistry);
   initializePatchPushConstOpPass(passRegistry);
   initializePatchResourceCollectPass(passRegistry);
+  initializePatchScalarLoadCombinePass(passRegistry);
   initializePatchSetupTargetFeaturesPass(passRegistry);
+  initializePatchWaterfallMergePass(passRegistry);
 }
 
 llvm::FunctionPass* CreatePatchBufferOp();
@@ -106,7 +110,9 @@ llvm::FunctionPass* CreatePatchPeepholeOpt(bool enableDiscardOpt = false);
 llvm::ModulePass* CreatePatchPreparePipelineAbi(bool onlySetCallingConvs);
 llvm::ModulePass* CreatePatchPushConstOp();
 llvm::ModulePass* CreatePatchResourceCollect();
+llvm::FunctionPass* CreatePatchScalarLoadCombine();
 llvm::ModulePass* CreatePatchSetupTargetFeatures();
+llvm::FunctionPass* CreatePatchWaterfallMerge();
 
 class Context;
 class PipelineState;
@@ -31,12 +31,16 @@
 #define DEBUG_TYPE "llpc-patch-buffer-op"
 
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/LegacyDivergenceAnalysis.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/IntrinsicsAMDGPU.h"
 #include "llvm/InitializePasses.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/KnownBits.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 
@@ -52,6 +56,15 @@
 using namespace llvm;
 using namespace Llpc;
 
+// -disable-buffer-bound-check-elim: disable elimination of redundant robust buffer access bound checks
+static cl::opt<bool> DisableBoundCheckElim("disable-buffer-bound-check-elim",
+                                           cl::desc("Disable elimination of redundant robust buffer access bound "
+                                                    "checks"),
+                                           cl::init(false));
+
+STATISTIC(NumBoundChecksRemoved, "Number of robust buffer access bound checks proven redundant");
+STATISTIC(NumBoundChecksMerged, "Number of robust buffer access bound checks merged with an earlier check");
+
 namespace Llpc
 {
 
@@ -114,12 +127,16 @@ bool PatchBufferOp::runOnFunction(
     ReversePostOrderTraversal<Function*> traversal(&function);
     for (BasicBlock* const pBlock : traversal)
     {
+        // Bound checks are only shared within a block, where an earlier check always dominates a later access.
+        m_boundCheckMap.clear();
         visit(*pBlock);
     }
 
     // Some instructions can modify the CFG and thus have to be performed after the normal visitors.
     for (Instruction* const pInst : m_postVisitInsts)
     {
+        m_boundCheckMap.clear();
+
         if (MemSetInst* const pMemSet = dyn_cast<MemSetInst>(pInst))
         {
             PostVisitMemSetInst(*pMemSet);
@@ -130,6 +147,7 @@ bool PatchBufferOp::runOnFunction(
         }
     }
     m_postVisitInsts.clear();
+    m_boundCheckMap.clear();
 
     const bool changed = (m_replacementMap.empty() == false);
 
@@ -185,10 +203,8 @@ void PatchBufferOp::visitAtomicCmpXchgInst(
     {
         Value* const pBaseAddr = GetBaseAddressFromBufferDesc(pBufferDesc);
 
-        // The 2nd element in the buffer descriptor is the byte bound, we do this to support robust buffer access.
-        Value* const pBound = m_pBuilder->CreateExtractElement(pBufferDesc, 2);
-        Value* const pInBound = m_pBuilder->CreateICmpULT(pBaseIndex, pBound);
-        Value* const pNewBaseIndex = m_pBuilder->CreateSelect(pInBound, pBaseIndex, m_pBuilder->getInt32(0));
+        // Clamp the index to the buffer's byte bound to support robust buffer access.
+        Value* const pNewBaseIndex = CreateBoundCheckedIndex(pBufferDesc, pBaseIndex);
 
         // Add on the index to the address.
         Value* pAtomicPointer = m_pBuilder->CreateGEP(pBaseAddr, pNewBaseIndex);
@@ -313,10 +329,8 @@ void PatchBufferOp::visitAtomicRMWInst(
     {
         Value* const pBaseAddr = GetBaseAddressFromBufferDesc(pBufferDesc);
 
-        // The 2nd element in the buffer descriptor is the byte bound, we do this to support robust buffer access.
-        Value* const pBound = m_pBuilder->CreateExtractElement(pBufferDesc, 2);
-        Value* const pInBound = m_pBuilder->CreateICmpULT(pBaseIndex, pBound);
-        Value* const pNewBaseIndex = m_pBuilder->CreateSelect(pInBound, pBaseIndex, m_pBuilder->getInt32(0));
+        // Clamp the index to the buffer's byte bound to support robust buffer access.
+        Value* const pNewBaseIndex = CreateBoundCheckedIndex(pBufferDesc, pBaseIndex);
 
         // Add on the index to the address.
         Value* pAtomicPointer = m_pBuilder->CreateGEP(pBaseAddr, pNewBaseIndex);
@@ -1434,6 +1448,62 @@ Value* PatchBufferOp::GetBaseAddressFromBufferDesc(
     return m_pBuilder->CreateIntToPtr(pBaseAddr, m_pBuilder->getInt8Ty()->getPointerTo(ADDR_SPACE_GLOBAL));
 }
 
+// =====================================================================================================================
+// Create the index used to access a buffer through a global pointer. To support robust buffer access, an index that is
+// not below the byte bound in the buffer descriptor is replaced by 0. The check is omitted when known-bits analysis
+// proves the index can only be 0 (the replacement value anyway), and an identical check earlier in the same block is
+// reused.
+Value* PatchBufferOp::CreateBoundCheckedIndex(
+    Value* const pBufferDesc, // [in] The buffer descriptor
+    Value* const pBaseIndex)  // [in] The byte index into the buffer
+{
+    // The 2nd element in the buffer descriptor is the byte bound.
+    if (DisableBoundCheckElim)
+    {
+        Value* const pBound = m_pBuilder->CreateExtractElement(pBufferDesc, 2);
+        Value* const pInBound = m_pBuilder->CreateICmpULT(pBaseIndex, pBound);
+        return m_pBuilder->CreateSelect(pInBound, pBaseIndex, m_pBuilder->getInt32(0));
+    }
+
+    // Key the check on the offset rather than the ptrtoint of it, which is recreated for every access.
+    Value* pIndexKey = pBaseIndex;
+    if (PtrToIntInst* const pPtrToInt = dyn_cast<PtrToIntInst>(pBaseIndex))
+    {
+        pIndexKey = pPtrToInt->getPointerOperand();
+    }
+
+    const auto key = std::make_pair(pBufferDesc, pIndexKey);
+    auto it = m_boundCheckMap.find(key);
+    if ((it != m_boundCheckMap.end()) &&
+        (cast<Instruction>(it->second)->getParent() == m_pBuilder->GetInsertBlock()))
+    {
+        ++NumBoundChecksMerged;
+        return it->second;
+    }
+
+    const DataLayout& dataLayout = m_pBuilder->GetInsertBlock()->getModule()->getDataLayout();
+    const KnownBits indexKnown = computeKnownBits(pBaseIndex, dataLayout);
+
+    // An out-of-bound index is replaced by 0, so an index that can only be 0 needs no check.
+    if (indexKnown.getMaxValue().isNullValue())
+    {
+        ++NumBoundChecksRemoved;
+        return pBaseIndex;
+    }
+
+    Value* const pBound = m_pBuilder->CreateExtractElement(pBufferDesc, 2);
+    Value* const pInBound = m_pBuilder->CreateICmpULT(pBaseIndex, pBound);
+    Value* const pNewBaseIndex = m_pBuilder->CreateSelect(pInBound, pBaseIndex, m_pBuilder->getInt32(0));
+
+    // Only remember checks that are real instructions, so the dominance test above stays valid.
+    if (isa<Instruction>(pNewBaseIndex))
+    {
+        m_boundCheckMap[key] = pNewBaseIndex;
+    }
+
+    return pNewBaseIndex;
+}
+
 // =====================================================================================================================
 // Copy all metadata from one value to another.
 void PatchBufferOp::CopyMetadata(
@@ -1559,10 +1629,8 @@ Value* PatchBufferOp::ReplaceLoad(
     {
         Value* const pBaseAddr = GetBaseAddressFromBufferDesc(pBufferDesc);
 
-        // The 2nd element in the buffer descriptor is the byte bound, we do this to support robust buffer access.
-        Value* const pBound = m_pBuilder->CreateExtractElement(pBufferDesc, 2);
-        Value* const pInBound = m_pBuilder->CreateICmpULT(pBaseIndex, pBound);
-        Value* const pNewBaseIndex = m_pBuilder->CreateSelect(pInBound, pBaseIndex, m_pBuilder->getInt32(0));
+        // Clamp the index to the buffer's byte bound to support robust buffer access.
+        Value* const pNewBaseIndex = CreateBoundCheckedIndex(pBufferDesc, pBaseIndex);
 
         // Add on the index to the address.
         Value* pLoadPointer = m_pBuilder->CreateGEP(pBaseAddr, pNewBaseIndex);
@@ -1831,10 +1899,8 @@ void PatchBufferOp::ReplaceStore(
     {
         Value* const pBaseAddr = GetBaseAddressFromBufferDesc(pBufferDesc);
 
-        // The 2nd element in the buffer descriptor is the byte bound, we do this to support robust buffer access.
-        Value* const pBound = m_pBuilder->CreateExtractElement(pBufferDesc, 2);
-        Value* const pInBound = m_pBuilder->CreateICmpULT(pBaseIndex, pBound);
-        Value* const pNewBaseIndex = m_pBuilder->CreateSelect(pInBound, pBaseIndex, m_pBuilder->getInt32(0));
+        // Clamp the index to the buffer's byte bound to support robust buffer access.
+        Value* const pNewBaseIndex = CreateBoundCheckedIndex(pBufferDesc, pBaseIndex);
 
         // Add on the index to the address.
         Value* pStorePointer = m_pBuilder->CreateGEP(pBaseAddr, pNewBaseIndex);
@@ -79,6 +79,7 @@ private:
 
     llvm::Value* GetPointerOperandAsInst(llvm::Value* const pValue);
     llvm::Value* GetBaseAddressFromBufferDesc(llvm::Value* const pBufferDesc) const;
+    llvm::Value* CreateBoundCheckedIndex(llvm::Value* const pBufferDesc, llvm::Value* const pBaseIndex);
     void CopyMetadata(llvm::Value* const pDest, const llvm::Value* const pSrc) const;
     llvm::PointerType* GetRemappedType(llvm::Type* const pType) const;
     bool RemoveUsersForInvariantStarts(llvm::Value* const pValue);
@@ -100,6 +101,9 @@ private:
     llvm::DenseSet<llvm::Value*>                    m_divergenceSet;       // The divergence set.
     llvm::LegacyDivergenceAnalysis*                 m_pDivergenceAnalysis; // The divergence analysis.
     llvm::SmallVector<llvm::Instruction*, 16>       m_postVisitInsts;      // The post process instruction set.
+    llvm::DenseMap<std::pair<llvm::Value*, llvm::Value*>, llvm::Value*>
+                                                    m_boundCheckMap;       // Bound-checked indices in the current
+                                                                           // block, keyed by (descriptor, offset).
     std::unique_ptr<llvm::IRBuilder<>>              m_pBuilder;            // The IRBuilder.
     Context*                                        m_pContext;            // The LLPC Context.
     PipelineState*                                  m_pPipelineState;      // The pipeline state
@@ -30,6 +30,8 @@
  */
 #define DEBUG_TYPE "llpc-patch-descriptor-load"
 
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
@@ -43,6 +45,9 @@
 using namespace llvm;
 using namespace Llpc;
 
+STATISTIC(NumDescLoadsRemoved, "Number of redundant descriptor loads removed");
+STATISTIC(NumDescLoadsHoisted, "Number of constant-index descriptor loads hoisted to the entry block");
+
 namespace llvm
 {
 
@@ -100,7 +105,9 @@ bool PatchDescriptorLoad::runOnModule(
         if (m_pEntryPoint != nullptr)
         {
             m_shaderStage = static_cast<ShaderStage>(shaderStage);
+            m_domTree.recalculate(*m_pEntryPoint);
             visit(*m_pEntryPoint);
+            m_loadedDescs.clear();
         }
     }
 
@@ -160,20 +167,25 @@ void PatchDescriptorLoad::ProcessLoadDescFromPtr(
     m_pEntryPoint = pLoadFromPtr->getFunction();
     IRBuilder<> builder(*m_pContext);
     builder.SetInsertPoint(pLoadFromPtr);
-    Value* pIndex = builder.getInt32(0);
+    Value* pIndex = nullptr;
 
     auto pLoadPtr = cast<CallInst>(pLoadFromPtr->getOperand(0));
     while (pLoadPtr->getCalledFunction()->getName().startswith(LlpcName::DescriptorIndex))
     {
-        pIndex = builder.CreateAdd(pIndex, pLoadPtr->getOperand(1));
+        // Keep a single index as it is, so that loads with the same index can be recognized as redundant.
+        pIndex = (pIndex == nullptr) ? pLoadPtr->getOperand(1) : builder.CreateAdd(pIndex, pLoadPtr->getOperand(1));
         pLoadPtr = cast<CallInst>(pLoadPtr->getOperand(0));
     }
+    if (pIndex == nullptr)
+    {
+        pIndex = builder.getInt32(0);
+    }
 
     LLPC_ASSERT(pLoadPtr->getCalledFunction()->getName().startswith(LlpcName::DescriptorGetPtrPrefix));
 
     uint32_t descSet = cast<ConstantInt>(pLoadPtr->getOperand(0))->getZExtValue();
     uint32_t binding = cast<ConstantInt>(pLoadPtr->getOperand(1))->getZExtValue();
-    Value* pDesc = LoadDescriptor(*pLoadPtr, descSet, binding, pIndex, pLoadFromPtr);
+    Value* pDesc = GetOrLoadDescriptor(*pLoadPtr, descSet, binding, pIndex, pLoadFromPtr);
 
     pLoadFromPtr->replaceAllUsesWith(pDesc);
 
@@ -246,7 +258,7 @@ void PatchDescriptorLoad::visitCallInst(
             uint32_t descSet = cast<ConstantInt>(callInst.getOperand(0))->getZExtValue();
             uint32_t binding = cast<ConstantInt>(callInst.getOperand(1))->getZExtValue();
             Value* pArrayOffset = callInst.getOperand(2); // Offset for arrayed resource (index)
-            pDesc = LoadDescriptor(callInst, descSet, binding, pArrayOffset, &callInst);
+            pDesc = GetOrLoadDescriptor(callInst, descSet, binding, pArrayOffset, &callInst);
         }
 
         // Replace the call with the loaded descriptor.
@@ -257,6 +269,45 @@ void PatchDescriptorLoad::visitCallInst(
     m_descLoadFuncs.insert(pCallee);
 }
 
+// =====================================================================================================================
+// Get the descriptor for the specified descriptor load, reusing an identical load (same kind, set, binding and
+// index) that dominates the insert point if there is one. Loads with a constant index are placed in the entry block,
+// so that they are shared by the whole shader and never end up inside a loop.
+//
+// NOTE: Loads with a dynamic index are not hoisted, as that would speculate a load whose index might be out of range
+// on a path that does not execute it.
+Value* PatchDescriptorLoad::GetOrLoadDescriptor(
+    CallInst&     callInst,       // [in] The llpc.descriptor.load.* or llpc.descriptor.point.* call being replaced
+    uint32_t      descSet,        // Descriptor set
+    uint32_t      binding,        // Binding
+    Value*        pArrayOffset,   // [in] Index in descriptor array
+    Instruction*  pInsertPoint)   // [in] Insert point
+{
+    DescriptorLoadKey key(callInst.getCalledFunction(), descSet, binding, pArrayOffset);
+    auto& loadedDescs = m_loadedDescs[key];
+
+    for (Value* pLoadedDesc : loadedDescs)
+    {
+        auto pLoadedInst = dyn_cast<Instruction>(pLoadedDesc);
+        if ((pLoadedInst == nullptr) || m_domTree.dominates(pLoadedInst, pInsertPoint))
+        {
+            ++NumDescLoadsRemoved;
+            return pLoadedDesc;
+        }
+    }
+
+    if (isa<Constant>(pArrayOffset) && (pInsertPoint->getParent() != &m_pEntryPoint->getEntryBlock()))
+    {
+        // Insert at the end of the entry block, after any system values that the load might need.
+        pInsertPoint = m_pEntryPoint->getEntryBlock().getTerminator();
+        ++NumDescLoadsHoisted;
+    }
+
+    Value* pDesc = LoadDescriptor(callInst, descSet, binding, pArrayOffset, pInsertPoint);
+    loadedDescs.push_back(pDesc);
+    return pDesc;
+}
+
 // =====================================================================================================================
 // Generate the code for the descriptor load
 Value* PatchDescriptorLoad::LoadDescriptor(
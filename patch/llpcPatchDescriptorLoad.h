@@ -30,8 +30,11 @@
  */
 #pragma once
 
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/InstVisitor.h"
 
+#include <map>
+#include <tuple>
 #include <unordered_set>
 #include "llpcPatch.h"
 #include "llpcPipelineShaders.h"
@@ -69,6 +72,12 @@ private:
 
     void ProcessLoadDescFromPtr(llvm::CallInst* pLoadFromPtr);
 
+    llvm::Value* GetOrLoadDescriptor(llvm::CallInst&     callInst,
+                                     uint32_t            descSet,
+                                     uint32_t            binding,
+                                     llvm::Value*        pArrayOffset,
+                                     llvm::Instruction*  pInsertPoint);
+
     llvm::Value* LoadDescriptor(llvm::CallInst&     callInst,
                                 uint32_t            descSet,
                                 uint32_t            binding,
@@ -107,6 +116,13 @@ private:
     // Map from descriptor range value to global variables modeling related descriptors (act as immediate constants)
     std::unordered_map<const DescriptorRangeValue*, llvm::GlobalVariable*> m_descs;
 
+    // Key of a descriptor load: descriptor kind (the llpc.descriptor.* function), set, binding and array index
+    typedef std::tuple<llvm::Function*, uint32_t, uint32_t, llvm::Value*> DescriptorLoadKey;
+
+    // Descriptors already loaded in the current entry-point, for redundancy elimination
+    std::map<DescriptorLoadKey, llvm::SmallVector<llvm::Value*, 2>> m_loadedDescs;
+    llvm::DominatorTree             m_domTree;                // Dominator tree of the current entry-point
+
     PipelineState*                  m_pPipelineState = nullptr;
                                                               // Pipeline state from PipelineStateWrapper pass
 };
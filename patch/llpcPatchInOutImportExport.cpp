@@ -32,6 +32,7 @@
 
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/IntrinsicsAMDGPU.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -49,9 +50,49 @@
 using namespace llvm;
 using namespace Llpc;
 
+namespace llvm
+{
+
+namespace cl
+{
+
+// -tess-patch-count-cost-model: choose tessellation patch count per thread group by a throughput cost model
+opt<bool> TessPatchCountCostModel("tess-patch-count-cost-model",
+                                  desc("Choose tessellation patch count per thread group by a throughput cost model"),
+                                  init(false));
+
+// -tess-patch-count-tuning: override the cost weights of tessellation patch count cost model
+list<uint32_t> TessPatchCountTuning("tess-patch-count-tuning",
+                                    desc("Override cost weights of tessellation patch count cost model: "
+                                         "<groupLaunchCost>,<tessFactorWriteCost>"),
+                                    CommaSeparated);
+
+} // cl
+
+} // llvm
+
 namespace Llpc
 {
 
+// Cost weights of the cost model that chooses tessellation patch count per thread group. Hardware limits, such as the
+// number of waves resident on a CU, come from TargetInfo instead.
+struct TessPatchCountTuningEntry
+{
+    uint32_t groupLaunchCost;       // Cost of launching one thread group (in lane-slots)
+    uint32_t tessFactorWriteCost;   // Cost of writing one DWORD of tessellation factors (in lane-slots)
+};
+
+// Default tuning table of tessellation patch count cost model, indexed by GFX IP major version
+static const TessPatchCountTuningEntry TessPatchCountTuningTable[] =
+{
+    // groupLaunchCost, tessFactorWriteCost
+    { 128, 4 },   // GFX6
+    { 128, 4 },   // GFX7
+    { 128, 4 },   // GFX8
+    {  96, 2 },   // GFX9
+    {  96, 2 },   // GFX10
+};
+
 // =====================================================================================================================
 // Initializes static members.
 char PatchInOutImportExport::ID = 0;
@@ -6327,11 +6368,14 @@ uint32_t PatchInOutImportExport::CalcPatchCountPerThreadGroup(
 
     uint32_t patchCountPerThreadGroup = std::min(patchCountLimitedByThread, patchCountLimitedByLds);
 
-    // NOTE: Performance analysis shows that 16 patches per thread group is an optimal upper-bound. The value is only
-    // an experimental number. For GFX9. 64 is an optimal number instead.
-    const uint32_t optimalPatchCountPerThreadGroup = (m_gfxIp.major >= 9) ? 64 : 16;
+    if (cl::TessPatchCountCostModel == false)
+    {
+        // NOTE: Performance analysis shows that 16 patches per thread group is an optimal upper-bound. The value is
+        // only an experimental number. For GFX9. 64 is an optimal number instead.
+        const uint32_t optimalPatchCountPerThreadGroup = (m_gfxIp.major >= 9) ? 64 : 16;
 
-    patchCountPerThreadGroup = std::min(patchCountPerThreadGroup, optimalPatchCountPerThreadGroup);
+        patchCountPerThreadGroup = std::min(patchCountPerThreadGroup, optimalPatchCountPerThreadGroup);
+    }
 
     if (m_pPipelineState->IsTessOffChip())
     {
@@ -6391,9 +6435,107 @@ uint32_t PatchInOutImportExport::CalcPatchCountPerThreadGroup(
         patchCountPerThreadGroup = std::min(patchCountPerThreadGroup, maxPatchCount);
     }
 
+    if (cl::TessPatchCountCostModel)
+    {
+        // All hardware limits are applied, let the cost model pick the patch count within them
+        uint32_t totalLdsSizePerPatch = inPatchSize;
+        if (m_pPipelineState->IsTessOffChip() == false)
+        {
+            totalLdsSizePerPatch += outPatchSize + patchConstSize;
+        }
+
+        patchCountPerThreadGroup = SelectPatchCountPerThreadGroup(patchCountPerThreadGroup,
+                                                                  maxThreadCountPerPatch,
+                                                                  totalLdsSizePerPatch,
+                                                                  tessFactorStride);
+    }
+
     return patchCountPerThreadGroup;
 }
 
+// =====================================================================================================================
+// Selects the patch count per thread group that maximizes the estimated HS throughput. The estimate weighs lane
+// utilization of the waves of a thread group, the number of thread groups that can be resident on a CU (limited by
+// waves and LDS), the cost of launching a thread group and the cost of writing tessellation factors.
+uint32_t PatchInOutImportExport::SelectPatchCountPerThreadGroup(
+    uint32_t maxPatchCount,           // Maximum patch count allowed by hardware limits
+    uint32_t threadCountPerPatch,     // Count of HS threads per patch
+    uint32_t ldsSizePerPatch,         // LDS size required by one patch (in DWORDs)
+    uint32_t tessFactorStride         // Stride of tessellation factors (in DWORDs)
+    ) const
+{
+    const uint32_t tuningIndex = std::min(m_gfxIp.major - 6,
+                                          static_cast<uint32_t>((sizeof(TessPatchCountTuningTable) /
+                                                                 sizeof(TessPatchCountTuningTable[0])) - 1));
+    TessPatchCountTuningEntry tuning = TessPatchCountTuningTable[tuningIndex];
+
+    // Apply the tuning override from command line, fields are in the order of the tuning table
+    for (uint32_t i = 0; i < cl::TessPatchCountTuning.size(); ++i)
+    {
+        switch (i)
+        {
+        case 0:
+            tuning.groupLaunchCost = cl::TessPatchCountTuning[i];
+            break;
+        case 1:
+            tuning.tessFactorWriteCost = cl::TessPatchCountTuning[i];
+            break;
+        default:
+            break;
+        }
+    }
+
+    const auto& gpuProperty = m_pPipelineState->GetTargetInfo().GetGpuProperty();
+    const uint32_t waveSize = m_pPipelineState->GetShaderWaveSize(m_shaderStage);
+    const uint32_t ldsSizePerThreadGroup = gpuProperty.ldsSizePerThreadGroup;
+    const uint32_t ldsSizePerCu = gpuProperty.ldsSizePerCu / 4; // In DWORDs
+    const uint32_t maxWavesPerCu = gpuProperty.maxWavesPerSimd * gpuProperty.numSimdsPerCu;
+
+    uint32_t bestPatchCount = 1;
+    uint64_t bestThroughput = 0;
+
+    for (uint32_t patchCount = 1; patchCount <= maxPatchCount; ++patchCount)
+    {
+        const uint32_t ldsSize = patchCount * ldsSizePerPatch;
+        if (ldsSize > ldsSizePerThreadGroup)
+        {
+            break;
+        }
+
+        const uint32_t threadCount = patchCount * threadCountPerPatch;
+        const uint32_t waveCount = (threadCount + waveSize - 1) / waveSize;
+
+        // Number of thread groups that can be resident on a CU
+        uint32_t groupCountPerCu = maxWavesPerCu / waveCount;
+        if (ldsSize > 0)
+        {
+            groupCountPerCu = std::min(groupCountPerCu, ldsSizePerCu / ldsSize);
+        }
+
+        if (groupCountPerCu == 0)
+        {
+            // A thread group of this size does not fit on a CU. Wave count and LDS size only grow with patch count, so
+            // neither will any larger patch count.
+            break;
+        }
+
+        // Cost of a thread group (in lane-slots): all lanes of its waves, launch cost and tessellation factor writes
+        const uint64_t groupCost = static_cast<uint64_t>(waveCount) * waveSize +
+                                   tuning.groupLaunchCost +
+                                   static_cast<uint64_t>(patchCount) * tessFactorStride * tuning.tessFactorWriteCost;
+
+        // Relative throughput in patches per unit of time on a CU. Ties go to larger patch count.
+        const uint64_t throughput = (static_cast<uint64_t>(groupCountPerCu) * patchCount * 65536) / groupCost;
+        if (throughput >= bestThroughput)
+        {
+            bestThroughput = throughput;
+            bestPatchCount = patchCount;
+        }
+    }
+
+    return bestPatchCount;
+}
+
 // =====================================================================================================================
 // Inserts "exp" instruction to export generic output.
 void PatchInOutImportExport::AddExportInstForGenericOutput(
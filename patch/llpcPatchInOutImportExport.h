@@ -269,6 +269,10 @@ private:
                                           uint32_t outVertexStride,
                                           uint32_t patchConstCount,
                                           uint32_t tessFactorStride) const;
+    uint32_t SelectPatchCountPerThreadGroup(uint32_t maxPatchCount,
+                                            uint32_t threadCountPerPatch,
+                                            uint32_t ldsSizePerPatch,
+                                            uint32_t tessFactorStride) const;
 
     llvm::Value* CalcLdsOffsetForVsOutput(Type*              pOutputTy,
                                           uint32_t           location,
@@ -49,17 +49,16 @@
 #include "llpcTargetInfo.h"
 #include <algorithm>
 #include <functional>
+#include <set>
 
 using namespace llvm;
 using namespace Llpc;
 
-// -disable-gs-onchip: disable geometry shader on-chip mode
-cl::opt<bool> DisableGsOnChip("disable-gs-onchip",
-                              cl::desc("Disable geometry shader on-chip mode"),
-                              cl::init(false));
-
-// -pack-in-out: pack input/output
-static cl::opt<bool> PackInOut("pack-in-out", cl::desc("Pack input/output"), cl::init(false));
+// -disable-gs-on-chip-cost-model: size on-chip GS sub-groups by fixed heuristics rather than by a cost model
+static cl::opt<bool> DisableGsOnChipCostModel("disable-gs-on-chip-cost-model",
+                                              cl::desc("Size on-chip GS sub-groups by fixed heuristics, rather than "
+                                                       "by a cost model that estimates occupancy"),
+                                              cl::init(false));
 
 namespace Llpc
 {
@@ -82,7 +81,8 @@ PatchResourceCollect::PatchResourceCollect()
     m_hasPushConstOp(false),
     m_hasDynIndexedInput(false),
     m_hasDynIndexedOutput(false),
-    m_pResUsage(nullptr)
+    m_pResUsage(nullptr),
+    m_packInputStageMask(0)
 {
     initializePipelineShadersPass(*PassRegistry::getPassRegistry());
     initializePatchResourceCollectPass(*PassRegistry::getPassRegistry());
@@ -101,8 +101,9 @@ bool PatchResourceCollect::runOnModule(
     m_pPipelineShaders = &getAnalysis<PipelineShaders>();
     m_pPipelineState = getAnalysis<PipelineStateWrapper>().GetPipelineState(&module);
 
-    // If packing final vertex stage outputs and FS inputs, scalarize those outputs and inputs now.
-    if (CanPackInOut())
+    // Select the stage interfaces whose generic inputs/outputs are packed, and scalarize those inputs and outputs now.
+    SelectInOutPacking(&module);
+    if (m_packInputStageMask != 0)
     {
         ScalarizeForInOutPacking(&module);
     }
@@ -227,6 +228,19 @@ void PatchResourceCollect::SetNggControl()
     nggControl.primsPerSubgroup           = std::min(options.nggPrimsPerSubgroup, Gfx9::NggMaxThreadsPerSubgroup);
     nggControl.vertsPerSubgroup           = std::min(options.nggVertsPerSubgroup, Gfx9::NggMaxThreadsPerSubgroup);
 
+    if (nggControl.alwaysUsePrimShaderTable == false)
+    {
+        // NOTE: When culling-control registers are not fetched from primitive shader table, the rasterizer state is
+        // fixed at pipeline creation time and is constant-folded into the cullers. Drop the cullers that are known to
+        // be no-ops, which might further allow NGG to run in pass-through mode.
+        auto pPipelineInfo = static_cast<const GraphicsPipelineBuildInfo*>(m_pContext->GetPipelineBuildInfo());
+        if (pPipelineInfo->rsState.cullMode == VK_CULL_MODE_NONE)
+        {
+            // Neither front face nor back face is culled
+            nggControl.enableBackfaceCulling = false;
+        }
+    }
+
     if (nggControl.enableNgg)
     {
         if (options.nggFlags & NggFlagForceNonPassthrough)
@@ -446,8 +460,258 @@ void PatchResourceCollect::BuildNggCullingControlRegister(
 
     pipelineState.paClVteCntl = paClVteCntl.u32All;
 }
+
+// =====================================================================================================================
+// Adjusts NGG sub-group size for GS primitive amplification and GS instancing, and makes sure that there is at least one
+// primitive in a sub-group.
+void PatchResourceCollect::AdjustNggSubgroupSize(
+    uint32_t* pEsVertsPerSubgroup,  // [in/out] ES vertices per sub-group
+    uint32_t* pGsPrimsPerSubgroup)  // [in/out] GS primitives per sub-group
+{
+    const bool hasGs = ((m_pPipelineState->GetShaderStageMask() & ShaderStageToMask(ShaderStageGeometry)) != 0);
+    if (hasGs)
+    {
+        const auto& geometryMode = m_pPipelineState->GetShaderModes()->GetGeometryShaderMode();
+
+        // NOTE: If primitive amplification is active and the currently calculated gsPrimsPerSubgroup multipled by the
+        // amplification factor is larger than the supported number of primitives within a subgroup, we need to shrimp
+        // the number of gsPrimsPerSubgroup down to a reasonable level to prevent over-allocating LDS.
+        const uint32_t maxVertOut = geometryMode.outputVertices;
+
+        if ((*pGsPrimsPerSubgroup * maxVertOut) > Gfx9::NggMaxThreadsPerSubgroup)
+        {
+            *pGsPrimsPerSubgroup = Gfx9::NggMaxThreadsPerSubgroup / maxVertOut;
+        }
+
+        // Let's take into consideration instancing:
+        const uint32_t gsInstanceCount = geometryMode.invocations;
+        LLPC_ASSERT(gsInstanceCount >= 1);
+        *pGsPrimsPerSubgroup /= gsInstanceCount;
+        *pEsVertsPerSubgroup = *pGsPrimsPerSubgroup * maxVertOut;
+    }
+
+    // Make sure that we have at least one primitive
+    *pGsPrimsPerSubgroup = std::max(1u, *pGsPrimsPerSubgroup);
+}
+
+// =====================================================================================================================
+// Calculates LDS size (in DWORDs) required by an NGG sub-group of the specified size.
+uint32_t PatchResourceCollect::CalcNggLdsSize(
+    uint32_t  esVertsPerSubgroup,   // ES vertices per sub-group
+    uint32_t  gsPrimsPerSubgroup,   // GS primitives per sub-group
+    uint32_t  esGsRingItemSize,     // ES-GS ring item size (in DWORDs)
+    uint32_t  gsVsRingItemSize,     // GS-VS ring item size (in DWORDs)
+    uint32_t  esExtraLdsSize,       // Extra LDS size used by ES (in DWORDs)
+    uint32_t  gsExtraLdsSize,       // Extra LDS size used by GS (in DWORDs)
+    uint32_t* pEsLdsSize)           // [out] LDS size used by ES (in DWORDs)
+{
+    uint32_t       expectedEsLdsSize = esVertsPerSubgroup * esGsRingItemSize + esExtraLdsSize;
+    const uint32_t expectedGsLdsSize = gsPrimsPerSubgroup * gsVsRingItemSize + gsExtraLdsSize;
+
+    if (expectedGsLdsSize == 0)
+    {
+        LLPC_ASSERT((m_pPipelineState->GetShaderStageMask() & ShaderStageToMask(ShaderStageGeometry)) == 0);
+
+        expectedEsLdsSize = (Gfx9::NggMaxThreadsPerSubgroup * esGsRingItemSize) + esExtraLdsSize;
+    }
+
+    *pEsLdsSize = expectedEsLdsSize;
+
+    const uint32_t ldsSizeDwordGranularityShift =
+        m_pPipelineState->GetTargetInfo().GetGpuProperty().ldsSizeDwordGranularityShift;
+    return Pow2Align(expectedEsLdsSize + expectedGsLdsSize, static_cast<uint32_t>(1 << ldsSizeDwordGranularityShift));
+}
+
+// =====================================================================================================================
+// Selects NGG sub-group size by a cost model that estimates the occupancy (waves per CU) from LDS usage and register
+// pressure of the primitive shader. Returns the estimated waves per CU of the selected sub-group size.
+//
+// NOTE: The returned sub-group size is not yet adjusted for GS primitive amplification and GS instancing, the caller is
+// expected to run AdjustNggSubgroupSize() on it.
+uint32_t PatchResourceCollect::SelectNggSubgroupSize(
+    uint32_t  esGsRingItemSize,     // ES-GS ring item size (in DWORDs)
+    uint32_t  gsVsRingItemSize,     // GS-VS ring item size (in DWORDs)
+    uint32_t  esExtraLdsSize,       // Extra LDS size used by ES (in DWORDs)
+    uint32_t  gsExtraLdsSize,       // Extra LDS size used by GS (in DWORDs)
+    bool      needsLds,             // Whether the primitive shader uses LDS
+    uint32_t* pEsVertsPerSubgroup,  // [out] ES vertices per sub-group
+    uint32_t* pGsPrimsPerSubgroup)  // [out] GS primitives per sub-group
+{
+    static const uint32_t MaxLdsSizePerSubgroup = 16384; // In DWORDs
+
+    const auto& gpuProperty = m_pPipelineState->GetTargetInfo().GetGpuProperty();
+    const uint32_t waveSize = m_pPipelineState->GetShaderWaveSize(ShaderStageGeometry);
+    const uint32_t ldsSizePerCu = gpuProperty.ldsSizePerCu / 4; // In DWORDs
+
+    const uint32_t stageMask = m_pPipelineState->GetShaderStageMask();
+    const bool hasTs = ((stageMask & (ShaderStageToMask(ShaderStageTessControl) |
+                                      ShaderStageToMask(ShaderStageTessEval))) != 0);
+    const bool hasGs = ((stageMask & ShaderStageToMask(ShaderStageGeometry)) != 0);
+
+    // Estimate VGPR usage of the primitive shader. The actual count is unknown until code generation, so it is
+    // approximated by a fixed cost of system values and culling plus the vertex data that ES (and GS) keep alive.
+    // This is further capped by the VGPR limit of the shader stage.
+    const ShaderStage esStage = hasTs ? ShaderStageTessEval : ShaderStageVertex;
+    uint32_t vgprCount = 24 + 4 * m_pContext->GetShaderResourceUsage(esStage)->inOutUsage.outputMapLocCount;
+    if (hasGs)
+    {
+        vgprCount += 4 * m_pContext->GetShaderResourceUsage(ShaderStageGeometry)->inOutUsage.outputMapLocCount;
+    }
+
+    uint32_t vgprLimit = m_pPipelineState->GetShaderOptions(hasGs ? ShaderStageGeometry : esStage).vgprLimit;
+    vgprLimit = (vgprLimit == 0) ? gpuProperty.maxVgprsAvailable : std::min(vgprLimit, gpuProperty.maxVgprsAvailable);
+    vgprCount = std::min(vgprCount, vgprLimit);
+
+    // VGPR file size and allocation granularity are given in DWORDs, convert them to VGPRs per lane of this wave size
+    const uint32_t vgprGranularity = gpuProperty.vgprAllocGranularity / waveSize;
+    const uint32_t vgprFileSize = gpuProperty.vgprFileSizePerSimd / waveSize;
+    vgprCount = RoundUpToMultiple(vgprCount, vgprGranularity);
+
+    const uint32_t maxWavesPerCu = std::min(gpuProperty.maxWavesPerSimd, vgprFileSize / vgprCount) *
+                                   gpuProperty.numSimdsPerCu;
+
+    uint32_t bestEsVertsPerSubgroup = 0;
+    uint32_t bestGsPrimsPerSubgroup = 0;
+    uint32_t bestWavesPerCu = 0;
+    uint32_t bestThreadsPerCu = 0;
+
+    // Try sub-group sizes in multiples of wave size, and pick the one that keeps the most threads doing useful work
+    // on a CU. Ties go to larger sub-group, which has better vertex reuse and lower sub-group launch overhead.
+    for (uint32_t threadCount = waveSize; threadCount <= Gfx9::NggMaxThreadsPerSubgroup; threadCount += waveSize)
+    {
+        // Follow "Auto" sizing to leave room for ES vertices beyond ES_VERTS_PER_SUBGRP
+        uint32_t esVertsPerSubgroup = hasTs ? threadCount : threadCount - 2;
+        uint32_t gsPrimsPerSubgroup = threadCount;
+
+        uint32_t adjustedEsVertsPerSubgroup = esVertsPerSubgroup;
+        uint32_t adjustedGsPrimsPerSubgroup = gsPrimsPerSubgroup;
+        AdjustNggSubgroupSize(&adjustedEsVertsPerSubgroup, &adjustedGsPrimsPerSubgroup);
+
+        uint32_t esLdsSize = 0;
+        const uint32_t ldsSize = CalcNggLdsSize(adjustedEsVertsPerSubgroup,
+                                                adjustedGsPrimsPerSubgroup,
+                                                esGsRingItemSize,
+                                                gsVsRingItemSize,
+                                                esExtraLdsSize,
+                                                gsExtraLdsSize,
+                                                &esLdsSize);
+        if (needsLds && (ldsSize > MaxLdsSizePerSubgroup))
+        {
+            continue;
+        }
+
+        const uint32_t threadsPerSubgroup = std::max(adjustedEsVertsPerSubgroup, adjustedGsPrimsPerSubgroup);
+        const uint32_t wavesPerSubgroup = (threadsPerSubgroup + waveSize - 1) / waveSize;
+
+        uint32_t subgroupsPerCu = maxWavesPerCu / wavesPerSubgroup;
+        if (needsLds)
+        {
+            subgroupsPerCu = std::min(subgroupsPerCu, ldsSizePerCu / ldsSize);
+        }
+
+        const uint32_t threadsPerCu = subgroupsPerCu * threadsPerSubgroup;
+        if (threadsPerCu >= bestThreadsPerCu)
+        {
+            bestEsVertsPerSubgroup = esVertsPerSubgroup;
+            bestGsPrimsPerSubgroup = gsPrimsPerSubgroup;
+            bestWavesPerCu = subgroupsPerCu * wavesPerSubgroup;
+            bestThreadsPerCu = threadsPerCu;
+        }
+    }
+
+    if (bestThreadsPerCu == 0)
+    {
+        // Nothing fits, fall back to "Auto" sizing
+        bestEsVertsPerSubgroup = 126;
+        bestGsPrimsPerSubgroup = 128;
+    }
+
+    *pEsVertsPerSubgroup = bestEsVertsPerSubgroup;
+    *pGsPrimsPerSubgroup = bestGsPrimsPerSubgroup;
+
+    return bestWavesPerCu;
+}
 #endif
 
+// =====================================================================================================================
+// Selects on-chip GS sub-group size (GFX9+, non-NGG) by a cost model, when the GS-VS ring of the default sub-group
+// size doesn't fit in LDS. All GS primitive counts of the sub-group that keep both ES-GS and GS-VS rings in LDS are
+// tried, and the one with the most GS primitives in flight on a CU (bound by LDS usage and wave slots) is chosen. Ties
+// go to the larger sub-group, which duplicates fewer ES vertices and so has less ES-GS ring traffic per primitive.
+// Returns the estimated GS waves per CU, or 0 if no sub-group size fits.
+uint32_t PatchResourceCollect::SelectGsOnChipSubgroupSize(
+    uint32_t  esGsRingItemSize,         // ES-GS ring item size (in DWORDs)
+    uint32_t  gsVsItemSize,             // GS-VS LDS size of one GS primitive, all GS instances (in DWORDs)
+    uint32_t  gsInstanceCount,          // Number of GS instances
+    uint32_t  esMinVertsPerSubgroup,    // ES vertices needed by one GS primitive in the worst case
+    uint32_t  minGsPrimsPerSubgroup,    // Minimum GS primitives per sub-group to be worth keeping GS on-chip
+    uint32_t  maxGsPrimsPerSubgroup,    // Maximum GS primitives per sub-group supported by hardware
+    uint32_t  maxEsVertsPerSubgroup,    // Maximum ES vertices per sub-group supported by hardware
+    uint32_t  maxLdsSize,               // Maximum LDS size per sub-group (in DWORDs)
+    uint32_t* pGsPrimsPerSubgroup,      // [out] GS primitives per sub-group
+    uint32_t* pEsGsLdsSize,             // [out] ES-GS LDS size (in DWORDs)
+    uint32_t* pGsOnChipLdsSize)         // [out] Total LDS size of the sub-group (in DWORDs)
+{
+    const auto& gpuProperty = m_pPipelineState->GetTargetInfo().GetGpuProperty();
+    const uint32_t waveSize = m_pPipelineState->GetShaderWaveSize(ShaderStageGeometry);
+    const uint32_t ldsSizePerCu = gpuProperty.ldsSizePerCu / 4; // In DWORDs
+    const uint32_t ldsSizeDwordGranularity = 1u << gpuProperty.ldsSizeDwordGranularityShift;
+
+    const uint32_t maxWavesPerCu = gpuProperty.maxWavesPerSimd * gpuProperty.numSimdsPerCu;
+
+    uint32_t bestGsPrimsPerSubgroup = 0;
+    uint32_t bestEsGsLdsSize = 0;
+    uint32_t bestGsOnChipLdsSize = 0;
+    uint32_t bestWavesPerCu = 0;
+    uint32_t bestPrimsPerCu = 0;
+
+    // Beyond this, ES vertices are capped, so fewer GS primitives than requested can actually be launched in the
+    // worst case
+    maxGsPrimsPerSubgroup = std::min(maxGsPrimsPerSubgroup, maxEsVertsPerSubgroup / esMinVertsPerSubgroup);
+
+    for (uint32_t gsPrimsPerSubgroup = std::max(minGsPrimsPerSubgroup, 1u);
+         gsPrimsPerSubgroup <= maxGsPrimsPerSubgroup;
+         ++gsPrimsPerSubgroup)
+    {
+        const uint32_t worstCaseEsVertsPerSubgroup = std::min(esMinVertsPerSubgroup * gsPrimsPerSubgroup,
+                                                              maxEsVertsPerSubgroup);
+        const uint32_t esGsLdsSize = esGsRingItemSize * worstCaseEsVertsPerSubgroup;
+        const uint32_t gsOnChipLdsSize = RoundUpToMultiple(esGsLdsSize + gsVsItemSize * gsPrimsPerSubgroup,
+                                                           ldsSizeDwordGranularity);
+        if (gsOnChipLdsSize > maxLdsSize)
+        {
+            // LDS usage only grows with the sub-group size
+            break;
+        }
+
+        const uint32_t threadsPerSubgroup = std::max(worstCaseEsVertsPerSubgroup,
+                                                     gsPrimsPerSubgroup * gsInstanceCount);
+        const uint32_t wavesPerSubgroup = (threadsPerSubgroup + waveSize - 1) / waveSize;
+        const uint32_t subgroupsPerCu = std::min(maxWavesPerCu / wavesPerSubgroup, ldsSizePerCu / gsOnChipLdsSize);
+        const uint32_t primsPerCu = subgroupsPerCu * gsPrimsPerSubgroup * gsInstanceCount;
+
+        LLVM_DEBUG(dbgs() << "On-chip GS candidate: prims = " << gsPrimsPerSubgroup
+                          << ", LDS size = " << gsOnChipLdsSize
+                          << ", waves per CU = " << subgroupsPerCu * wavesPerSubgroup
+                          << ", prims per CU = " << primsPerCu << "\n");
+
+        if (primsPerCu >= bestPrimsPerCu)
+        {
+            bestGsPrimsPerSubgroup = gsPrimsPerSubgroup;
+            bestEsGsLdsSize = esGsLdsSize;
+            bestGsOnChipLdsSize = gsOnChipLdsSize;
+            bestWavesPerCu = subgroupsPerCu * wavesPerSubgroup;
+            bestPrimsPerCu = primsPerCu;
+        }
+    }
+
+    *pGsPrimsPerSubgroup = bestGsPrimsPerSubgroup;
+    *pEsGsLdsSize = bestEsGsLdsSize;
+    *pGsOnChipLdsSize = bestGsOnChipLdsSize;
+
+    return (bestPrimsPerCu > 0) ? bestWavesPerCu : 0;
+}
+
 // =====================================================================================================================
 // Determines whether GS on-chip mode is valid for this pipeline, also computes ES-GS/GS-VS ring item size.
 bool PatchResourceCollect::CheckGsOnChipValidity()
@@ -601,7 +865,7 @@ bool PatchResourceCollect::CheckGsOnChipValidity()
         // need to clear unused builtin ouput before determining onchip/offchip GS mode.
         constexpr uint32_t GsOffChipDefaultThreshold = 32;
 
-        bool disableGsOnChip = DisableGsOnChip;
+        bool disableGsOnChip = (m_pPipelineState->GetOptions().disableGsOnChip != 0);
         if (hasTs || (m_pPipelineState->GetTargetInfo().GetGfxIpVersion().major == 6))
         {
             // GS on-chip is not supportd with tessellation, and is not supportd on GFX6
@@ -738,44 +1002,35 @@ bool PatchResourceCollect::CheckGsOnChipValidity()
                 }
             }
 
-            if (hasGs)
-            {
-                // NOTE: If primitive amplification is active and the currently calculated gsPrimsPerSubgroup multipled
-                // by the amplification factor is larger than the supported number of primitives within a subgroup, we
-                // need to shrimp the number of gsPrimsPerSubgroup down to a reasonable level to prevent
-                // over-allocating LDS.
-                uint32_t maxVertOut = hasGs ? geometryMode.outputVertices : 1;
-
-                LLPC_ASSERT(maxVertOut >= primAmpFactor);
-
-                if ((gsPrimsPerSubgroup * maxVertOut) > Gfx9::NggMaxThreadsPerSubgroup)
-                {
-                    gsPrimsPerSubgroup = Gfx9::NggMaxThreadsPerSubgroup / maxVertOut;
-                }
+            LLPC_ASSERT((hasGs == false) || (geometryMode.outputVertices >= primAmpFactor));
 
-                // Let's take into consideration instancing:
-                const uint32_t gsInstanceCount = geometryMode.invocations;
-                LLPC_ASSERT(gsInstanceCount >= 1);
-                gsPrimsPerSubgroup /= gsInstanceCount;
-                esVertsPerSubgroup = gsPrimsPerSubgroup * maxVertOut;
+            uint32_t nggWavesPerCu = 0;
+#if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 26
+            if ((m_pPipelineState->GetOptions().nggSubgroupCostModel != 0) &&
+                (pNggControl->enableFastLaunch == false) &&
+                (pNggControl->subgroupSizing == NggSubgroupSizingType::Auto))
+            {
+                // Let the cost model override the "Auto" sizing with the sub-group size that maximizes occupancy
+                nggWavesPerCu = SelectNggSubgroupSize(esGsRingItemSize,
+                                                      gsVsRingItemSize,
+                                                      esExtraLdsSize,
+                                                      gsExtraLdsSize,
+                                                      needsLds,
+                                                      &esVertsPerSubgroup,
+                                                      &gsPrimsPerSubgroup);
             }
+#endif
 
-            // Make sure that we have at least one primitive
-            gsPrimsPerSubgroup = std::max(1u, gsPrimsPerSubgroup);
-
-            uint32_t       expectedEsLdsSize = esVertsPerSubgroup * esGsRingItemSize + esExtraLdsSize;
-            const uint32_t expectedGsLdsSize = gsPrimsPerSubgroup * gsVsRingItemSize + gsExtraLdsSize;
-
-            if (expectedGsLdsSize == 0)
-            {
-                LLPC_ASSERT(hasGs == false);
+            AdjustNggSubgroupSize(&esVertsPerSubgroup, &gsPrimsPerSubgroup);
 
-                expectedEsLdsSize = (Gfx9::NggMaxThreadsPerSubgroup * esGsRingItemSize) + esExtraLdsSize;
-            }
-
-            const uint32_t ldsSizeDwords =
-                Pow2Align(expectedEsLdsSize + expectedGsLdsSize,
-                          static_cast<uint32_t>(1 << m_pPipelineState->GetTargetInfo().GetGpuProperty().ldsSizeDwordGranularityShift));
+            uint32_t expectedEsLdsSize = 0;
+            const uint32_t ldsSizeDwords = CalcNggLdsSize(esVertsPerSubgroup,
+                                                          gsPrimsPerSubgroup,
+                                                          esGsRingItemSize,
+                                                          gsVsRingItemSize,
+                                                          esExtraLdsSize,
+                                                          gsExtraLdsSize,
+                                                          &expectedEsLdsSize);
 
             // Make sure we don't allocate more than what can legally be allocated by a single subgroup on the hardware.
             LLPC_ASSERT(ldsSizeDwords <= 16384);
@@ -792,6 +1047,7 @@ bool PatchResourceCollect::CheckGsOnChipValidity()
             pGsResUsage->inOutUsage.gs.calcFactor.gsVsRingItemSize     = gsVsRingItemSize;
 
             pGsResUsage->inOutUsage.gs.calcFactor.primAmpFactor        = primAmpFactor;
+            pGsResUsage->inOutUsage.gs.calcFactor.nggWavesPerCu        = nggWavesPerCu;
 
             gsOnChip = true; // In NGG mode, GS is always on-chip since copy shader is not present.
         }
@@ -873,7 +1129,10 @@ bool PatchResourceCollect::CheckGsOnChipValidity()
                 LLPC_ASSERT(gsOnChipLdsSize <= maxLdsSize);
             }
 
-            if (hasTs || DisableGsOnChip)
+            // Estimated GS waves per CU, if the sub-group size is chosen by the cost model
+            uint32_t gsWavesPerCu = 0;
+
+            if (hasTs || (m_pPipelineState->GetOptions().disableGsOnChip != 0))
             {
                 gsOnChip = false;
             }
@@ -881,58 +1140,102 @@ bool PatchResourceCollect::CheckGsOnChipValidity()
             {
                 // Now let's calculate the onchip GSVS info and determine if it should be on or off chip.
                 uint32_t gsVsItemSize = gsVsRingItemSizeOnChip * gsInstanceCount;
+                const bool gsVsFits = (RoundUpToMultiple(esGsLdsSize + gsVsItemSize * gsPrimsPerSubgroup,
+                                                         ldsSizeDwordGranularity) <= maxLdsSize);
 
-                // Compute GSVS LDS size based on target GS prims per subgroup.
-                uint32_t gsVsLdsSize = gsVsItemSize * gsPrimsPerSubgroup;
+                if ((DisableGsOnChipCostModel == false) && (gsVsFits == false))
+                {
+                    // The GS-VS ring of the sub-group size above doesn't fit in LDS. Keep GS on-chip with any
+                    // sub-group size that fits, as long as it has at least as many GS primitives as the hardware
+                    // guidance threshold for on-chip GS, or as the ES-GS layout above.
+                    constexpr uint32_t GsOnChipMinPrimsThreshold = 32;
+                    const uint32_t minGsPrimsPerSubgroup =
+                        std::min((GsOnChipMinPrimsThreshold + gsInstanceCount - 1) / gsInstanceCount,
+                                 gsPrimsPerSubgroup);
+
+                    uint32_t onchipGsPrimsPerSubgroup = 0;
+                    uint32_t onchipEsGsLdsSize = 0;
+                    uint32_t onchipEsGsVsLdsSize = 0;
+                    gsWavesPerCu = SelectGsOnChipSubgroupSize(esGsRingItemSize,
+                                                              gsVsItemSize,
+                                                              gsInstanceCount,
+                                                              esMinVertsPerSubgroup,
+                                                              minGsPrimsPerSubgroup,
+                                                              maxGsPrimsPerSubgroup,
+                                                              maxEsVertsPerSubgroup,
+                                                              maxLdsSize - esGsExtraLdsDwords,
+                                                              &onchipGsPrimsPerSubgroup,
+                                                              &onchipEsGsLdsSize,
+                                                              &onchipEsGsVsLdsSize);
+                    if (gsWavesPerCu > 0)
+                    {
+                        gsOnChipLdsSize    = onchipEsGsVsLdsSize;
+                        esGsLdsSize        = onchipEsGsLdsSize;
+                        gsPrimsPerSubgroup = onchipGsPrimsPerSubgroup;
+                    }
+                    else
+                    {
+                        // LDS isn't big enough for any sub-group size worth keeping on chip.
+                        gsOnChip = false;
+                    }
+                }
+                else
+                {
+                    // Compute GSVS LDS size based on target GS prims per subgroup.
+                    uint32_t gsVsLdsSize = gsVsItemSize * gsPrimsPerSubgroup;
 
-                // Start out with the assumption that our GS prims per subgroup won't change.
-                uint32_t onchipGsPrimsPerSubgroup = gsPrimsPerSubgroup;
+                    // Start out with the assumption that our GS prims per subgroup won't change.
+                    uint32_t onchipGsPrimsPerSubgroup = gsPrimsPerSubgroup;
 
-                // Total LDS use per subgroup aligned to the register granularity to keep ESGS and GSVS data on chip.
-                uint32_t onchipEsGsVsLdsSize = RoundUpToMultiple(esGsLdsSize + gsVsLdsSize, ldsSizeDwordGranularity);
-                uint32_t onchipEsGsLdsSizeOnchipGsVs = esGsLdsSize;
+                    // Total LDS use per subgroup aligned to the register granularity to keep ESGS and GSVS data on
+                    // chip.
+                    uint32_t onchipEsGsVsLdsSize = RoundUpToMultiple(esGsLdsSize + gsVsLdsSize,
+                                                                     ldsSizeDwordGranularity);
+                    uint32_t onchipEsGsLdsSizeOnchipGsVs = esGsLdsSize;
 
-                if (onchipEsGsVsLdsSize > maxLdsSize)
-                {
-                    // TODO: This code only allocates the minimum required LDS to hit the on chip GS prims per subgroup
-                    //       threshold. This leaves some LDS space unused. The extra space could potentially be used to
-                    //       increase the GS Prims per subgroup.
+                    if (onchipEsGsVsLdsSize > maxLdsSize)
+                    {
+                        // TODO: This code only allocates the minimum required LDS to hit the on chip GS prims per
+                        //       subgroup threshold. This leaves some LDS space unused. The extra space could
+                        //       potentially be used to increase the GS Prims per subgroup.
 
-                    // Set the threshold at the minimum to keep things on chip.
-                    onchipGsPrimsPerSubgroup = maxGsPrimsPerSubgroup;
+                        // Set the threshold at the minimum to keep things on chip.
+                        onchipGsPrimsPerSubgroup = maxGsPrimsPerSubgroup;
 
-                    if (onchipGsPrimsPerSubgroup > 0)
-                    {
-                        worstCaseEsVertsPerSubgroup = std::min(esMinVertsPerSubgroup * onchipGsPrimsPerSubgroup,
-                                                               maxEsVertsPerSubgroup);
+                        if (onchipGsPrimsPerSubgroup > 0)
+                        {
+                            worstCaseEsVertsPerSubgroup = std::min(esMinVertsPerSubgroup * onchipGsPrimsPerSubgroup,
+                                                                   maxEsVertsPerSubgroup);
 
-                        // Calculate the LDS sizes required to hit this threshold.
-                        onchipEsGsLdsSizeOnchipGsVs = Pow2Align(esGsRingItemSize * worstCaseEsVertsPerSubgroup,
-                                                                ldsSizeDwordGranularity);
-                        gsVsLdsSize = gsVsItemSize * onchipGsPrimsPerSubgroup;
-                        onchipEsGsVsLdsSize = onchipEsGsLdsSizeOnchipGsVs + gsVsLdsSize;
+                            // Calculate the LDS sizes required to hit this threshold.
+                            onchipEsGsLdsSizeOnchipGsVs = Pow2Align(esGsRingItemSize * worstCaseEsVertsPerSubgroup,
+                                                                    ldsSizeDwordGranularity);
+                            gsVsLdsSize = gsVsItemSize * onchipGsPrimsPerSubgroup;
+                            onchipEsGsVsLdsSize = onchipEsGsLdsSizeOnchipGsVs + gsVsLdsSize;
 
-                        if (onchipEsGsVsLdsSize > maxLdsSize)
+                            if (onchipEsGsVsLdsSize > maxLdsSize)
+                            {
+                                // LDS isn't big enough to hit the target GS prim per subgroup count for on chip GSVS.
+                                gsOnChip = false;
+                            }
+                        }
+                        else
                         {
-                            // LDS isn't big enough to hit the target GS prim per subgroup count for on chip GSVS.
+                            // With high GS instance counts, it is possible that the number of on chip GS prims
+                            // calculated is zero. If this is the case, we can't expect to use on chip GS.
                             gsOnChip = false;
                         }
                     }
-                    else
+
+                    // If on chip GSVS is optimal, update the ESGS parameters with any changes that allowed for GSVS
+                    // data.
+                    if (gsOnChip)
                     {
-                        // With high GS instance counts, it is possible that the number of on chip GS prims
-                        // calculated is zero. If this is the case, we can't expect to use on chip GS.
-                        gsOnChip = false;
+                        gsOnChipLdsSize    = onchipEsGsVsLdsSize;
+                        esGsLdsSize        = onchipEsGsLdsSizeOnchipGsVs;
+                        gsPrimsPerSubgroup = onchipGsPrimsPerSubgroup;
                     }
                 }
-
-                // If on chip GSVS is optimal, update the ESGS parameters with any changes that allowed for GSVS data.
-                if (gsOnChip)
-                {
-                    gsOnChipLdsSize    = onchipEsGsVsLdsSize;
-                    esGsLdsSize        = onchipEsGsLdsSizeOnchipGsVs;
-                    gsPrimsPerSubgroup = onchipGsPrimsPerSubgroup;
-                }
             }
 
             uint32_t esVertsPerSubgroup = std::min(esGsLdsSize / esGsRingItemSize, maxEsVertsPerSubgroup);
@@ -956,6 +1259,7 @@ bool PatchResourceCollect::CheckGsOnChipValidity()
             pGsResUsage->inOutUsage.gs.calcFactor.gsPrimsPerSubgroup   = gsPrimsPerSubgroup;
             pGsResUsage->inOutUsage.gs.calcFactor.esGsLdsSize          = esGsLdsSize;
             pGsResUsage->inOutUsage.gs.calcFactor.gsOnChipLdsSize      = gsOnChipLdsSize;
+            pGsResUsage->inOutUsage.gs.calcFactor.gsWavesPerCu         = gsWavesPerCu;
 
             pGsResUsage->inOutUsage.gs.calcFactor.esGsRingItemSize     = esGsRingItemSize;
             pGsResUsage->inOutUsage.gs.calcFactor.gsVsRingItemSize     = gsOnChip ?
@@ -999,6 +1303,16 @@ bool PatchResourceCollect::CheckGsOnChipValidity()
     LLPC_OUTS("// LLPC geometry calculation factor results\n\n");
     LLPC_OUTS("ES vertices per sub-group: " << pGsResUsage->inOutUsage.gs.calcFactor.esVertsPerSubgroup << "\n");
     LLPC_OUTS("GS primitives per sub-group: " << pGsResUsage->inOutUsage.gs.calcFactor.gsPrimsPerSubgroup << "\n");
+    if (pGsResUsage->inOutUsage.gs.calcFactor.gsWavesPerCu > 0)
+    {
+        LLPC_OUTS("Estimated GS waves per CU: " << pGsResUsage->inOutUsage.gs.calcFactor.gsWavesPerCu << "\n");
+    }
+#if LLPC_BUILD_GFX10
+    if (pGsResUsage->inOutUsage.gs.calcFactor.nggWavesPerCu > 0)
+    {
+        LLPC_OUTS("Estimated NGG waves per CU: " << pGsResUsage->inOutUsage.gs.calcFactor.nggWavesPerCu << "\n");
+    }
+#endif
     LLPC_OUTS("\n");
     LLPC_OUTS("ES-GS LDS size: " << pGsResUsage->inOutUsage.gs.calcFactor.esGsLdsSize << "\n");
     LLPC_OUTS("On-chip GS LDS size: " << pGsResUsage->inOutUsage.gs.calcFactor.gsOnChipLdsSize << "\n");
@@ -1409,23 +1723,23 @@ void PatchResourceCollect::visitCallInst(
         }
     }
 
-    if (CanPackInOut())
+    if (CanPackInput())
     {
-        if ((m_shaderStage == ShaderStageFragment) && (isDeadCall == false))
+        if (isDeadCall == false)
         {
-            // Collect LocationSpans according to each FS' input call
-            bool isInput = m_pLocationMapManager->AddSpan(&callInst);
+            // Collect LocationSpans according to each input import call
+            bool isInput = m_pLocationMapManager->AddSpan(&callInst, m_shaderStage);
             if (isInput)
             {
                 m_inOutCalls.push_back(&callInst);
                 m_deadCalls.insert(&callInst);
             }
         }
-        else if ((m_shaderStage == ShaderStageVertex) && mangledName.startswith(LlpcName::OutputExportGeneric))
-        {
-            m_inOutCalls.push_back(&callInst);
-            m_deadCalls.insert(&callInst);
-        }
+    }
+    else if (CanPackOutput() && mangledName.startswith(LlpcName::OutputExportGeneric))
+    {
+        m_inOutCalls.push_back(&callInst);
+        m_deadCalls.insert(&callInst);
     }
 }
 
@@ -2015,7 +2329,7 @@ void PatchResourceCollect::MatchGenericInOut()
         }
     }
 
-    if (CanPackInOut())
+    if (CanPackInput() || CanPackOutput())
     {
         // Do packing input/output
         PackInOutLocation();
@@ -3265,46 +3579,235 @@ void PatchResourceCollect::MapGsBuiltInOutput(
 }
 
 // =====================================================================================================================
-// Determine whether the requirements of packing input/output is satisfied in patch phase
-bool PatchResourceCollect::CanPackInOut() const
+// Gets the indices of the location offset argument (0 if there is none) and the component argument of a generic input
+// import call.
+static void GetInputImportArgIndices(
+    CallInst*   pCall,              // [in] Generic or interpolant input import call
+    ShaderStage shaderStage,        // Shader stage of the call
+    uint32_t*   pLocOffsetArgIdx,   // [out] Index of the location offset argument, 0 if there is none
+    uint32_t*   pCompArgIdx)        // [out] Index of the component argument
+{
+    // TCS: @llpc.input.import.generic.%Type%(i32 location, i32 locOffset, i32 elemIdx, i32 vertexIdx)
+    // TES: @llpc.input.import.generic.%Type%(i32 location, i32 locOffset, i32 elemIdx, i32 vertexIdx)
+    // GS:  @llpc.input.import.generic.%Type%(i32 location, i32 elemIdx, i32 vertexIdx)
+    // FS:  @llpc.input.import.generic.%Type%(i32 location, i32 elemIdx, i32 interpMode, i32 interpLoc)
+    //      @llpc.input.import.interpolant.%Type%(i32 location, i32 locOffset, i32 elemIdx,
+    //                                            i32 interpMode, <2 x float> | i32 auxInterpValue)
+    const bool hasLocOffset = pCall->getCalledFunction()->getName().startswith(LlpcName::InputImportInterpolant) ||
+                              (shaderStage == ShaderStageTessControl) ||
+                              (shaderStage == ShaderStageTessEval);
+    *pLocOffsetArgIdx = hasLocOffset ? 1 : 0;
+    *pCompArgIdx = hasLocOffset ? 2 : 1;
+}
+
+// =====================================================================================================================
+// Gets the InOutLocation of a 32-bit component, given as a location and a component index that may exceed a location
+// (as it does for the high halves of a split 64-bit vector).
+static InOutLocation GetInOutLocation(
+    uint32_t location,      // Location
+    uint32_t component)     // Component index, in 32-bit units from the start of the location
+{
+    InOutLocation inOutLoc = {};
+    inOutLoc.locationInfo.location = location + component / 4;
+    inOutLoc.locationInfo.component = component % 4;
+    inOutLoc.locationInfo.half = false;
+    return inOutLoc;
+}
+
+// =====================================================================================================================
+// Gets the compatibility info of a generic or interpolant input import call of the specified bit width: only inputs
+// with the same compatibility info are packed into the same location.
+static InOutCompatibilityInfo GetInputCompatibilityInfo(
+    CallInst*   pCall,          // [in] Input import call
+    ShaderStage shaderStage,    // Shader stage of the call
+    uint32_t    compArgIdx,     // Index of the component argument of the call
+    uint32_t    bitWidth)       // Bit width of the scalar input
+{
+    InOutCompatibilityInfo compatibilityInfo = {};
+    compatibilityInfo.halfComponentCount = bitWidth < 64 ? 2 : 4;
+    compatibilityInfo.is16Bit = false;
+    if (shaderStage == ShaderStageFragment)
+    {
+        const uint32_t interpMode = cast<ConstantInt>(pCall->getOperand(compArgIdx + 1))->getZExtValue();
+        compatibilityInfo.isFlat = (interpMode == InOutInfo::InterpModeFlat);
+        compatibilityInfo.isCustom = (interpMode == InOutInfo::InterpModeCustom);
+    }
+    return compatibilityInfo;
+}
+
+// =====================================================================================================================
+// Selects the stage interfaces whose generic inputs/outputs are packed: the inputs of the consumer stage are
+// scalarized and packed into consecutive components, and the outputs of the producer stage are reassembled to match.
+// The supported interfaces are VS/TES-to-FS (without GS), VS/TES-to-GS and VS-to-TCS. GS-to-FS is not supported as
+// GS outputs are exported on each vertex emit rather than once.
+//
+// With -pack-in-out, every supported interface is packed. Otherwise, an interface is packed where a cost model
+// predicts fewer locations, which means fewer parameter cache exports for FS, and less ES-GS ring or LDS space per
+// vertex for GS and TCS.
+void PatchResourceCollect::SelectInOutPacking(
+    Module* pModule)    // [in] Module
+{
+    m_packInputStageMask = 0;
+    if (m_pPipelineState->IsGraphics() == false)
+    {
+        return;
+    }
+
+    const bool forcePack = (m_pPipelineState->GetOptions().packInOut != 0);
+    if ((forcePack == false) && (m_pPipelineState->GetOptions().disablePackInOutCostModel != 0))
+    {
+        return;
+    }
+
+    // Gather the locations and 32-bit components that the generic inputs of each consumer stage read.
+    struct InputInterface
+    {
+        bool                                    canPack;        // Whether all reads have constant locations
+        std::set<uint32_t>                      locs;           // Locations read without packing
+        std::map<uint16_t, std::set<uint32_t>>  components;     // Components read, by compatibility key
+    };
+    InputInterface inputInterfaces[ShaderStageGfxCount] = {};
+    for (auto& inputInterface : inputInterfaces)
+    {
+        inputInterface.canPack = true;
+    }
+
+    for (Function& func : *pModule)
+    {
+        if ((func.getName().startswith(LlpcName::InputImportGeneric) == false) &&
+            (func.getName().startswith(LlpcName::InputImportInterpolant) == false))
+        {
+            continue;
+        }
+
+        for (User* pUser : func.users())
+        {
+            auto pCall = cast<CallInst>(pUser);
+            ShaderStage shaderStage = m_pPipelineShaders->GetShaderStage(pCall->getFunction());
+            if ((shaderStage != ShaderStageTessControl) &&
+                (shaderStage != ShaderStageGeometry) &&
+                (shaderStage != ShaderStageFragment))
+            {
+                continue;
+            }
+
+            InputInterface& inputInterface = inputInterfaces[shaderStage];
+            uint32_t locOffsetArgIdx = 0;
+            uint32_t compArgIdx = 0;
+            GetInputImportArgIndices(pCall, shaderStage, &locOffsetArgIdx, &compArgIdx);
+
+            auto pLocOffset = (locOffsetArgIdx != 0) ? dyn_cast<ConstantInt>(pCall->getArgOperand(locOffsetArgIdx)) :
+                                                       nullptr;
+            auto pComp = dyn_cast<ConstantInt>(pCall->getArgOperand(compArgIdx));
+            if (((locOffsetArgIdx != 0) && (pLocOffset == nullptr)) || (pComp == nullptr))
+            {
+                // Dynamic indexing, the location of the input is not known.
+                inputInterface.canPack = false;
+                continue;
+            }
+
+            // Scalarizing splits 64-bit values into 32-bit halves, whose component index is in 32-bit units.
+            Type* pInputTy = pCall->getType();
+            const uint32_t compScale = (pInputTy->getScalarSizeInBits() == 64) ? 2 : 1;
+
+            // Classify the input by the same key that packing groups the scalarized inputs by.
+            InOutLocationMapManager::LocationSpan span = {};
+            span.compatibilityInfo = GetInputCompatibilityInfo(pCall,
+                                                               shaderStage,
+                                                               compArgIdx,
+                                                               pInputTy->getScalarSizeInBits() / compScale);
+            const uint16_t compatibilityKey = span.GetCompatibilityKey();
+
+            const uint32_t compCount = (pInputTy->isVectorTy() ? pInputTy->getVectorNumElements() : 1) * compScale;
+            const uint32_t loc = cast<ConstantInt>(pCall->getArgOperand(0))->getZExtValue() +
+                                 ((pLocOffset != nullptr) ? pLocOffset->getZExtValue() : 0);
+            const uint32_t firstComp = pComp->getZExtValue() * compScale;
+            for (uint32_t comp = firstComp; comp < firstComp + compCount; ++comp)
+            {
+                InOutLocation inOutLoc = GetInOutLocation(loc, comp);
+                inputInterface.locs.insert(inOutLoc.locationInfo.location);
+                inputInterface.components[compatibilityKey].insert(inOutLoc.AsIndex());
+            }
+        }
+    }
+
+    for (auto consumerStage : { ShaderStageTessControl, ShaderStageGeometry, ShaderStageFragment })
+    {
+        if (m_pPipelineState->HasShaderStage(consumerStage) == false)
+        {
+            continue;
+        }
+
+        const ShaderStage producerStage = m_pPipelineState->GetPrevShaderStage(consumerStage);
+        const bool isSupported = (consumerStage == ShaderStageTessControl) ?
+                                 (producerStage == ShaderStageVertex) :
+                                 ((producerStage == ShaderStageVertex) || (producerStage == ShaderStageTessEval));
+        const InputInterface& inputInterface = inputInterfaces[consumerStage];
+        if ((isSupported == false) || (inputInterface.canPack == false) || inputInterface.locs.empty())
+        {
+            continue;
+        }
+
+        uint32_t packedLocCount = 0;
+        for (const auto& components : inputInterface.components)
+        {
+            packedLocCount += (components.second.size() + 3) / 4;
+        }
+
+        LLVM_DEBUG(dbgs() << "Input/output packing of " << GetShaderStageName(consumerStage) << " inputs: "
+                          << inputInterface.locs.size() << " locations, " << packedLocCount << " when packed\n");
+
+        if (forcePack || (packedLocCount < inputInterface.locs.size()))
+        {
+            m_packInputStageMask |= ShaderStageToMask(consumerStage);
+        }
+    }
+}
+
+// =====================================================================================================================
+// Determine whether the generic inputs of the current shader stage are packed
+bool PatchResourceCollect::CanPackInput() const
+{
+    return (m_packInputStageMask & ShaderStageToMask(m_shaderStage)) != 0;
+}
+
+// =====================================================================================================================
+// Determine whether the generic outputs of the current shader stage are packed, to match the packed inputs of the next
+// shader stage
+bool PatchResourceCollect::CanPackOutput() const
 {
-    // Pack input/output requirements:
-    // 1) -pack-in-out option is on
-    // 2) It is a VS-FS pipeline
-    return PackInOut &&
-           (m_pPipelineState->GetShaderStageMask() ==
-            (ShaderStageToMask(ShaderStageVertex) | ShaderStageToMask(ShaderStageFragment)));
+    const ShaderStage nextStage = m_pPipelineState->GetNextShaderStage(m_shaderStage);
+    return (nextStage != ShaderStageInvalid) && ((m_packInputStageMask & ShaderStageToMask(nextStage)) != 0);
 }
 
 // =====================================================================================================================
 // The process of packing input/output
 void PatchResourceCollect::PackInOutLocation()
 {
-    if (m_shaderStage == ShaderStageFragment)
+    if (CanPackInput())
     {
         m_pLocationMapManager->BuildLocationMap();
 
         ReviseInputImportCalls();
-
-        m_inOutCalls.clear(); // It will hold XX' output calls
     }
-    else if (m_shaderStage == ShaderStageVertex)
+    else
     {
+        LLPC_ASSERT(CanPackOutput());
+
         ReassembleOutputExportCalls();
 
         // For computing the shader hash
+        const ShaderStage nextStage = m_pPipelineState->GetNextShaderStage(m_shaderStage);
         m_pContext->GetShaderResourceUsage(m_shaderStage)->inOutUsage.inOutLocMap =
-            m_pContext->GetShaderResourceUsage(ShaderStageFragment)->inOutUsage.inOutLocMap;
-    }
-    else
-    {
-        // TODO: Pack input/output in other stages is not supported
-        LLPC_NOT_IMPLEMENTED();
+            m_pContext->GetShaderResourceUsage(nextStage)->inOutUsage.inOutLocMap;
     }
+
+    // The calls of the previous stage are collected next
+    m_inOutCalls.clear();
 }
 
 // =====================================================================================================================
-// Revise the location and element index fields of the fragment shaders input import functions
+// Revise the location and element index fields of the input import functions of the consumer stage
 void PatchResourceCollect::ReviseInputImportCalls()
 {
     if (m_inOutCalls.empty())
@@ -3312,8 +3815,6 @@ void PatchResourceCollect::ReviseInputImportCalls()
         return;
     }
 
-    LLPC_ASSERT(m_shaderStage == ShaderStageFragment);
-
     auto& inOutUsage = m_pContext->GetShaderResourceUsage(m_shaderStage)->inOutUsage;
     auto& inputLocMap = inOutUsage.inputLocMap;
     inputLocMap.clear();
@@ -3322,21 +3823,20 @@ void PatchResourceCollect::ReviseInputImportCalls()
 
     for (auto pCall : m_inOutCalls)
     {
-        auto argCount = pCall->arg_size();
-        const bool isInterpolant = (argCount == 5);
-        uint32_t compIdx = 1;
+        uint32_t locOffsetArgIdx = 0;
+        uint32_t compArgIdx = 0;
+        GetInputImportArgIndices(pCall, m_shaderStage, &locOffsetArgIdx, &compArgIdx);
+
         uint32_t locOffset = 0;
-        if (isInterpolant)
+        if (locOffsetArgIdx != 0)
         {
-            compIdx = 2;
-            locOffset = cast<ConstantInt>(pCall->getOperand(1))->getZExtValue();
+            locOffset = cast<ConstantInt>(pCall->getArgOperand(locOffsetArgIdx))->getZExtValue();
         }
 
-        // Construct original InOutLocation from the location and elemIdx operands of the FS' input import call
-        InOutLocation origInLoc = {};
-        origInLoc.locationInfo.location = cast<ConstantInt>(pCall->getOperand(0))->getZExtValue() + locOffset;
-        origInLoc.locationInfo.component = cast<ConstantInt>(pCall->getOperand(compIdx))->getZExtValue();
-        origInLoc.locationInfo.half = false;
+        // Construct original InOutLocation from the location and elemIdx operands of the input import call
+        InOutLocation origInLoc =
+            GetInOutLocation(cast<ConstantInt>(pCall->getArgOperand(0))->getZExtValue() + locOffset,
+                             cast<ConstantInt>(pCall->getArgOperand(compArgIdx))->getZExtValue());
 
         // Get the packed InOutLocation from locationMap
         const InOutLocation* pNewInLoc = nullptr;
@@ -3347,28 +3847,17 @@ void PatchResourceCollect::ReviseInputImportCalls()
         inputLocMap[pNewInLoc->locationInfo.location] = InvalidValue;
         inOutUsage.inOutLocMap[origInLoc.AsIndex()] = pNewInLoc->AsIndex();
 
-        // Re-write the input import call by using the new InOutLocation
-        SmallVector<Value*, 5> args;
-        std::string callName;
-        if (isInterpolant == false)
+        // Re-write the input import call by using the new InOutLocation, keeping the other operands
+        SmallVector<Value*, 5> args(pCall->arg_begin(), pCall->arg_end());
+        args[0] = builder.getInt32(pNewInLoc->locationInfo.location);
+        if (locOffsetArgIdx != 0)
         {
-            args.push_back(builder.getInt32(pNewInLoc->locationInfo.location));
-            args.push_back(builder.getInt32(pNewInLoc->locationInfo.component));
-            args.push_back(pCall->getOperand(2));
-            args.push_back(pCall->getOperand(3));
-
-            callName = LlpcName::InputImportGeneric;
+            args[locOffsetArgIdx] = builder.getInt32(0);
         }
-        else
-        {
-            args.push_back(builder.getInt32(pNewInLoc->locationInfo.location));
-            args.push_back(builder.getInt32(0));
-            args.push_back(builder.getInt32(pNewInLoc->locationInfo.component));
-            args.push_back(pCall->getOperand(3));
-            args.push_back(pCall->getOperand(4));
+        args[compArgIdx] = builder.getInt32(pNewInLoc->locationInfo.component);
 
-            callName = LlpcName::InputImportInterpolant;
-        }
+        std::string callName = pCall->getCalledFunction()->getName().startswith(LlpcName::InputImportInterpolant) ?
+                               LlpcName::InputImportInterpolant : LlpcName::InputImportGeneric;
 
         // Previous stage converts non-float type to float type when outputs
         Type* pReturnTy = m_pContext->FloatTy();
@@ -3417,13 +3906,13 @@ void PatchResourceCollect::ReassembleOutputExportCalls()
 
     // Collect the components of a vector exported from each packed location
     // Assume each location exports a vector with four components
-    std::vector<std::array<Value*, 4>> packedComponents(m_inOutCalls.size());
+    std::vector<std::array<Value*, 4>> packedComponents;
     for (auto pCall : m_inOutCalls)
     {
-        InOutLocation origOutLoc = {};
-        origOutLoc.locationInfo.location = cast<ConstantInt>(pCall->getOperand(0))->getZExtValue();
-        origOutLoc.locationInfo.component = cast<ConstantInt>(pCall->getOperand(1))->getZExtValue();
-        origOutLoc.locationInfo.half = false;
+        // VS:  @llpc.output.export.generic.%Type%(i32 location, i32 elemIdx, %Type% outputValue)
+        // TES: @llpc.output.export.generic.%Type%(i32 location, i32 elemIdx, %Type% outputValue)
+        InOutLocation origOutLoc = GetInOutLocation(cast<ConstantInt>(pCall->getOperand(0))->getZExtValue(),
+                                                    cast<ConstantInt>(pCall->getOperand(1))->getZExtValue());
 
         const InOutLocation* pNewInLoc = nullptr;
         const bool isFound = m_pLocationMapManager->FindMap(origOutLoc, pNewInLoc);
@@ -3432,8 +3921,12 @@ void PatchResourceCollect::ReassembleOutputExportCalls()
             continue;
         }
 
-        auto& components = packedComponents[pNewInLoc->locationInfo.location];
-        components[pNewInLoc->locationInfo.component] = pCall->getOperand(2);
+        const uint32_t packedLoc = pNewInLoc->locationInfo.location;
+        if (packedLoc >= packedComponents.size())
+        {
+            packedComponents.resize(packedLoc + 1, {});
+        }
+        packedComponents[packedLoc][pNewInLoc->locationInfo.component] = pCall->getOperand(2);
     }
 
     // Re-assamble XX' output export calls for each packed location
@@ -3444,21 +3937,22 @@ void PatchResourceCollect::ReassembleOutputExportCalls()
     outputLocMap.clear();
 
     Value* args[3] = {};
-    uint32_t consectiveLocation = 0;
-    for (auto components : packedComponents)
+    for (uint32_t packedLoc = 0; packedLoc < packedComponents.size(); ++packedLoc)
     {
+        const auto& components = packedComponents[packedLoc];
         uint32_t compCount = 0;
-        for (auto pComp : components)
+        for (uint32_t compIdx = 0; compIdx < components.size(); ++compIdx)
         {
-            if (pComp != nullptr)
+            if (components[compIdx] != nullptr)
             {
-                ++compCount;
+                compCount = compIdx + 1;
             }
         }
 
         if (compCount == 0)
         {
-            break;
+            // Nothing the next stage reads is exported at this location
+            continue;
         }
 
         // Construct the output vector
@@ -3466,8 +3960,14 @@ void PatchResourceCollect::ReassembleOutputExportCalls()
                            UndefValue::get(VectorType::get(m_pContext->FloatTy(), compCount));
         for (auto compIdx = 0; compIdx < compCount; ++compIdx)
         {
-            // Type conversion from non-float to float
             Value* pComp = components[compIdx];
+            if (pComp == nullptr)
+            {
+                // A component the next stage reads, but that is not exported
+                pComp = UndefValue::get(m_pContext->FloatTy());
+            }
+
+            // Type conversion from non-float to float
             Type* pCompTy = pComp->getType();
             if (pCompTy->isIntegerTy())
             {
@@ -3495,7 +3995,7 @@ void PatchResourceCollect::ReassembleOutputExportCalls()
             }
         }
 
-        args[0] = builder.getInt32(consectiveLocation);
+        args[0] = builder.getInt32(packedLoc);
         args[1] = builder.getInt32(0);
         args[2] = pOutValue;
 
@@ -3504,67 +4004,69 @@ void PatchResourceCollect::ReassembleOutputExportCalls()
 
         EmitCall(callName, m_pContext->VoidTy(), args, NoAttrib, builder);
 
-        outputLocMap[consectiveLocation] = InvalidValue;
-        ++consectiveLocation;
+        outputLocMap[packedLoc] = InvalidValue;
     }
 }
 
 // =====================================================================================================================
-// Scalarize last vertex processing stage outputs and FS inputs ready for packing.
+// Scalarize the outputs and inputs of the stage interfaces selected for packing.
 void PatchResourceCollect::ScalarizeForInOutPacking(
     Module* pModule)    // [in/out] Module
 {
     // First gather the input/output calls that need scalarizing.
-    SmallVector<CallInst*, 4> vsOutputCalls;
-    SmallVector<CallInst*, 4> fsInputCalls;
+    SmallVector<CallInst*, 4> outputCalls;
+    SmallVector<CallInst*, 4> inputCalls;
     for (Function& func : *pModule)
     {
         if (func.getName().startswith(LlpcName::InputImportGeneric) ||
             func.getName().startswith(LlpcName::InputImportInterpolant))
         {
-            // This is a generic (possibly interpolated) input. Find its uses in FS.
+            // This is a generic (possibly interpolated) input. Find its uses in the packed consumer stages.
             for (User* pUser : func.users())
             {
                 auto pCall = cast<CallInst>(pUser);
-                if (m_pPipelineShaders->GetShaderStage(pCall->getFunction()) != ShaderStageFragment)
+                ShaderStage shaderStage = m_pPipelineShaders->GetShaderStage(pCall->getFunction());
+                if ((m_packInputStageMask & ShaderStageToMask(shaderStage)) == 0)
                 {
                     continue;
                 }
-                // We have a use in FS. See if it needs scalarizing.
+                // We have a use in a packed consumer stage. See if it needs scalarizing.
                 if (isa<VectorType>(pCall->getType()) || (pCall->getType()->getPrimitiveSizeInBits() == 64))
                 {
-                    fsInputCalls.push_back(pCall);
+                    inputCalls.push_back(pCall);
                 }
             }
         }
         else if (func.getName().startswith(LlpcName::OutputExportGeneric))
         {
-            // This is a generic output. Find its uses in the last vertex processing stage.
+            // This is a generic output. Find its uses in the producer stages.
             for (User* pUser : func.users())
             {
                 auto pCall = cast<CallInst>(pUser);
-                if (m_pPipelineShaders->GetShaderStage(pCall->getFunction()) !=
-                      m_pPipelineState->GetLastVertexProcessingStage())
+                ShaderStage shaderStage = m_pPipelineShaders->GetShaderStage(pCall->getFunction());
+                ShaderStage nextStage = m_pPipelineState->GetNextShaderStage(shaderStage);
+                if ((nextStage == ShaderStageInvalid) ||
+                    ((m_packInputStageMask & ShaderStageToMask(nextStage)) == 0))
                 {
                     continue;
                 }
-                // We have a use the last vertex processing stage. See if it needs scalarizing. The output value is
-                // always the final argument.
+                // We have a use in a producer stage. See if it needs scalarizing. The output value is always the final
+                // argument.
                 Type* pValueTy = pCall->getArgOperand(pCall->getNumArgOperands() - 1)->getType();
                 if (isa<VectorType>(pValueTy) || (pValueTy->getPrimitiveSizeInBits() == 64))
                 {
-                    vsOutputCalls.push_back(pCall);
+                    outputCalls.push_back(pCall);
                 }
             }
         }
     }
 
     // Scalarize the gathered inputs and outputs.
-    for (CallInst* pCall : fsInputCalls)
+    for (CallInst* pCall : inputCalls)
     {
         ScalarizeGenericInput(pCall);
     }
-    for (CallInst* pCall : vsOutputCalls)
+    for (CallInst* pCall : outputCalls)
     {
         ScalarizeGenericOutput(pCall);
     }
@@ -3572,24 +4074,26 @@ void PatchResourceCollect::ScalarizeForInOutPacking(
 
 // =====================================================================================================================
 // Scalarize a generic input.
-// This is known to be an FS generic or interpolant input that is either a vector or 64 bit.
+// This is known to be a TCS/GS generic input, or an FS generic or interpolant input, that is either a vector or 64 bit.
 void PatchResourceCollect::ScalarizeGenericInput(
     CallInst* pCall)  // [in] Call that represents importing the generic or interpolant input
 {
     IRBuilder<> builder(pCall->getContext());
     builder.SetInsertPoint(pCall);
 
-    // FS:  @llpc.input.import.generic.%Type%(i32 location, i32 elemIdx, i32 interpMode, i32 interpLoc)
-    //      @llpc.input.import.interpolant.%Type%(i32 location, i32 locOffset, i32 elemIdx,
-    //                                            i32 interpMode, <2 x float> | i32 auxInterpValue)
     SmallVector<Value*, 5> args;
     for (uint32_t i = 0, end = pCall->getNumArgOperands(); i != end; ++i)
     {
         args.push_back(pCall->getArgOperand(i));
     }
 
-    bool isInterpolant = args.size() != 4;
-    uint32_t elemIdxArgIdx = isInterpolant ? 2 : 1;
+    bool isInterpolant = pCall->getCalledFunction()->getName().startswith(LlpcName::InputImportInterpolant);
+    uint32_t locOffsetArgIdx = 0;
+    uint32_t elemIdxArgIdx = 0;
+    GetInputImportArgIndices(pCall,
+                             m_pPipelineShaders->GetShaderStage(pCall->getFunction()),
+                             &locOffsetArgIdx,
+                             &elemIdxArgIdx);
     uint32_t elemIdx = cast<ConstantInt>(args[elemIdxArgIdx])->getZExtValue();
     Type* pResultTy = pCall->getType();
 
@@ -3756,63 +4260,45 @@ void PatchResourceCollect::ScalarizeGenericOutput(
 // =====================================================================================================================
 // Fill the locationSpan container by constructing a LocationSpan from each input import call
 bool InOutLocationMapManager::AddSpan(
-    CallInst*   pCall)  // [in] Call to process
+    CallInst*   pCall,          // [in] Call to process
+    ShaderStage shaderStage)    // Shader stage of the call
 {
     auto pCallee = pCall->getCalledFunction();
     auto mangledName = pCallee->getName();
-    bool isInput = false;
-    if (mangledName.startswith(LlpcName::InputImportGeneric))
+    const bool isInterpolant = mangledName.startswith(LlpcName::InputImportInterpolant);
+    if ((isInterpolant == false) && (mangledName.startswith(LlpcName::InputImportGeneric) == false))
     {
-        LocationSpan span = {};
-
-        span.firstLocation.locationInfo.location = cast<ConstantInt>(pCall->getOperand(0))->getZExtValue();
-        span.firstLocation.locationInfo.component = cast<ConstantInt>(pCall->getOperand(1))->getZExtValue();
-        span.firstLocation.locationInfo.half = false;
-
-        const uint32_t bitWidth = pCallee->getReturnType()->getScalarSizeInBits();
-        span.compatibilityInfo.halfComponentCount = bitWidth < 64 ? 2 : 4;
-
-        span.compatibilityInfo.isFlat =
-            (cast<ConstantInt>(pCall->getOperand(2))->getZExtValue() == InOutInfo::InterpModeFlat);
-        span.compatibilityInfo.is16Bit = false;
-        span.compatibilityInfo.isCustom =
-            (cast<ConstantInt>(pCall->getOperand(2))->getZExtValue() == InOutInfo::InterpModeCustom);
+        return false;
+    }
 
-        LLPC_ASSERT(std::find(m_locationSpans.begin(), m_locationSpans.end(), span) == m_locationSpans.end());
-        m_locationSpans.push_back(span);
+    uint32_t locOffsetArgIdx = 0;
+    uint32_t compArgIdx = 0;
+    GetInputImportArgIndices(pCall, shaderStage, &locOffsetArgIdx, &compArgIdx);
 
-        isInput = true;
-    }
-    if (mangledName.startswith(LlpcName::InputImportInterpolant))
+    uint32_t location = cast<ConstantInt>(pCall->getOperand(0))->getZExtValue();
+    if (locOffsetArgIdx != 0)
     {
-        auto pLocOffset = pCall->getOperand(1);
+        auto pLocOffset = pCall->getOperand(locOffsetArgIdx);
         LLPC_ASSERT(isa<ConstantInt>(pLocOffset));
+        location += cast<ConstantInt>(pLocOffset)->getZExtValue();
+    }
 
-        LocationSpan span = {};
-
-        span.firstLocation.locationInfo.location = cast<ConstantInt>(pCall->getOperand(0))->getZExtValue() +
-                                        cast<ConstantInt>(pLocOffset)->getZExtValue();
-        span.firstLocation.locationInfo.component = cast<ConstantInt>(pCall->getOperand(2))->getZExtValue();
-        span.firstLocation.locationInfo.half = false;
-
-        const uint32_t bitWidth = pCallee->getReturnType()->getScalarSizeInBits();
-        span.compatibilityInfo.halfComponentCount = bitWidth < 64 ? 2 : 4;
-
-        span.compatibilityInfo.isFlat =
-            (cast<ConstantInt>(pCall->getOperand(3))->getZExtValue() == InOutInfo::InterpModeFlat);
-        span.compatibilityInfo.is16Bit = false;
-        span.compatibilityInfo.isCustom =
-            (cast<ConstantInt>(pCall->getOperand(3))->getZExtValue() == InOutInfo::InterpModeCustom);
+    LocationSpan span = {};
+    span.firstLocation = GetInOutLocation(location, cast<ConstantInt>(pCall->getOperand(compArgIdx))->getZExtValue());
 
-        if (std::find(m_locationSpans.begin(), m_locationSpans.end(), span) == m_locationSpans.end())
-        {
-            m_locationSpans.push_back(span);
-        }
+    span.compatibilityInfo = GetInputCompatibilityInfo(pCall,
+                                                       shaderStage,
+                                                       compArgIdx,
+                                                       pCallee->getReturnType()->getScalarSizeInBits());
 
-        isInput = true;
+    // NOTE: The same component may be read more than once, e.g. for different vertices in TCS and GS, or at
+    // different interpolation locations in FS.
+    if (std::find(m_locationSpans.begin(), m_locationSpans.end(), span) == m_locationSpans.end())
+    {
+        m_locationSpans.push_back(span);
     }
 
-    return isInput;
+    return true;
 }
 
 // =====================================================================================================================
@@ -3822,6 +4308,9 @@ void InOutLocationMapManager::BuildLocationMap()
     // Sort m_locationSpans based on LocationSpan::GetCompatibilityKey() and InOutLocation::AsIndex()
     std::sort(m_locationSpans.begin(), m_locationSpans.end());
 
+    // The map of a previously packed stage interface is no longer needed
+    m_locationMap.clear();
+
     // Map original InOutLocation to new InOutLocation
     uint32_t consectiveLocation = 0;
     uint32_t compIdx = 0;
@@ -73,10 +73,40 @@ private:
     // Determines whether GS on-chip mode is valid for this pipeline, also computes ES-GS/GS-VS ring item size.
     bool CheckGsOnChipValidity();
 
+    // On-chip GS sub-group sizing
+    uint32_t SelectGsOnChipSubgroupSize(uint32_t  esGsRingItemSize,
+                                        uint32_t  gsVsItemSize,
+                                        uint32_t  gsInstanceCount,
+                                        uint32_t  esMinVertsPerSubgroup,
+                                        uint32_t  minGsPrimsPerSubgroup,
+                                        uint32_t  maxGsPrimsPerSubgroup,
+                                        uint32_t  maxEsVertsPerSubgroup,
+                                        uint32_t  maxLdsSize,
+                                        uint32_t* pGsPrimsPerSubgroup,
+                                        uint32_t* pEsGsLdsSize,
+                                        uint32_t* pGsOnChipLdsSize);
+
     // Sets NGG control settings
     void SetNggControl();
     void BuildNggCullingControlRegister(NggControl& nggControl);
 
+    // NGG sub-group sizing
+    void AdjustNggSubgroupSize(uint32_t* pEsVertsPerSubgroup, uint32_t* pGsPrimsPerSubgroup);
+    uint32_t CalcNggLdsSize(uint32_t  esVertsPerSubgroup,
+                            uint32_t  gsPrimsPerSubgroup,
+                            uint32_t  esGsRingItemSize,
+                            uint32_t  gsVsRingItemSize,
+                            uint32_t  esExtraLdsSize,
+                            uint32_t  gsExtraLdsSize,
+                            uint32_t* pEsLdsSize);
+    uint32_t SelectNggSubgroupSize(uint32_t  esGsRingItemSize,
+                                   uint32_t  gsVsRingItemSize,
+                                   uint32_t  esExtraLdsSize,
+                                   uint32_t  gsExtraLdsSize,
+                                   bool      needsLds,
+                                   uint32_t* pEsVertsPerSubgroup,
+                                   uint32_t* pGsPrimsPerSubgroup);
+
     void ProcessShader();
 
     void ClearInactiveInput();
@@ -88,7 +118,9 @@ private:
     void MapGsGenericOutput(GsOutLocInfo outLocInfo);
     void MapGsBuiltInOutput(uint32_t builtInId, uint32_t elemCount);
 
-    bool CanPackInOut() const;
+    void SelectInOutPacking(Module* pModule);
+    bool CanPackInput() const;
+    bool CanPackOutput() const;
     void PackInOutLocation();
     void ReviseInputImportCalls();
     void ReassembleOutputExportCalls();
@@ -120,6 +152,8 @@ private:
     bool            m_hasDynIndexedOutput;      // Whether dynamic indices are used in generic output addressing (valid
                                                 // for tessellation control shader)
     ResourceUsage*  m_pResUsage;                // Pointer to shader resource usage
+    uint32_t        m_packInputStageMask;       // Mask of shader stages whose generic inputs are packed together with
+                                                // the generic outputs of the previous stage
     std::unique_ptr<InOutLocationMapManager> m_pLocationMapManager; // Pointer to InOutLocationMapManager instance
 };
 
@@ -166,7 +200,7 @@ class InOutLocationMapManager
 public:
     InOutLocationMapManager() {}
 
-    bool AddSpan(CallInst* pCall);
+    bool AddSpan(CallInst* pCall, ShaderStage shaderStage);
     void BuildLocationMap();
 
     bool FindMap(const InOutLocation& originalLocation, const InOutLocation*& pNewLocation);
@@ -0,0 +1,451 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcPatchScalarLoadCombine.cpp
+ * @brief LLPC source file: contains implementation of class Llpc::PatchScalarLoadCombine.
+ ***********************************************************************************************************************
+ */
+#define DEBUG_TYPE "llpc-patch-scalar-load-combine"
+
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/IntrinsicsAMDGPU.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "llpcIntrinsDefs.h"
+#include "llpcPatchScalarLoadCombine.h"
+
+using namespace Llpc;
+using namespace llvm;
+
+namespace llvm
+{
+
+namespace cl
+{
+
+// -disable-scalar-load-combine: disable combining of uniform loads into wide scalar loads
+static opt<bool> DisableScalarLoadCombine("disable-scalar-load-combine",
+                                          desc("Disable combining of uniform loads into wide scalar loads"),
+                                          init(false));
+
+} // cl
+
+} // llvm
+
+STATISTIC(NumScalarLoadsCombined, "Number of scalar loads combined into wider loads");
+STATISTIC(NumWideScalarLoads, "Number of wide scalar loads created");
+
+namespace Llpc
+{
+
+// Maximum number of dwords in one scalar load (s_buffer_load_dwordx16)
+static const uint32_t MaxScalarLoadDwords = 16;
+
+// =====================================================================================================================
+// Define static members (no initializer needed as LLVM only cares about the address of ID, never its value).
+char PatchScalarLoadCombine::ID;
+
+// =====================================================================================================================
+// Pass creator, creates the pass of LLVM patching operations for combining scalar loads.
+FunctionPass* CreatePatchScalarLoadCombine()
+{
+    return new PatchScalarLoadCombine();
+}
+
+// =====================================================================================================================
+PatchScalarLoadCombine::PatchScalarLoadCombine()
+    :
+    FunctionPass(ID),
+    m_pDomTree(nullptr),
+    m_maxDwords(MaxScalarLoadDwords),
+    m_hoistBudget(UINT32_MAX)
+{
+    initializePatchScalarLoadCombinePass(*PassRegistry::getPassRegistry());
+}
+
+// =====================================================================================================================
+// Get the analysis usage of this pass.
+void PatchScalarLoadCombine::getAnalysisUsage(
+    AnalysisUsage& analysisUsage    // [out] The analysis usage.
+    ) const
+{
+    analysisUsage.addRequired<DominatorTreeWrapperPass>();
+    analysisUsage.setPreservesCFG();
+}
+
+// =====================================================================================================================
+// Executes this LLVM pass on the specified LLVM function.
+bool PatchScalarLoadCombine::runOnFunction(
+    Function& function)     // [in,out] Function that will run this optimization.
+{
+    LLVM_DEBUG(dbgs() << "Run the pass Patch-Scalar-Load-Combine\n");
+
+    if (cl::DisableScalarLoadCombine)
+    {
+        return false;
+    }
+
+    m_pDomTree = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+
+    // Respect the SGPR budget: with a low SGPR limit, use narrower loads and keep fewer SGPRs live across blocks.
+    // This pass runs after the pipeline state has been cleared, so the limit (-sgpr-limit or the shader option) is
+    // taken from the "amdgpu-num-sgpr" attribute that PatchEntryPointMutate sets from it.
+    m_maxDwords = MaxScalarLoadDwords;
+    m_hoistBudget = UINT32_MAX;
+    uint32_t sgprLimit = 0;
+    if (function.hasFnAttribute("amdgpu-num-sgpr"))
+    {
+        function.getFnAttribute("amdgpu-num-sgpr").getValueAsString().getAsInteger(0, sgprLimit);
+    }
+    if (sgprLimit != 0)
+    {
+        m_maxDwords = PowerOf2Floor(std::min(MaxScalarLoadDwords, std::max(4u, sgprLimit / 8)));
+        m_hoistBudget = sgprLimit / 4;
+    }
+
+    for (BasicBlock& block : function)
+    {
+        for (Instruction& inst : block)
+        {
+            CollectScalarLoad(&inst);
+        }
+    }
+
+    bool changed = false;
+    for (ScalarLoadGroup& group : m_groups)
+    {
+        changed |= CombineGroup(group);
+    }
+
+    m_groups.clear();
+    m_groupIndices.clear();
+    return changed;
+}
+
+// =====================================================================================================================
+// Records the specified instruction in its group if it is a scalar load that can be combined.
+void PatchScalarLoadCombine::CollectScalarLoad(
+    Instruction* pInst)   // [in] Instruction to check
+{
+    const DataLayout& dataLayout = pInst->getModule()->getDataLayout();
+    bool isBufferLoad = false;
+    Value* pDesc = nullptr;
+    Value* pBase = nullptr;
+    Value* pCachePolicy = nullptr;
+    int64_t offset = 0;
+
+    if (auto pIntrinsic = dyn_cast<IntrinsicInst>(pInst))
+    {
+        if (pIntrinsic->getIntrinsicID() != Intrinsic::amdgcn_s_buffer_load)
+        {
+            return;
+        }
+
+        isBufferLoad = true;
+        pDesc = pIntrinsic->getArgOperand(0);
+        pCachePolicy = pIntrinsic->getArgOperand(2);
+
+        // Split the offset into a non-constant base and a constant part.
+        Value* pOffset = pIntrinsic->getArgOperand(1);
+        if (auto pConstOffset = dyn_cast<ConstantInt>(pOffset))
+        {
+            offset = pConstOffset->getSExtValue();
+        }
+        else
+        {
+            pBase = pOffset;
+            auto pAdd = dyn_cast<BinaryOperator>(pOffset);
+            if ((pAdd != nullptr) && (pAdd->getOpcode() == Instruction::Add))
+            {
+                if (auto pConstOffset = dyn_cast<ConstantInt>(pAdd->getOperand(1)))
+                {
+                    pBase = pAdd->getOperand(0);
+                    offset = pConstOffset->getSExtValue();
+                }
+                else if (auto pConstOffset = dyn_cast<ConstantInt>(pAdd->getOperand(0)))
+                {
+                    pBase = pAdd->getOperand(1);
+                    offset = pConstOffset->getSExtValue();
+                }
+            }
+        }
+    }
+    else if (auto pLoad = dyn_cast<LoadInst>(pInst))
+    {
+        // Loads from constant memory, such as spilled push constants. Memory in this address space is never written
+        // by the shader, so the load can be moved freely.
+        Type* pLoadTy = pLoad->getType();
+        if ((pLoad->getPointerAddressSpace() != ADDR_SPACE_CONST) ||
+            (pLoad->isSimple() == false) ||
+            ((pLoadTy->isIntOrIntVectorTy() || pLoadTy->isFPOrFPVectorTy()) == false))
+        {
+            return;
+        }
+
+        pDesc = GetPointerBaseWithConstantOffset(pLoad->getPointerOperand(), offset, dataLayout);
+    }
+    else
+    {
+        return;
+    }
+
+    const uint64_t loadSize = dataLayout.getTypeStoreSize(pInst->getType());
+    if ((loadSize == 0) || ((loadSize % 4) != 0) || (loadSize > MaxScalarLoadDwords * 4) || ((offset % 4) != 0))
+    {
+        return;
+    }
+
+    auto key = std::make_tuple(isBufferLoad, pDesc, pBase, pCachePolicy);
+    auto it = m_groupIndices.find(key);
+    if (it == m_groupIndices.end())
+    {
+        it = m_groupIndices.insert({ key, m_groups.size() }).first;
+        m_groups.push_back({ isBufferLoad, pDesc, pBase, pCachePolicy, {} });
+    }
+
+    m_groups[it->second].loads.push_back({ pInst, offset, static_cast<uint32_t>(loadSize / 4) });
+}
+
+// =====================================================================================================================
+// Splits a group of loads into chunks that each fit in one wide load, and combines each chunk. Returns true if
+// anything was changed.
+bool PatchScalarLoadCombine::CombineGroup(
+    ScalarLoadGroup& group) // [in,out] Group of loads from the same descriptor/base
+{
+    if (group.loads.size() < 2)
+    {
+        return false;
+    }
+
+    std::stable_sort(group.loads.begin(),
+                     group.loads.end(),
+                     [](const ScalarLoad& left, const ScalarLoad& right) { return left.offset < right.offset; });
+
+    bool changed = false;
+    ArrayRef<ScalarLoad> loads = group.loads;
+    uint32_t begin = 0;
+    while (begin < loads.size())
+    {
+        // Greedily extend the chunk while it fits in one load and at least half of the loaded dwords are used.
+        const int64_t chunkStart = loads[begin].offset;
+        uint32_t usedMask = ((1u << loads[begin].dwordCount) - 1);
+        uint32_t end = begin + 1;
+        for (; end < loads.size(); ++end)
+        {
+            const uint32_t firstDword = static_cast<uint32_t>((loads[end].offset - chunkStart) / 4);
+            const uint32_t spanDwords = std::max(32 - countLeadingZeros(usedMask),
+                                                 firstDword + loads[end].dwordCount);
+            const uint32_t width = group.isBufferLoad ? PowerOf2Ceil(spanDwords) : spanDwords;
+            if (width > m_maxDwords)
+            {
+                break;
+            }
+
+            const uint32_t newUsedMask = usedMask | (((1u << loads[end].dwordCount) - 1) << firstDword);
+            if (countPopulation(newUsedMask) * 2 < width)
+            {
+                break;
+            }
+            usedMask = newUsedMask;
+        }
+
+        if (end - begin >= 2)
+        {
+            changed |= CombineChunk(group, loads.slice(begin, end - begin));
+        }
+        begin = end;
+    }
+
+    return changed;
+}
+
+// =====================================================================================================================
+// Gets the insert point for the wide load of a chunk: the first of its loads in their nearest common dominator
+// block, or the end of that block. Returns nullptr if the descriptor or base is not available there.
+Instruction* PatchScalarLoadCombine::GetInsertPoint(
+    ScalarLoadGroup&      group,  // [in] Group of loads from the same descriptor/base
+    ArrayRef<ScalarLoad>  chunk   // Loads to combine
+    ) const
+{
+    BasicBlock* pDomBlock = chunk[0].pLoad->getParent();
+    for (const ScalarLoad& load : chunk.drop_front())
+    {
+        pDomBlock = m_pDomTree->findNearestCommonDominator(pDomBlock, load.pLoad->getParent());
+    }
+
+    Instruction* pInsertPoint = nullptr;
+    for (const ScalarLoad& load : chunk)
+    {
+        if ((load.pLoad->getParent() == pDomBlock) &&
+            ((pInsertPoint == nullptr) || m_pDomTree->dominates(load.pLoad, pInsertPoint)))
+        {
+            pInsertPoint = load.pLoad;
+        }
+    }
+    if (pInsertPoint == nullptr)
+    {
+        pInsertPoint = pDomBlock->getTerminator();
+    }
+
+    for (Value* pOperand : { group.pDesc, group.pBase })
+    {
+        auto pOperandInst = dyn_cast_or_null<Instruction>(pOperand);
+        if ((pOperandInst != nullptr) && (m_pDomTree->dominates(pOperandInst, pInsertPoint) == false))
+        {
+            return nullptr;
+        }
+    }
+
+    return pInsertPoint;
+}
+
+// =====================================================================================================================
+// Replaces a chunk of loads with a single wide load. Returns true if the loads were combined.
+bool PatchScalarLoadCombine::CombineChunk(
+    ScalarLoadGroup&      group,  // [in] Group of loads from the same descriptor/base
+    ArrayRef<ScalarLoad>  chunk)  // Loads to combine, sorted by offset
+{
+    Instruction* pInsertPoint = GetInsertPoint(group, chunk);
+    if (pInsertPoint == nullptr)
+    {
+        return false;
+    }
+
+    const int64_t chunkStart = chunk[0].offset;
+    uint32_t spanDwords = 0;
+    bool crossBlock = false;
+    bool allInvariant = true;
+    for (const ScalarLoad& load : chunk)
+    {
+        spanDwords = std::max(spanDwords, static_cast<uint32_t>((load.offset - chunkStart) / 4) + load.dwordCount);
+        crossBlock |= (load.pLoad->getParent() != pInsertPoint->getParent());
+        allInvariant &= (load.pLoad->getMetadata(LLVMContext::MD_invariant_load) != nullptr);
+    }
+    const uint32_t width = group.isBufferLoad ? PowerOf2Ceil(spanDwords) : spanDwords;
+
+    // Hoisting into a dominating block keeps the result live for longer, so it is limited by the SGPR budget.
+    if (crossBlock)
+    {
+        if (width > m_hoistBudget)
+        {
+            return false;
+        }
+        m_hoistBudget -= width;
+    }
+
+    IRBuilder<> builder(pInsertPoint);
+    Type* pWideTy = (width == 1) ? builder.getInt32Ty() : VectorType::get(builder.getInt32Ty(), width);
+
+    Instruction* pWideLoad = nullptr;
+    if (group.isBufferLoad)
+    {
+        Value* pOffset = builder.getInt32(chunkStart);
+        if (group.pBase != nullptr)
+        {
+            pOffset = (chunkStart == 0) ? group.pBase : builder.CreateAdd(group.pBase, pOffset);
+        }
+        pWideLoad = builder.CreateIntrinsic(Intrinsic::amdgcn_s_buffer_load,
+                                            pWideTy,
+                                            { group.pDesc, pOffset, group.pCachePolicy });
+    }
+    else
+    {
+        const uint32_t addrSpace = group.pDesc->getType()->getPointerAddressSpace();
+        Value* pPointer = builder.CreateBitCast(group.pDesc, builder.getInt8PtrTy(addrSpace));
+        pPointer = builder.CreateConstInBoundsGEP1_64(builder.getInt8Ty(), pPointer, chunkStart);
+        pPointer = builder.CreateBitCast(pPointer, pWideTy->getPointerTo(addrSpace));
+
+        // NOTE: The wide load must not claim the ABI alignment of its vector type, only what is known of the
+        // address of the first load. That is its explicit alignment, or else the ABI alignment of a dword.
+        uint32_t alignment = cast<LoadInst>(chunk[0].pLoad)->getAlignment();
+        if (alignment == 0)
+        {
+            alignment = pInsertPoint->getModule()->getDataLayout().getABITypeAlignment(builder.getInt32Ty());
+        }
+        alignment = static_cast<uint32_t>(MinAlign(alignment, chunkStart));
+        auto pLoad = builder.CreateAlignedLoad(pWideTy, pPointer, alignment);
+        if (allInvariant)
+        {
+            pLoad->setMetadata(LLVMContext::MD_invariant_load, MDNode::get(pLoad->getContext(), None));
+        }
+        pWideLoad = pLoad;
+    }
+
+    LLVM_DEBUG(dbgs() << "Combine " << chunk.size() << " scalar loads into: " << *pWideLoad << "\n");
+
+    // Extract the value of each original load from the wide load.
+    for (const ScalarLoad& load : chunk)
+    {
+        const uint32_t firstDword = static_cast<uint32_t>((load.offset - chunkStart) / 4);
+        builder.SetInsertPoint(load.pLoad);
+
+        Value* pValue = pWideLoad;
+        if (load.dwordCount == 1)
+        {
+            if (width != 1)
+            {
+                pValue = builder.CreateExtractElement(pWideLoad, firstDword);
+            }
+        }
+        else if (load.dwordCount != width)
+        {
+            SmallVector<uint32_t, MaxScalarLoadDwords> shuffleMask;
+            for (uint32_t i = 0; i < load.dwordCount; ++i)
+            {
+                shuffleMask.push_back(firstDword + i);
+            }
+            pValue = builder.CreateShuffleVector(pWideLoad, UndefValue::get(pWideTy), shuffleMask);
+        }
+
+        if (pValue->getType() != load.pLoad->getType())
+        {
+            pValue = builder.CreateBitCast(pValue, load.pLoad->getType());
+        }
+
+        pValue->takeName(load.pLoad);
+        load.pLoad->replaceAllUsesWith(pValue);
+        load.pLoad->eraseFromParent();
+    }
+
+    NumScalarLoadsCombined += chunk.size();
+    ++NumWideScalarLoads;
+    return true;
+}
+
+} // Llpc
+
+// =====================================================================================================================
+// Initializes the pass of LLVM patching operations for combining scalar loads.
+INITIALIZE_PASS_BEGIN(PatchScalarLoadCombine, DEBUG_TYPE,
+                      "Patch LLVM for combining scalar loads", false, false)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_END(PatchScalarLoadCombine, DEBUG_TYPE,
+                    "Patch LLVM for combining scalar loads", false, false)
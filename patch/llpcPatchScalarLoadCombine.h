@@ -0,0 +1,104 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcPatchScalarLoadCombine.h
+ * @brief LLPC header file: contains declaration of class Llpc::PatchScalarLoadCombine.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Dominators.h"
+
+#include <map>
+#include <tuple>
+#include <vector>
+#include "llpcPatch.h"
+
+namespace Llpc
+{
+
+// =====================================================================================================================
+// Represents the pass of LLVM patching operations for combining scalar loads.
+//
+// Uniform buffer reads that PatchBufferOp has turned into llvm.amdgcn.s.buffer.load, and reads of constant memory
+// (such as spilled push constants), are gathered per descriptor/base across the whole shader. Loads close enough
+// together are replaced by the minimal set of wide loads (up to s_buffer_load_dwordx16), placed at a point that
+// dominates all of them, with the original values extracted from the wide result.
+//
+// This runs just before instruction selection, so that no middle-end optimization splits the wide loads again.
+//
+class PatchScalarLoadCombine final:
+    public llvm::FunctionPass
+{
+public:
+    PatchScalarLoadCombine();
+
+    void getAnalysisUsage(llvm::AnalysisUsage& analysisUsage) const override;
+    bool runOnFunction(llvm::Function& function) override;
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    static char ID;   // ID of this pass
+
+private:
+    LLPC_DISALLOW_COPY_AND_ASSIGN(PatchScalarLoadCombine);
+
+    // A load that is a candidate for combining
+    struct ScalarLoad
+    {
+        llvm::Instruction*  pLoad;        // The s.buffer.load call or the load instruction
+        int64_t             offset;       // Byte offset from the base of its group
+        uint32_t            dwordCount;   // Size of the loaded value in dwords
+    };
+
+    // Loads from the same descriptor/base, that are combined together
+    struct ScalarLoadGroup
+    {
+        bool                                isBufferLoad;   // Whether these are llvm.amdgcn.s.buffer.load calls
+        llvm::Value*                        pDesc;          // Buffer descriptor (s.buffer.load) or base pointer (load)
+        llvm::Value*                        pBase;          // Non-constant part of the offset, or nullptr
+        llvm::Value*                        pCachePolicy;   // Cache policy operand (s.buffer.load only)
+        llvm::SmallVector<ScalarLoad, 8>    loads;          // Loads in the group
+    };
+
+    void CollectScalarLoad(llvm::Instruction* pInst);
+    bool CombineGroup(ScalarLoadGroup& group);
+    bool CombineChunk(ScalarLoadGroup& group, llvm::ArrayRef<ScalarLoad> chunk);
+    llvm::Instruction* GetInsertPoint(ScalarLoadGroup& group, llvm::ArrayRef<ScalarLoad> chunk) const;
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    std::vector<ScalarLoadGroup>                            m_groups;         // Groups of candidate loads
+    std::map<std::tuple<bool, llvm::Value*, llvm::Value*, llvm::Value*>, uint32_t>
+                                                            m_groupIndices;   // Map from group key to index in m_groups
+    llvm::DominatorTree*                                    m_pDomTree;       // Dominator tree of the function
+    uint32_t                                                m_maxDwords;      // Maximum width of a combined load
+    uint32_t                                                m_hoistBudget;    // Remaining SGPRs that may be kept
+                                                                              //   live by hoisting across blocks
+};
+
+} // Llpc
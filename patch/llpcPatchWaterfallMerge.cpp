@@ -0,0 +1,475 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcPatchWaterfallMerge.cpp
+ * @brief LLPC source file: contains implementation of class Llpc::PatchWaterfallMerge.
+ ***********************************************************************************************************************
+ */
+#define DEBUG_TYPE "llpc-patch-waterfall-merge"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/IntrinsicsAMDGPU.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Local.h"
+
+#include "llpcPatchWaterfallMerge.h"
+
+using namespace Llpc;
+using namespace llvm;
+
+STATISTIC(NumWaterfallLoopsMerged, "Number of waterfall loops merged into a preceding loop");
+STATISTIC(NumWaterfallInstsHoisted, "Number of instructions hoisted above a merged waterfall loop");
+
+namespace Llpc
+{
+
+// =====================================================================================================================
+// Define static members (no initializer needed as LLVM only cares about the address of ID, never its value).
+char PatchWaterfallMerge::ID;
+
+// =====================================================================================================================
+// Pass creator, creates the pass of LLVM patching operations for merging waterfall loops.
+FunctionPass* CreatePatchWaterfallMerge()
+{
+    return new PatchWaterfallMerge();
+}
+
+// =====================================================================================================================
+PatchWaterfallMerge::PatchWaterfallMerge()
+    :
+    FunctionPass(ID)
+{
+    initializePatchWaterfallMergePass(*PassRegistry::getPassRegistry());
+}
+
+// =====================================================================================================================
+// Specify what analysis passes this pass depends on.
+void PatchWaterfallMerge::getAnalysisUsage(
+    AnalysisUsage& analysisUsage // [in,out] The place to record our analysis pass usage requirements.
+    ) const
+{
+    analysisUsage.setPreservesCFG();
+}
+
+// =====================================================================================================================
+// Executes this LLVM pass on the specified LLVM function.
+bool PatchWaterfallMerge::runOnFunction(
+    Function& function)     // [in,out] Function that will run this optimization.
+{
+    LLVM_DEBUG(dbgs() << "Run the pass Patch-Waterfall-Merge\n");
+
+    // Bail out quickly if the module contains no waterfall loop at all.
+    bool hasWaterfall = false;
+    for (const Function& decl : *function.getParent())
+    {
+        if ((decl.getIntrinsicID() == Intrinsic::amdgcn_waterfall_begin) && (decl.use_empty() == false))
+        {
+            hasWaterfall = true;
+            break;
+        }
+    }
+    if (hasWaterfall == false)
+    {
+        return false;
+    }
+
+    bool changed = false;
+    for (BasicBlock& block : function)
+    {
+        // Each successful merge invalidates the region positions of the block, so rescan it after every merge.
+        while (MergeInBlock(block))
+        {
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+// =====================================================================================================================
+// Tries to merge one pair of adjacent waterfall loops in the specified basic block. Returns true if a merge happened.
+bool PatchWaterfallMerge::MergeInBlock(
+    BasicBlock& block)  // [in,out] Basic block to process
+{
+    DenseMap<const Instruction*, uint32_t> positions;
+    SmallVector<CallInst*, 8> begins;
+    uint32_t position = 0;
+    for (Instruction& inst : block)
+    {
+        positions[&inst] = position++;
+        if (auto pIntrinsic = dyn_cast<IntrinsicInst>(&inst))
+        {
+            if (pIntrinsic->getIntrinsicID() == Intrinsic::amdgcn_waterfall_begin)
+            {
+                begins.push_back(pIntrinsic);
+            }
+        }
+    }
+
+    if (begins.size() < 2)
+    {
+        return false;
+    }
+
+    // Gets the last instruction of the waterfall region started by the specified begin, or nullptr if the region
+    // does not end in this block. A store in a waterfall loop has no llvm.amdgcn.waterfall.end; the loop instead
+    // extends over the users of its llvm.amdgcn.waterfall.last.use.
+    auto getRegionEnd = [&](CallInst* pBegin) -> Instruction*
+    {
+        Instruction* pRegionEnd = pBegin;
+        SmallVector<Instruction*, 8> regionInsts;
+        for (User* pUser : pBegin->users())
+        {
+            auto pUserInst = dyn_cast<Instruction>(pUser);
+            if (pUserInst == nullptr)
+            {
+                return nullptr;
+            }
+            regionInsts.push_back(pUserInst);
+
+            auto pIntrinsic = dyn_cast<IntrinsicInst>(pUserInst);
+            if ((pIntrinsic != nullptr) && (pIntrinsic->getIntrinsicID() == Intrinsic::amdgcn_waterfall_last_use))
+            {
+                for (User* pLastUser : pIntrinsic->users())
+                {
+                    auto pLastUserInst = dyn_cast<Instruction>(pLastUser);
+                    if (pLastUserInst == nullptr)
+                    {
+                        return nullptr;
+                    }
+                    regionInsts.push_back(pLastUserInst);
+                }
+            }
+        }
+
+        for (Instruction* pRegionInst : regionInsts)
+        {
+            if (pRegionInst->getParent() != &block)
+            {
+                return nullptr;
+            }
+            if (positions[pRegionInst] > positions[pRegionEnd])
+            {
+                pRegionEnd = pRegionInst;
+            }
+        }
+        return pRegionEnd;
+    };
+
+    for (uint32_t i = 0; i + 1 < begins.size(); ++i)
+    {
+        CallInst* pLeader = begins[i];
+        CallInst* pNext = begins[i + 1];
+        if (pLeader->getType() != pNext->getType())
+        {
+            continue;
+        }
+
+        Instruction* pLeaderEnd = getRegionEnd(pLeader);
+        Instruction* pNextEnd = getRegionEnd(pNext);
+        if ((pLeaderEnd == nullptr) || (pNextEnd == nullptr) || (positions[pLeaderEnd] > positions[pNext]))
+        {
+            // Region leaves the block, or regions are interleaved.
+            continue;
+        }
+
+        SmallVector<Value*, 2> leaderKey;
+        SmallVector<Value*, 2> nextKey;
+        GetWaterfallIndexKey(pLeader, leaderKey);
+        GetWaterfallIndexKey(pNext, nextKey);
+        if (leaderKey != nextKey)
+        {
+            continue;
+        }
+
+        if (TryMerge(pLeader, pLeaderEnd, pNext, pNextEnd))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// =====================================================================================================================
+// Tries to merge the waterfall loop started by pNext into the immediately preceding loop started by pLeader, both
+// keyed on the same non-uniform index.
+//
+// Code between the two loops becomes part of the merged loop. It is classified as follows:
+// - Code that consumes a result of the leading loop is sunk below the merged loop (it must be side-effect free).
+// - Side-effect free code that does not depend on the leading loop (such as the descriptor load and address
+//   calculation of the later operation) is hoisted above the merged loop.
+// - Everything else stays in the merged loop, which is fine as long as it has no side effect and is not convergent.
+//
+// Returns true if the loops were merged.
+bool PatchWaterfallMerge::TryMerge(
+    CallInst*    pLeader,     // [in] llvm.amdgcn.waterfall.begin of the leading loop
+    Instruction* pLeaderEnd,  // [in] Last instruction of the leading loop
+    CallInst*    pNext,       // [in] llvm.amdgcn.waterfall.begin of the following loop
+    Instruction* pNextEnd)    // [in] Last instruction of the following loop
+{
+    // Values defined inside the merged loop, which cannot be hoisted above it.
+    SmallPtrSet<const Value*, 16> loopDefs;
+    // Values that are only valid once the merged loop has ended, i.e. results of the leading loop.
+    SmallPtrSet<const Value*, 8> loopResults;
+
+    for (Instruction* pInst = pLeader; pInst != pLeaderEnd->getNextNode(); pInst = pInst->getNextNode())
+    {
+        loopDefs.insert(pInst);
+    }
+    for (User* pUser : pLeader->users())
+    {
+        auto pIntrinsic = dyn_cast<IntrinsicInst>(pUser);
+        if ((pIntrinsic != nullptr) && (pIntrinsic->getIntrinsicID() == Intrinsic::amdgcn_waterfall_end))
+        {
+            loopResults.insert(pIntrinsic);
+        }
+    }
+
+    auto usesAnyOf = [](const Instruction* pInst, const SmallPtrSetImpl<const Value*>& values)
+    {
+        for (const Value* pOperand : pInst->operands())
+        {
+            if (values.count(pOperand) != 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    SmallVector<Instruction*, 16> instsToHoist;
+    SmallVector<Instruction*, 8> instsToSink;
+
+    for (Instruction* pInst = pLeaderEnd->getNextNode(); pInst != pNextEnd->getNextNode(); pInst = pInst->getNextNode())
+    {
+        if (pInst == pNext)
+        {
+            loopDefs.insert(pInst);
+            continue;
+        }
+
+        if (IsWaterfallIntrinsic(pInst))
+        {
+            if ((pInst->getOperand(0) != pNext) || usesAnyOf(pInst, loopResults))
+            {
+                return false;
+            }
+            loopDefs.insert(pInst);
+            continue;
+        }
+
+        if (usesAnyOf(pInst, loopResults))
+        {
+            // Consumer of a result of the leading loop: it can only be sunk below the merged loop.
+            if (pInst->mayHaveSideEffects() || pInst->mayReadFromMemory() || isa<PHINode>(pInst) ||
+                pInst->isTerminator() || usesAnyOf(pInst, loopDefs))
+            {
+                return false;
+            }
+            loopResults.insert(pInst);
+            instsToSink.push_back(pInst);
+            continue;
+        }
+
+        if (auto pCall = dyn_cast<CallInst>(pInst))
+        {
+            if (pCall->isConvergent() || pCall->isInlineAsm())
+            {
+                // Cross-lane operations give different results when run with the reduced EXEC of a loop iteration.
+                return false;
+            }
+        }
+
+        const bool usesLoopDef = usesAnyOf(pInst, loopDefs);
+        if (usesLoopDef == false)
+        {
+            const bool isInvariantLoad = isa<LoadInst>(pInst) &&
+                                         (pInst->getMetadata(LLVMContext::MD_invariant_load) != nullptr);
+            if ((pInst->mayHaveSideEffects() == false) &&
+                ((pInst->mayReadFromMemory() == false) || isInvariantLoad) &&
+                (isa<PHINode>(pInst) == false) &&
+                (isa<AllocaInst>(pInst) == false))
+            {
+                instsToHoist.push_back(pInst);
+                continue;
+            }
+
+            // An unrelated side effect between the two loops would be repeated per loop iteration.
+            if (pInst->mayHaveSideEffects())
+            {
+                return false;
+            }
+        }
+
+        loopDefs.insert(pInst);
+    }
+
+    LLVM_DEBUG(dbgs() << "Merge waterfall loop: " << *pNext << "\n  into: " << *pLeader << "\n");
+
+    for (Instruction* pInst : instsToHoist)
+    {
+        pInst->moveBefore(pLeader);
+    }
+    NumWaterfallInstsHoisted += instsToHoist.size();
+
+    Instruction* pSinkPoint = pNextEnd->getNextNode();
+    for (Instruction* pInst : instsToSink)
+    {
+        pInst->moveBefore(pSinkPoint);
+    }
+
+    Value* pNextIndex = pNext->getArgOperand(0);
+    pNext->replaceAllUsesWith(pLeader);
+    pNext->eraseFromParent();
+    RecursivelyDeleteTriviallyDeadInstructions(pNextIndex);
+
+    RemoveRedundantReadFirstLanes(pLeader);
+
+    ++NumWaterfallLoopsMerged;
+    return true;
+}
+
+// =====================================================================================================================
+// Removes llvm.amdgcn.waterfall.readfirstlane calls in the specified loop that scalarize the same value as an
+// earlier one, such as the same descriptor used by two operations of a merged loop.
+void PatchWaterfallMerge::RemoveRedundantReadFirstLanes(
+    CallInst* pBegin)   // [in] llvm.amdgcn.waterfall.begin of the loop
+{
+    DenseMap<Value*, Instruction*> readFirstLanes;
+    SmallVector<Instruction*, 4> deadInsts;
+    uint32_t remainingUsers = pBegin->getNumUses();
+
+    for (Instruction* pInst = pBegin->getNextNode(); (pInst != nullptr) && (remainingUsers != 0);
+         pInst = pInst->getNextNode())
+    {
+        auto pIntrinsic = dyn_cast<IntrinsicInst>(pInst);
+        if ((pIntrinsic == nullptr) || (pIntrinsic->getArgOperand(0) != pBegin))
+        {
+            continue;
+        }
+        --remainingUsers;
+
+        if (pIntrinsic->getIntrinsicID() != Intrinsic::amdgcn_waterfall_readfirstlane)
+        {
+            continue;
+        }
+
+        auto& pFirst = readFirstLanes[pIntrinsic->getArgOperand(1)];
+        if ((pFirst != nullptr) && (pFirst->getType() == pIntrinsic->getType()))
+        {
+            pIntrinsic->replaceAllUsesWith(pFirst);
+            deadInsts.push_back(pIntrinsic);
+        }
+        else if (pFirst == nullptr)
+        {
+            pFirst = pIntrinsic;
+        }
+    }
+
+    for (Instruction* pInst : deadInsts)
+    {
+        pInst->eraseFromParent();
+    }
+}
+
+// =====================================================================================================================
+// Gets the key identifying the non-uniform index of a waterfall loop. If the index is a struct built up by
+// "insertvalue" (the image resource+sampler case), the key is the list of inserted values; otherwise it is the
+// index itself.
+void PatchWaterfallMerge::GetWaterfallIndexKey(
+    CallInst*               pBegin, // [in] llvm.amdgcn.waterfall.begin call
+    SmallVectorImpl<Value*>& key)   // [out] Key of the waterfall index
+{
+    Value* pIndex = pBegin->getArgOperand(0);
+    key.clear();
+
+    auto pStructTy = dyn_cast<StructType>(pIndex->getType());
+    if (pStructTy != nullptr)
+    {
+        key.resize(pStructTy->getNumElements(), nullptr);
+        Value* pAggregate = pIndex;
+        while (auto pInsertValue = dyn_cast<InsertValueInst>(pAggregate))
+        {
+            if (pInsertValue->getNumIndices() != 1)
+            {
+                break;
+            }
+            auto& pElement = key[pInsertValue->getIndices()[0]];
+            if (pElement == nullptr)
+            {
+                pElement = pInsertValue->getInsertedValueOperand();
+            }
+            pAggregate = pInsertValue->getAggregateOperand();
+        }
+
+        bool complete = isa<UndefValue>(pAggregate);
+        for (Value* pElement : key)
+        {
+            complete = complete && (pElement != nullptr);
+        }
+        if (complete)
+        {
+            return;
+        }
+        key.clear();
+    }
+
+    key.push_back(pIndex);
+}
+
+// =====================================================================================================================
+// Checks whether the specified value is one of the waterfall intrinsics that refer to a llvm.amdgcn.waterfall.begin.
+bool PatchWaterfallMerge::IsWaterfallIntrinsic(
+    const Value* pValue)   // [in] Value to check
+{
+    if (auto pIntrinsic = dyn_cast<IntrinsicInst>(pValue))
+    {
+        switch (pIntrinsic->getIntrinsicID())
+        {
+        case Intrinsic::amdgcn_waterfall_readfirstlane:
+        case Intrinsic::amdgcn_waterfall_end:
+        case Intrinsic::amdgcn_waterfall_last_use:
+            return true;
+        default:
+            break;
+        }
+    }
+    return false;
+}
+
+} // Llpc
+
+// =====================================================================================================================
+// Initializes the pass of LLVM patching operations for merging waterfall loops.
+INITIALIZE_PASS(PatchWaterfallMerge, DEBUG_TYPE,
+                "Patch LLVM for merging adjacent waterfall loops", false, false)
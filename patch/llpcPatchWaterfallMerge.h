@@ -0,0 +1,84 @@
+/*
+ ***********************************************************************************************************************
+ *
+ *  Copyright (c) 2019 Advanced Micro Devices, Inc. All Rights Reserved.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ **********************************************************************************************************************/
+/**
+ ***********************************************************************************************************************
+ * @file  llpcPatchWaterfallMerge.h
+ * @brief LLPC header file: contains declaration of class Llpc::PatchWaterfallMerge.
+ ***********************************************************************************************************************
+ */
+#pragma once
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Pass.h"
+
+#include "llpc.h"
+#include "llpcDebug.h"
+
+namespace llvm
+{
+
+class CallInst;
+class PassRegistry;
+void initializePatchWaterfallMergePass(PassRegistry&);
+
+} // llvm
+
+namespace Llpc
+{
+
+// =====================================================================================================================
+// Represents the pass of LLVM patching operations for merging adjacent waterfall loops.
+//
+// Each non-uniform image or buffer operation is wrapped in its own llvm.amdgcn.waterfall.begin/end loop when the
+// Builder creates it. When several such loops in one basic block are keyed on the same non-uniform index, this pass
+// merges them into a single loop, hoists side-effect-free code between them (such as the descriptor loads of the
+// later operations) above the merged loop, and sinks code that consumes the results of an earlier loop below it.
+//
+class PatchWaterfallMerge final:
+    public llvm::FunctionPass
+{
+public:
+    PatchWaterfallMerge();
+
+    bool runOnFunction(llvm::Function& function) override;
+    void getAnalysisUsage(llvm::AnalysisUsage& analysisUsage) const override;
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    static char ID;   // ID of this pass
+
+private:
+    LLPC_DISALLOW_COPY_AND_ASSIGN(PatchWaterfallMerge);
+
+    bool MergeInBlock(llvm::BasicBlock& block);
+    bool TryMerge(llvm::CallInst* pLeader, llvm::Instruction* pLeaderEnd, llvm::CallInst* pNext,
+                  llvm::Instruction* pNextEnd);
+    void RemoveRedundantReadFirstLanes(llvm::CallInst* pBegin);
+
+    static void GetWaterfallIndexKey(llvm::CallInst* pBegin, llvm::SmallVectorImpl<llvm::Value*>& key);
+    static bool IsWaterfallIntrinsic(const llvm::Value* pValue);
+};
+
+} // Llpc
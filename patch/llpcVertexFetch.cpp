@@ -33,6 +33,7 @@
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
 
 #include "llpcContext.h"
 #include "llpcDebug.h"
@@ -40,9 +41,16 @@
 #include "llpcSystemValues.h"
 #include "llpcTargetInfo.h"
 #include "llpcVertexFetch.h"
+#include <algorithm>
 
 using namespace llvm;
 
+// -disable-vertex-fetch-coalesce: disable coalescing adjacent vertex attributes of one binding into wide loads
+static cl::opt<bool> DisableVertexFetchCoalesce("disable-vertex-fetch-coalesce",
+                                                cl::desc("Disable coalescing adjacent vertex attributes of one "
+                                                         "binding into wide loads"),
+                                                cl::init(false));
+
 namespace Llpc
 {
 
@@ -1106,6 +1114,13 @@ VertexFetch::VertexFetch(
         m_pInstanceIndex = BinaryOperator::CreateAdd(m_pBaseInstance, m_pInstanceId, "", &*pInsertPos);
     }
 
+    // Later instructions that must dominate all vertex fetches are inserted here, after the index calculations.
+    m_pEntryInsertPos = &*pInsertPos;
+    if ((m_pVertexInput != nullptr) && (DisableVertexFetchCoalesce == false))
+    {
+        BuildFetchGroups();
+    }
+
     // Initialize default fetch values
     auto pZero = ConstantInt::get(m_pContext->Int32Ty(), 0);
     auto pOne = ConstantInt::get(m_pContext->Int32Ty(), 1);
@@ -1211,17 +1226,25 @@ Value* VertexFetch::Run(
     const bool is8bitFetch = (pInputTy->getScalarSizeInBits() == 8);
     const bool is16bitFetch = (pInputTy->getScalarSizeInBits() == 16);
 
-    // Do the first vertex fetch operation
-    AddVertexFetchInst(pVbDesc,
-                       pFormatInfo->numChannels,
-                       is16bitFetch,
-                       pVbIndex,
-                       pAttrib->offset,
-                       pBinding->stride,
-                       pFormatInfo->dfmt,
-                       pFormatInfo->nfmt,
-                       pInsertPos,
-                       &vertexFetch[0]);
+    // Do the first vertex fetch operation, from the wide load of its group if the attribute is coalesced with others
+    auto groupIt = m_locationGroupMap.find(location);
+    if ((groupIt != m_locationGroupMap.end()) && (is8bitFetch == false) && (is16bitFetch == false))
+    {
+        vertexFetch[0] = FetchFromGroup(&m_fetchGroups[groupIt->second], pBinding, pAttrib, pFormatInfo->numChannels);
+    }
+    else
+    {
+        AddVertexFetchInst(pVbDesc,
+                           pFormatInfo->numChannels,
+                           is16bitFetch,
+                           pVbIndex,
+                           pAttrib->offset,
+                           pBinding->stride,
+                           pFormatInfo->dfmt,
+                           pFormatInfo->nfmt,
+                           pInsertPos,
+                           &vertexFetch[0]);
+    }
 
     // Do post-processing in certain cases
     std::vector<Constant*> shuffleMask;
@@ -1987,4 +2010,161 @@ bool VertexFetch::NeedSecondVertexFetch(
             (format == VK_FORMAT_R64G64B64A64_SFLOAT));
 }
 
+// =====================================================================================================================
+// Groups adjacent vertex attributes of one binding, so that each group is fetched by a single wide untyped load
+// (buffer_load_dwordx2/x4) instead of one typed fetch per attribute.
+//
+// NOTE: Only attributes of 32-bit integer or float formats are grouped: their fetch results are the raw dwords, so
+// they can be taken out of a wide load without conversion. Attributes must be dword-aligned and lie within one vertex
+// stride, so that no vertex buffer index adjustment is needed.
+void VertexFetch::BuildFetchGroups()
+{
+    struct AttribRange
+    {
+        uint32_t offset;        // Byte offset of the attribute
+        uint32_t dwordCount;    // Dword count of the attribute
+        uint32_t location;      // Location of the attribute
+    };
+
+    for (uint32_t bindingIdx = 0; bindingIdx < m_pVertexInput->vertexBindingDescriptionCount; ++bindingIdx)
+    {
+        const auto pBinding = &m_pVertexInput->pVertexBindingDescriptions[bindingIdx];
+        if ((pBinding->stride % sizeof(uint32_t)) != 0)
+        {
+            continue;
+        }
+
+        // Skip bindings with a vertex divisor, whose buffer index is calculated at each fetch
+        bool hasDivisor = false;
+        for (uint32_t i = 0; (m_pVertexDivisor != nullptr) && (i < m_pVertexDivisor->vertexBindingDivisorCount); ++i)
+        {
+            hasDivisor |= (m_pVertexDivisor->pVertexBindingDivisors[i].binding == pBinding->binding);
+        }
+        if (hasDivisor)
+        {
+            continue;
+        }
+
+        // Collect attributes of this binding that are able to be grouped
+        std::vector<AttribRange> attribs;
+        for (uint32_t i = 0; i < m_pVertexInput->vertexAttributeDescriptionCount; ++i)
+        {
+            const auto pAttrib = &m_pVertexInput->pVertexAttributeDescriptions[i];
+            if (pAttrib->binding != pBinding->binding)
+            {
+                continue;
+            }
+
+            const VertexFormatInfo* pFormatInfo = GetVertexFormatInfo(pAttrib->format);
+            const VertexCompFormatInfo* pCompFormatInfo = GetVertexComponentFormatInfo(pFormatInfo->dfmt);
+            const uint32_t byteSize = pCompFormatInfo->vertexByteSize;
+
+            if ((pCompFormatInfo->compDfmt == BUF_DATA_FORMAT_32) &&
+                (pCompFormatInfo->compCount == pFormatInfo->numChannels) &&
+                ((pFormatInfo->nfmt == BUF_NUM_FORMAT_UINT) ||
+                 (pFormatInfo->nfmt == BUF_NUM_FORMAT_SINT) ||
+                 (pFormatInfo->nfmt == BUF_NUM_FORMAT_FLOAT)) &&
+                (NeedSecondVertexFetch(pAttrib->format) == false) &&
+                ((pAttrib->offset % sizeof(uint32_t)) == 0) &&
+                ((pBinding->stride == 0) || (pAttrib->offset + byteSize <= pBinding->stride)))
+            {
+                attribs.push_back({ pAttrib->offset, byteSize / uint32_t(sizeof(uint32_t)), pAttrib->location });
+            }
+        }
+
+        std::sort(attribs.begin(),
+                  attribs.end(),
+                  [](const AttribRange& left, const AttribRange& right) { return left.offset < right.offset; });
+
+        // Greedily form groups of contiguous attributes. Only 2 and 4 dwords are allowed, as dwordx3 loads are not
+        // available on all hardware.
+        uint32_t first = 0;
+        while (first < attribs.size())
+        {
+            uint32_t last = first;
+            uint32_t dwordCount = attribs[first].dwordCount;
+            while ((last + 1 < attribs.size()) &&
+                   (attribs[last + 1].offset == attribs[last].offset + attribs[last].dwordCount * sizeof(uint32_t)) &&
+                   (dwordCount + attribs[last + 1].dwordCount <= 4))
+            {
+                ++last;
+                dwordCount += attribs[last].dwordCount;
+            }
+
+            while ((dwordCount == 3) && (last > first))
+            {
+                dwordCount -= attribs[last].dwordCount;
+                --last;
+            }
+
+            if ((last > first) && ((dwordCount == 2) || (dwordCount == 4)))
+            {
+                const uint32_t groupIdx = m_fetchGroups.size();
+                m_fetchGroups.push_back({ pBinding->binding, attribs[first].offset, dwordCount, nullptr });
+                for (uint32_t i = first; i <= last; ++i)
+                {
+                    m_locationGroupMap[attribs[i].location] = groupIdx;
+                }
+                first = last + 1;
+            }
+            else
+            {
+                ++first;
+            }
+        }
+    }
+}
+
+// =====================================================================================================================
+// Gets the fetch result of a grouped vertex attribute out of the wide load of its group, which is done on first use.
+Value* VertexFetch::FetchFromGroup(
+    VertexFetchGroup*                        pGroup,        // [in/out] Fetch group of the attribute
+    const VkVertexInputBindingDescription*   pBinding,      // [in] Vertex binding
+    const VkVertexInputAttributeDescription* pAttrib,       // [in] Vertex attribute
+    uint32_t                                 numChannels)   // Valid number of channels of the attribute
+{
+    if (pGroup->pFetch == nullptr)
+    {
+        // NOTE: The wide load is inserted in the entry block, so that it dominates all fetches of the group.
+        Value* pVbIndex = (pBinding->inputRate == VK_VERTEX_INPUT_RATE_VERTEX) ? GetVertexIndex() : GetInstanceIndex();
+        Value* args[] = {
+            LoadVertexBufferDescriptor(pGroup->binding, m_pEntryInsertPos), // rsrc
+            pVbIndex,                                                       // vindex
+            ConstantInt::get(m_pContext->Int32Ty(), pGroup->offset),        // offset
+            ConstantInt::get(m_pContext->Int32Ty(), 0),                     // soffset
+            ConstantInt::get(m_pContext->Int32Ty(), 0)                      // glc, slc
+        };
+
+        LLPC_ASSERT((pGroup->dwordCount == 2) || (pGroup->dwordCount == 4));
+        pGroup->pFetch = EmitCall((pGroup->dwordCount == 2) ? "llvm.amdgcn.struct.buffer.load.v2i32" :
+                                                              "llvm.amdgcn.struct.buffer.load.v4i32",
+                                  VectorType::get(m_pContext->Int32Ty(), pGroup->dwordCount),
+                                  args,
+                                  NoAttrib,
+                                  m_pEntryInsertPos);
+    }
+
+    const uint32_t firstDword = (pAttrib->offset - pGroup->offset) / sizeof(uint32_t);
+    LLPC_ASSERT(firstDword + numChannels <= pGroup->dwordCount);
+
+    if (numChannels == 1)
+    {
+        return ExtractElementInst::Create(pGroup->pFetch,
+                                          ConstantInt::get(m_pContext->Int32Ty(), firstDword),
+                                          "",
+                                          m_pEntryInsertPos);
+    }
+
+    std::vector<Constant*> shuffleMask;
+    for (uint32_t i = 0; i < numChannels; ++i)
+    {
+        shuffleMask.push_back(ConstantInt::get(m_pContext->Int32Ty(), firstDword + i));
+    }
+    return new ShuffleVectorInst(pGroup->pFetch,
+                                 pGroup->pFetch,
+                                 ConstantVector::get(shuffleMask),
+                                 "",
+                                 m_pEntryInsertPos);
+}
+
 } // Llpc
@@ -30,6 +30,7 @@
  */
 #pragma once
 
+#include <map>
 #include "llpcInternal.h"
 #include "llpcIntrinsDefs.h"
 
@@ -62,6 +63,15 @@ struct VertexCompFormatInfo
     BufDataFormat   compDfmt;       // Equivalent data format of each component
 };
 
+// Represents a group of adjacent vertex attributes of one binding that are fetched by a single wide untyped load.
+struct VertexFetchGroup
+{
+    uint32_t        binding;        // Vertex binding shared by the attributes
+    uint32_t        offset;         // Byte offset of the first attribute
+    uint32_t        dwordCount;     // Total dword count of the attributes (2 or 4)
+    llvm::Value*    pFetch;         // Result of the wide load (<n x i32>), created on first use
+};
+
 // =====================================================================================================================
 // Represents the manager of vertex fetch operations.
 class VertexFetch
@@ -111,6 +121,13 @@ private:
 
     bool NeedSecondVertexFetch(VkFormat format) const;
 
+    void BuildFetchGroups();
+
+    llvm::Value* FetchFromGroup(VertexFetchGroup*                        pGroup,
+                                const VkVertexInputBindingDescription*   pBinding,
+                                const VkVertexInputAttributeDescription* pAttrib,
+                                uint32_t                                 numChannels);
+
     // -----------------------------------------------------------------------------------------------------------------
 
     llvm::Module*       m_pModule;          // LLVM module
@@ -126,6 +143,11 @@ private:
     llvm::Value*    m_pBaseInstance;    // Base instance
     llvm::Value*    m_pInstanceId;      // Instance ID
 
+    llvm::Instruction*              m_pEntryInsertPos;  // Insert position in the entry block, after the vertex and
+                                                        //  instance index calculations
+    std::vector<VertexFetchGroup>   m_fetchGroups;      // Groups of attributes fetched by a single wide load
+    std::map<uint32_t, uint32_t>    m_locationGroupMap; // Map from attribute location to index of its fetch group
+
     static const VertexFormatInfo       m_vertexFormatInfo[];       // Info table of vertex format
     static const VertexCompFormatInfo   m_vertexCompFormatInfo[];   // Info table of vertex component format
 #if LLPC_BUILD_GFX10
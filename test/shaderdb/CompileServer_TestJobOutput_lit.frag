@@ -0,0 +1,30 @@
+#version 450
+
+layout(binding = 0) uniform sampler2D samp;
+
+layout(location = 0) in vec2 inUv;
+layout(location = 0) out vec4 fragColor;
+
+void main()
+{
+    fragColor = texture(samp, inUv);
+}
+// BEGIN_SHADERTEST
+/*
+; RUN: echo "-spvgen-dir=%spvgendir% %gfxip -v %s" > %t.jobs
+; RUN: echo "-spvgen-dir=%spvgendir% %gfxip -v %s" >> %t.jobs
+; RUN: echo "-spvgen-dir=%spvgendir% %gfxip -pipeline-stats %s" >> %t.jobs
+; RUN: echo "-spvgen-dir=%spvgendir% %gfxip %s.missing" >> %t.jobs
+; RUN: amdllpc -server < %t.jobs | FileCheck -check-prefix=SHADERTEST %s
+
+; SHADERTEST-LABEL: {{^// LLPC}} SPIRV-to-LLVM translation results
+; SHADERTEST: AMDLLPC SUCCESS
+; SHADERTEST-NEXT: AMDLLPC_SERVER_JOB_DONE 0
+; SHADERTEST-LABEL: {{^// LLPC}} SPIRV-to-LLVM translation results
+; SHADERTEST: AMDLLPC SUCCESS
+; SHADERTEST-NEXT: AMDLLPC_SERVER_JOB_DONE 0
+; SHADERTEST: {"file":"{{.*}}CompileServer_TestJobOutput_lit.frag","isaSize":{{[1-9][0-9]*}}
+; SHADERTEST-NEXT: AMDLLPC_SERVER_JOB_DONE 0
+; SHADERTEST-NEXT: AMDLLPC_SERVER_JOB_DONE 1
+*/
+// END_SHADERTEST
@@ -0,0 +1,45 @@
+#version 450 core
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(set = 0, binding = 0) buffer Data
+{
+    float scale;
+    float values[];
+} data[];
+
+layout(location = 0) in flat int inIndex;
+layout(location = 1) in flat int inElement;
+layout(location = 0) out vec4 oColor;
+
+void main()
+{
+    int index = nonuniformEXT(inIndex);
+
+    // "scale" is at offset 0, which is also the clamp value of an out-of-bound access, so it needs no bound check.
+    // The load and the store of "values[inElement]" share one bound check.
+    data[index].values[inElement] *= data[index].scale;
+
+    oColor = vec4(1.0);
+}
+
+// BEGIN_SHADERTEST
+/*
+; The buffer descriptor is divergent, so PatchBufferOp accesses the buffer through a global pointer with a bound check.
+; RUN: amdllpc -spvgen-dir=%spvgendir% %gfxip -print-after=llpc-patch-buffer-op %s 2> %t.ir
+; RUN: FileCheck -check-prefix=SHADERTEST --input-file=%t.ir %s
+; SHADERTEST-LABEL: IR Dump After Patch LLVM for buffer operations
+; SHADERTEST: icmp ult
+; SHADERTEST-NOT: icmp ult
+*/
+// END_SHADERTEST
+
+// BEGIN_SHADERTEST1
+/*
+; Without the elimination, each of the three accesses gets its own bound check.
+; RUN: amdllpc -spvgen-dir=%spvgendir% %gfxip -disable-buffer-bound-check-elim -print-after=llpc-patch-buffer-op %s 2> %t1.ir
+; RUN: FileCheck -check-prefix=SHADERTEST1 --input-file=%t1.ir %s
+; SHADERTEST1-LABEL: IR Dump After Patch LLVM for buffer operations
+; SHADERTEST1-COUNT-3: icmp ult
+; SHADERTEST1-NOT: icmp ult
+*/
+// END_SHADERTEST1
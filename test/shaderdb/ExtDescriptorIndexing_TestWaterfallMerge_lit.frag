@@ -0,0 +1,32 @@
+#version 450 core
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(set = 0, binding = 0) uniform sampler2D albedo[];
+layout(set = 0, binding = 1) uniform sampler2D normal[];
+
+layout(location = 0) in flat int inIndex;
+layout(location = 1) in vec2 inUv;
+layout(location = 0) out vec4 oColor;
+
+void main()
+{
+    int index = nonuniformEXT(inIndex);
+    oColor = texture(albedo[index], inUv) + texture(normal[index], inUv);
+}
+
+// BEGIN_SHADERTEST
+/*
+; RUN: amdllpc -spvgen-dir=%spvgendir% -v %gfxip %s | FileCheck -check-prefix=SHADERTEST %s
+
+; Both samples must be in the one waterfall loop, and no other loop may follow.
+; SHADERTEST-LABEL: {{^// LLPC}} pipeline patching results
+; SHADERTEST: call {{.*}} @llvm.amdgcn.waterfall.begin
+; SHADERTEST-NOT: call {{.*}} @llvm.amdgcn.waterfall.begin
+; SHADERTEST: call {{.*}} <4 x float> @llvm.amdgcn.image.sample.2d.v4f32.f32
+; SHADERTEST-NOT: call {{.*}} @llvm.amdgcn.waterfall.begin
+; SHADERTEST: call {{.*}} <4 x float> @llvm.amdgcn.image.sample.2d.v4f32.f32
+; SHADERTEST-NOT: call {{.*}} @llvm.amdgcn.waterfall.begin
+; SHADERTEST-LABEL: {{^// LLPC}} final pipeline module info
+; SHADERTEST: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST
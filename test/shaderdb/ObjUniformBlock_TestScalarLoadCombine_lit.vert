@@ -0,0 +1,28 @@
+#version 450 core
+
+layout(std140, binding = 0) uniform Block
+{
+    vec4 f0;
+    vec4 f1;
+    vec4 f2;
+    vec4 f3;
+} block;
+
+void main()
+{
+    gl_Position = block.f0 + block.f1 * block.f2 - block.f3;
+}
+// BEGIN_SHADERTEST
+/*
+; RUN: amdllpc -spvgen-dir=%spvgendir% -v %gfxip %s | FileCheck -check-prefix=SHADERTEST %s
+
+; SHADERTEST-LABEL: {{^// LLPC}} pipeline patching results
+; SHADERTEST: call <4 x i32> @llvm.amdgcn.s.buffer.load.v4i32
+
+; SHADERTEST-LABEL: {{^// LLPC}} final pipeline module info
+; SHADERTEST: call <16 x i32> @llvm.amdgcn.s.buffer.load.v16i32(<4 x i32> %{{[0-9]*}}, i32 0, i32 0)
+; SHADERTEST-NOT: call <4 x i32> @llvm.amdgcn.s.buffer.load.v4i32
+
+; SHADERTEST: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST
@@ -0,0 +1,69 @@
+#version 450
+
+layout(location = 0) out vec4 fragColor;
+
+layout(binding = 0) uniform Uniforms
+{
+    int   index;
+    float f;
+    vec4  v;
+};
+
+void main()
+{
+    float f4[4] = float[4](f, f + 1.0, f + 2.0, f + 3.0);
+    float f10[10] = float[10](f, f + 1.0, f + 2.0, f + 3.0, f + 4.0, f + 5.0, f + 6.0, f + 7.0, f + 8.0, f + 9.0);
+    vec4 v8[8] = vec4[8](v, v * 2.0, v * 3.0, v * 4.0, v * 5.0, v * 6.0, v * 7.0, v * 8.0);
+
+    vec4 v32[32];
+    for (int i = 0; i < 32; ++i)
+    {
+        v32[i] = v * float(i);
+    }
+
+    vec4 color = v32[index];
+    color += v8[index];
+    color += vec4(f4[index]);
+    color += vec4(f10[index]);
+    fragColor = color;
+}
+// BEGIN_SHADERTEST
+/*
+; RUN: amdllpc -spvgen-dir=%spvgendir% -v %gfxip %s | FileCheck -check-prefix=SHADERTEST %s
+
+; SHADERTEST-LABEL: {{^// LLPC}} dynamic index strategy results (fragment shader)
+; SHADERTEST: [32 x <4 x float>]: accessCount = 1, loopDepth = 1, Expand = N/A, Indexed = 1064 => Indexed
+; SHADERTEST: [32 x <4 x float>]: accessCount = 1, loopDepth = 0, Expand = N/A, Indexed = 140 => Indexed
+; SHADERTEST: [8 x <4 x float>]: accessCount = 1, loopDepth = 0, Expand = 70, Indexed = 38 => Indexed
+; SHADERTEST: [4 x float]: accessCount = 1, loopDepth = 0, Expand = 12, Indexed = 29 => Expand
+; SHADERTEST: [10 x float]: accessCount = 1, loopDepth = 0, Expand = 36, Indexed = 29 => Indexed
+
+; The [4 x float] access is expanded to a select chain, the other accesses keep their dynamic index.
+; SHADERTEST-LABEL: {{^// LLPC}} SPIR-V lowering results
+; SHADERTEST-NOT: getelementptr {{.*}}[4 x float]
+; SHADERTEST-DAG: getelementptr [32 x <4 x float>], [32 x <4 x float>] addrspace({{.*}})* %{{.*}}, {{i32|i64}} 0, {{i32|i64}} %
+; SHADERTEST-DAG: getelementptr [8 x <4 x float>], [8 x <4 x float>] addrspace({{.*}})* %{{.*}}, {{i32|i64}} 0, {{i32|i64}} %
+; SHADERTEST-DAG: getelementptr [10 x float], [10 x float] addrspace({{.*}})* %{{.*}}, {{i32|i64}} 0, {{i32|i64}} %
+; SHADERTEST-DAG: select i1 %{{.*}}, float
+; SHADERTEST-NOT: getelementptr {{.*}}[4 x float]
+; SHADERTEST-LABEL: {{^// LLPC}} pipeline patching results
+; SHADERTEST: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST
+
+// BEGIN_SHADERTEST1
+/*
+; Without the cost model, arrays of up to 8 elements are expanded, whatever the element size.
+; RUN: amdllpc -spvgen-dir=%spvgendir% -v %gfxip -dyn-index-cost-model=false %s | FileCheck -check-prefix=SHADERTEST1 %s
+
+; SHADERTEST1-NOT: {{^// LLPC}} dynamic index strategy results
+; SHADERTEST1-LABEL: {{^// LLPC}} SPIR-V lowering results
+; SHADERTEST1-NOT: getelementptr {{.*}}[8 x <4 x float>]
+; SHADERTEST1-DAG: getelementptr [32 x <4 x float>], [32 x <4 x float>] addrspace({{.*}})* %{{.*}}, {{i32|i64}} 0, {{i32|i64}} %
+; SHADERTEST1-DAG: getelementptr [10 x float], [10 x float] addrspace({{.*}})* %{{.*}}, {{i32|i64}} 0, {{i32|i64}} %
+; SHADERTEST1-DAG: select i1 %{{.*}}, <4 x float>
+; SHADERTEST1-NOT: getelementptr {{.*}}[8 x <4 x float>]
+; SHADERTEST1-LABEL: {{^// LLPC}} pipeline patching results
+; SHADERTEST1: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST1
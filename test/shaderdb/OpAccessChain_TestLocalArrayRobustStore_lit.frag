@@ -0,0 +1,29 @@
+#version 450
+
+layout(location = 0) out vec4 fragColor;
+
+layout(binding = 0) uniform Uniforms
+{
+    int   index;
+    float f;
+};
+
+void main()
+{
+    float f4[4] = float[4](f, f + 1.0, f + 2.0, f + 3.0);
+
+    // The masked index is always in bound, so no robust access check is needed on the store.
+    f4[index & 3] = 0.0;
+
+    fragColor = vec4(f4[0], f4[1], f4[2], f4[3]);
+}
+// BEGIN_SHADERTEST
+/*
+; RUN: amdllpc -spvgen-dir=%spvgendir% -v %gfxip -robust-buffer-access %s | FileCheck -check-prefix=SHADERTEST %s
+
+; SHADERTEST-LABEL: {{^// LLPC}} SPIR-V lowering results
+; SHADERTEST-NOT: br i1
+; SHADERTEST-LABEL: {{^// LLPC}} pipeline before-patching results
+; SHADERTEST: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST
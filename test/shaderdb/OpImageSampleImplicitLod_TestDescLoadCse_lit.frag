@@ -0,0 +1,28 @@
+#version 450 core
+
+layout(set = 0, binding = 0) uniform sampler2D samp;
+layout(location = 0) in vec2 inUv;
+layout(location = 1) in flat int inSelect;
+layout(location = 0) out vec4 oColor;
+
+void main()
+{
+    vec4 color = vec4(0.0);
+    if (inSelect != 0)
+    {
+        color = texture(samp, inUv);
+    }
+    color += texture(samp, inUv * 2.0);
+    oColor = color;
+}
+
+// BEGIN_SHADERTEST
+/*
+; RUN: amdllpc -spvgen-dir=%spvgendir% -v %gfxip %s | FileCheck -check-prefix=SHADERTEST %s
+
+; SHADERTEST-LABEL: {{^// LLPC}} pipeline patching results
+; SHADERTEST-COUNT-2: load <8 x i32>, <8 x i32> addrspace(4)* %{{[0-9]*}}
+; SHADERTEST-NOT: load <8 x i32>, <8 x i32> addrspace(4)* %{{[0-9]*}}
+; SHADERTEST: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST
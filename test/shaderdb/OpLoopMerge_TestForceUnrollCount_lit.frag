@@ -0,0 +1,38 @@
+#version 450
+
+layout(binding = 0) uniform Uniforms
+{
+    int count;
+    vec4 data[16];
+};
+
+layout(location = 0) out vec4 fragColor;
+
+void main()
+{
+    vec4 sum = vec4(0.0);
+    for (int i = 0; i < count; ++i)
+    {
+        sum += data[i];
+    }
+    fragColor = sum;
+}
+
+// BEGIN_SHADERTEST
+/*
+; RUN: amdllpc -spvgen-dir=%spvgendir% -v %gfxip -force-loop-unroll-count=4 %s | FileCheck -check-prefix=SHADERTEST %s
+; SHADERTEST-LABEL: {{^// LLPC}} SPIR-V lowering results
+; SHADERTEST: !{!"llvm.loop.unroll.count", i32 4}
+; SHADERTEST: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST
+
+// The value of a per-compiler option may also be given as a separate argument.
+// BEGIN_SHADERTEST1
+/*
+; RUN: amdllpc -spvgen-dir=%spvgendir% -v %gfxip -force-loop-unroll-count 4 %s | FileCheck -check-prefix=SHADERTEST1 %s
+; SHADERTEST1-LABEL: {{^// LLPC}} SPIR-V lowering results
+; SHADERTEST1: !{!"llvm.loop.unroll.count", i32 4}
+; SHADERTEST1: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST1
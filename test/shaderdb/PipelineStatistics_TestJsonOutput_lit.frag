@@ -0,0 +1,21 @@
+#version 450
+
+layout(binding = 0) uniform sampler2D samp;
+
+layout(location = 0) in vec2 inUv;
+layout(location = 0) out vec4 fragColor;
+
+void main()
+{
+    fragColor = texture(samp, inUv);
+}
+// BEGIN_SHADERTEST
+/*
+; RUN: amdllpc -spvgen-dir=%spvgendir% %gfxip -pipeline-stats %s | FileCheck -check-prefix=SHADERTEST %s
+
+; SHADERTEST: {"file":"{{.*}}PipelineStatistics_TestJsonOutput_lit.frag","isaSize":{{[1-9][0-9]*}},
+; SHADERTEST-SAME: "predictedCost":{{[1-9][0-9]*}},"compileTimeUs":{{[0-9]+}},"stages":
+; SHADERTEST-SAME: "ps":{"vgprCount":{{[0-9]+}},"sgprCount":{{[0-9]+}},"vgprLimit":{{[1-9][0-9]*}},"sgprLimit":{{[1-9][0-9]*}}
+; SHADERTEST-SAME: "wavefrontSize":{{32|64}},"isaSize":{{[1-9][0-9]*}}}
+*/
+// END_SHADERTEST
@@ -0,0 +1,36 @@
+#version 450
+
+layout(binding = 0) uniform Uniforms
+{
+    vec4 color;
+};
+
+layout(location = 0) out vec4 fragColor;
+
+void main()
+{
+    fragColor = color * 2.0;
+}
+
+// BEGIN_SHADERTEST
+/*
+; Several processes start on an empty cache directory at the same time, so they race to create the on-disk cache file
+; and to add the same shader to it. None of them may truncate the file under another, or leave it unusable.
+; RUN: rm -rf %t.dir && mkdir -p %t.dir
+; RUN: amdllpc -spvgen-dir=%spvgendir% %gfxip -enable-outs -shader-cache-mode=2 -shader-cache-file-dir=%t.dir %s > %t.1.log & amdllpc -spvgen-dir=%spvgendir% %gfxip -enable-outs -shader-cache-mode=2 -shader-cache-file-dir=%t.dir %s > %t.2.log & amdllpc -spvgen-dir=%spvgendir% %gfxip -enable-outs -shader-cache-mode=2 -shader-cache-file-dir=%t.dir %s > %t.3.log & amdllpc -spvgen-dir=%spvgendir% %gfxip -enable-outs -shader-cache-mode=2 -shader-cache-file-dir=%t.dir %s > %t.4.log & wait
+; RUN: FileCheck -check-prefix=SHADERTEST --input-file=%t.1.log %s
+; RUN: FileCheck -check-prefix=SHADERTEST --input-file=%t.2.log %s
+; RUN: FileCheck -check-prefix=SHADERTEST --input-file=%t.3.log %s
+; RUN: FileCheck -check-prefix=SHADERTEST --input-file=%t.4.log %s
+; SHADERTEST: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST
+
+// BEGIN_SHADERTEST1
+/*
+; A later process finds the shader in the file and does not compile it again.
+; RUN: amdllpc -spvgen-dir=%spvgendir% %gfxip -enable-outs -shader-cache-mode=2 -shader-cache-file-dir=%t.dir %s | FileCheck -check-prefix=SHADERTEST1 %s
+; SHADERTEST1-NOT: {{^// LLPC}} pipeline patching results
+; SHADERTEST1: AMDLLPC SUCCESS
+*/
+// END_SHADERTEST1
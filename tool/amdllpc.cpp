@@ -43,6 +43,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Path.h"
@@ -50,6 +51,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/StringSaver.h"
 #include "llvm/Support/SystemUtils.h"
 #include "llvm/Support/ToolOutputFile.h"
 
@@ -63,6 +65,8 @@
     #endif
 #endif
 
+#include <chrono>
+#include <iostream>
 #include <sstream>
 #include <stdlib.h> // getenv
 
@@ -79,6 +83,7 @@
 #include "vfx.h"
 
 #include "llpc.h"
+#include "llpcCompiler.h"
 #include "llpcDebug.h"
 #include "llpcElfReader.h"
 #include "llpcInternal.h"
@@ -262,6 +267,39 @@ static cl::opt<std::string> SpvGenDir("spvgen-dir", cl::desc("Directory to load
 static cl::opt<bool> RobustBufferAccess("robust-buffer-access",
                                         cl::desc("Validate if the index is out of bounds"), cl::init(false));
 
+// -pipeline-stats: print resource usage statistics of each built pipeline as a line of JSON
+static cl::opt<bool> PipelineStats("pipeline-stats",
+                                   cl::desc("Print resource usage statistics of each built pipeline as a line of JSON"),
+                                   cl::init(false));
+
+// -build-timeout: abandon a pipeline build that runs for longer than the specified time
+static cl::opt<uint32_t> BuildTimeout("build-timeout",
+                                      cl::desc("Abandon a pipeline build that runs for longer than the specified "
+                                               "time (0 = no limit)"),
+                                      cl::value_desc("milliseconds"),
+                                      cl::init(0));
+
+// -build-canceled: set the cancellation flag of pipeline builds before they start (for testing)
+static cl::opt<bool> BuildCanceled("build-canceled",
+                                   cl::desc("Set the cancellation flag of pipeline builds before they start, so that "
+                                            "they are abandoned before the first pass manager runs (for testing)"),
+                                   cl::init(false));
+
+// Cancellation flag of pipeline builds, it is set for -build-canceled
+static const volatile uint32_t BuildCancelFlag = 1;
+
+// -build-priority: scheduling priority of pipeline builds
+static cl::opt<uint32_t> BuildPriority("build-priority",
+                                       cl::desc("Scheduling priority of pipeline builds, higher ones start first"),
+                                       cl::init(0));
+
+// -server: run as a resident compile server, reading compile jobs from stdin
+// NOTE: This option is detected before options are parsed, it is registered for -help only.
+static cl::opt<bool> CompileServer("server",
+                                   cl::desc("Run as a resident compile server: read compile jobs (options and input "
+                                            "files of a one-shot run, one job per line) from stdin"),
+                                   cl::init(false));
+
 // -check-auto-layout-compatible: check if auto descriptor layout got from spv file is commpatible with real layout
 static cl::opt<bool> CheckAutoLayoutCompatible(
     "check-auto-layout-compatible",
@@ -345,6 +383,8 @@ struct CompileInfo
     bool                        doAutoLayout;                   // Whether to auto layout descriptors
     bool                        checkAutoLayoutCompatible;      // Whether to comapre if auto layout descriptors is
                                                                 // same as specified pipeline layout
+    uint32_t                    predictedCost;                  // Predicted compile cost of the pipeline
+    uint64_t                    compileTimeUs;                  // Measured time of building the pipeline (us)
 };
 
 // =====================================================================================================================
@@ -1135,6 +1175,9 @@ static Result BuildPipeline(
         pPipelineInfo->pInstance      = nullptr; // Dummy, unused
         pPipelineInfo->pUserData      = &pCompileInfo->pPipelineBuf;
         pPipelineInfo->pfnOutputAlloc = AllocateBuffer;
+        pPipelineInfo->buildControl.pCancelFlag = BuildCanceled ? &BuildCancelFlag : nullptr;
+        pPipelineInfo->buildControl.timeoutMs   = BuildTimeout;
+        pPipelineInfo->buildControl.priority    = BuildPriority;
 
         // NOTE: If number of patch control points is not specified, we set it to 3.
         if (pPipelineInfo->iaState.patchControlPoints == 0)
@@ -1171,8 +1214,15 @@ static Result BuildPipeline(
             outs().flush();
         }
 
+        pCompileInfo->predictedCost =
+            Compiler::EstimatePipelineCost(ArrayRef<const PipelineShaderInfo*>(shaderInfo, ShaderStageGfxCount));
+        auto startTime = std::chrono::steady_clock::now();
+
         result = pCompiler->BuildGraphicsPipeline(pPipelineInfo, pPipelineOut, pPipelineDumpHandle);
 
+        pCompileInfo->compileTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                          std::chrono::steady_clock::now() - startTime).count();
+
         if (result == Result::Success)
         {
             if (llvm::cl::EnablePipelineDump)
@@ -1225,6 +1275,9 @@ static Result BuildPipeline(
         pPipelineInfo->pInstance      = nullptr; // Dummy, unused
         pPipelineInfo->pUserData      = &pCompileInfo->pPipelineBuf;
         pPipelineInfo->pfnOutputAlloc = AllocateBuffer;
+        pPipelineInfo->buildControl.pCancelFlag = BuildCanceled ? &BuildCancelFlag : nullptr;
+        pPipelineInfo->buildControl.timeoutMs   = BuildTimeout;
+        pPipelineInfo->buildControl.priority    = BuildPriority;
 #if LLPC_CLIENT_INTERFACE_MAJOR_VERSION >= 23
         pPipelineInfo->options.robustBufferAccess = RobustBufferAccess;
 #endif
@@ -1254,8 +1307,16 @@ static Result BuildPipeline(
             outs().flush();
         }
 
+        const PipelineShaderInfo* shaderInfo[ShaderStageNativeStageCount] = {};
+        shaderInfo[ShaderStageCompute] = pShaderInfo;
+        pCompileInfo->predictedCost = Compiler::EstimatePipelineCost(shaderInfo);
+        auto startTime = std::chrono::steady_clock::now();
+
         result = pCompiler->BuildComputePipeline(pPipelineInfo, pPipelineOut, pPipelineDumpHandle);
 
+        pCompileInfo->compileTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                          std::chrono::steady_clock::now() - startTime).count();
+
         if (result == Result::Success)
         {
             if (llvm::cl::EnablePipelineDump)
@@ -1275,6 +1336,67 @@ static Result BuildPipeline(
     return result;
 }
 
+// =====================================================================================================================
+// Outputs resource usage statistics of the built pipeline to stdout, as a single line of JSON, so that they can be
+// collected by script over many pipelines. The predicted compile cost is output along with the measured compile time,
+// so that the cost estimation can be validated against the shaderdb corpus.
+static Result OutputPipelineStatistics(
+    CompileInfo* pCompileInfo,  // [in] Compilation info of LLPC standalone tool
+    StringRef    firstInFile)   // [in] Name of first input file
+{
+    // Names of hardware shader stages, in HwShaderStage order.
+    static const char* const HwStageNames[] = { "ls", "hs", "es", "gs", "vs", "ps", "cs" };
+    static_assert(sizeof(HwStageNames) / sizeof(HwStageNames[0]) == HwShaderStageCount, "Unexpected size");
+
+    const BinaryData* pPipelineBin = (pCompileInfo->stageMask & ShaderStageToMask(ShaderStageCompute)) ?
+                                         &pCompileInfo->compPipelineOut.pipelineBin :
+                                         &pCompileInfo->gfxPipelineOut.pipelineBin;
+
+    PipelineStatistics stats = {};
+    Result result = ICompiler::GetPipelineStatistics(pCompileInfo->gfxIp, *pPipelineBin, &stats);
+    if (result != Result::Success)
+    {
+        LLPC_ERRS("Failed to get pipeline statistics: the pipeline binary is not a PAL ELF\n");
+        return result;
+    }
+
+    json::OStream json(outs());
+    json.object([&]
+    {
+        json.attribute("file", firstInFile);
+        json.attribute("isaSize", static_cast<int64_t>(stats.isaSize));
+        json.attribute("predictedCost", pCompileInfo->predictedCost);
+        json.attribute("compileTimeUs", static_cast<int64_t>(pCompileInfo->compileTimeUs));
+        json.attributeObject("stages", [&]
+        {
+            for (uint32_t hwStage = 0; hwStage < HwShaderStageCount; ++hwStage)
+            {
+                const HwShaderStatistics& stageStats = stats.hwStages[hwStage];
+                if (stageStats.valid == false)
+                {
+                    continue;
+                }
+
+                json.attributeObject(HwStageNames[hwStage], [&]
+                {
+                    json.attribute("vgprCount", stageStats.vgprCount);
+                    json.attribute("sgprCount", stageStats.sgprCount);
+                    json.attribute("vgprLimit", stageStats.vgprLimit);
+                    json.attribute("sgprLimit", stageStats.sgprLimit);
+                    json.attribute("ldsSize", stageStats.ldsSize);
+                    json.attribute("scratchMemorySize", stageStats.scratchMemorySize);
+                    json.attribute("wavefrontSize", stageStats.wavefrontSize);
+                    json.attribute("isaSize", static_cast<int64_t>(stageStats.isaSize));
+                });
+            }
+        });
+    });
+    outs() << "\n";
+    outs().flush();
+
+    return Result::Success;
+}
+
 // =====================================================================================================================
 // Output LLPC resulting binary (ELF binary, ISA assembly text, or LLVM bitcode) to the specified target file.
 static Result OutputElf(
@@ -1718,6 +1840,10 @@ static Result ProcessPipeline(
             {
                 result = OutputElf(&compileInfo, OutFile, inFiles[0]);
             }
+            if ((result == Result::Success) && PipelineStats)
+            {
+                result = OutputPipelineStatistics(&compileInfo, inFiles[0]);
+            }
         }
     }
     //
@@ -1766,59 +1892,29 @@ void FindAllMatchFiles(
 }
 #endif
 // =====================================================================================================================
-// Main function of LLPC standalone tool, entry-point.
-//
-// Returns 0 if successful. Other numeric values indicate failure.
-int32_t main(
-    int32_t argc,       // Count of arguments
-    char*   argv[])     // [in] List of arguments
+// Compiles the specified input files, as given on the command line of a one-shot run.
+static Result CompileInputFiles(
+    ICompiler*            pCompiler,    // [in] LLPC compiler object
+    ArrayRef<std::string> inFiles)      // Input filename(s)
 {
     Result result = Result::Success;
 
-    ICompiler*  pCompiler   = nullptr;
-
-    //
-    // Initialization
-    //
-
-    // TODO: CRT based Memory leak detection is conflict with stack trace now, we only can enable one of them.
-#if defined(LLPC_MEM_TRACK_LEAK) && defined(_DEBUG)
-    EnableMemoryLeakDetection();
-#else
-    EnablePrettyStackTrace();
-    sys::PrintStackTraceOnErrorSignal(argv[0]);
-    PrettyStackTraceProgram X(argc, argv);
-
-#ifdef WIN_OS
-    signal(SIGABRT, LlpcSignalAbortHandler);
-#endif
-#endif
-
-    result = Init(argc, argv, &pCompiler);
-
-#ifdef WIN_OS
-    if (AssertToMsgBox)
-    {
-        _set_error_mode(_OUT_TO_MSGBOX);
-    }
-#endif
-
-    if (IsPipelineInfoFile(InFiles[0]) || IsLlvmIrFile(InFiles[0]))
+    if (IsPipelineInfoFile(inFiles[0]) || IsLlvmIrFile(inFiles[0]))
     {
         uint32_t nextFile = 0;
 
         // The first input file is a pipeline file or LLVM IR file. Assume they all are, and compile each one
         // separately but in the same context.
-        for (uint32_t i = 0; (i < InFiles.size()) && (result == Result::Success); ++i)
+        for (uint32_t i = 0; (i < inFiles.size()) && (result == Result::Success); ++i)
         {
 #ifdef WIN_OS
-            if (InFiles[i].find_last_of("*?") != std::string::npos)
+            if (inFiles[i].find_last_of("*?") != std::string::npos)
             {
                 std::vector<std::string> matchFiles;
-                FindAllMatchFiles(InFiles[i], &matchFiles);
+                FindAllMatchFiles(inFiles[i], &matchFiles);
                 if (matchFiles.size() == 0)
                 {
-                    LLPC_ERRS("\nFailed to read file " << InFiles[i] << "\n");
+                    LLPC_ERRS("\nFailed to read file " << inFiles[i] << "\n");
                     result = Result::ErrorInvalidValue;
                 }
                 else
@@ -1832,22 +1928,22 @@ int32_t main(
             else
 #endif
             {
-                result = ProcessPipeline(pCompiler, InFiles[i], 0, &nextFile);
+                result = ProcessPipeline(pCompiler, inFiles[i], 0, &nextFile);
             }
         }
     }
-    else if (result == Result::Success)
+    else
     {
         // Otherwise, join all input files into the same pipeline.
 #ifdef WIN_OS
-        if ((InFiles.size() == 1) &&
-            (InFiles[0].find_last_of("*?") != std::string::npos))
+        if ((inFiles.size() == 1) &&
+            (inFiles[0].find_last_of("*?") != std::string::npos))
         {
             std::vector<std::string> matchFiles;
-            FindAllMatchFiles(InFiles[0], &matchFiles);
+            FindAllMatchFiles(inFiles[0], &matchFiles);
             if (matchFiles.size() == 0)
             {
-                LLPC_ERRS("\nFailed to read file " << InFiles[0] << "\n");
+                LLPC_ERRS("\nFailed to read file " << inFiles[0] << "\n");
                 result = Result::ErrorInvalidValue;
             }
             else
@@ -1862,31 +1958,260 @@ int32_t main(
         else
 #endif
         {
-            SmallVector<std::string, 6> inFiles;
-            for (const auto& inFile : InFiles)
+            SmallVector<std::string, 6> joinedFiles;
+            for (const auto& inFile : inFiles)
             {
 #ifdef WIN_OS
-                if (InFiles[0].find_last_of("*?") != std::string::npos)
+                if (inFiles[0].find_last_of("*?") != std::string::npos)
                 {
                     LLPC_ERRS("\nCan't use wilecard if multiple filename is set in command\n");
                     result = Result::ErrorInvalidValue;
                     break;
                 }
 #endif
-                inFiles.push_back(inFile);
+                joinedFiles.push_back(inFile);
             }
 
             if (result == Result::Success)
             {
                 uint32_t nextFile = 0;
-                for (; result == Result::Success && nextFile < inFiles.size();)
+                for (; result == Result::Success && nextFile < joinedFiles.size();)
                 {
-                    result = ProcessPipeline(pCompiler, inFiles, nextFile, &nextFile);
+                    result = ProcessPipeline(pCompiler, joinedFiles, nextFile, &nextFile);
                 }
             }
         }
     }
 
+    return result;
+}
+
+// =====================================================================================================================
+// Checks whether the specified command-line argument is the option -server.
+static bool IsCompileServerOption(
+    const char* pArg)   // [in] Command-line argument
+{
+    StringRef arg = pArg;
+    return arg.startswith("-") && (arg.ltrim('-') == CompileServer.ArgStr);
+}
+
+// =====================================================================================================================
+// Splits the arguments of a compile job into options and input files, the way LLVM command-line parsing does: an
+// argument that doesn't start with '-' is an input file, unless it is the value of the preceding option (an option that
+// requires a value, given without "=").
+static void SplitJobArguments(
+    ArrayRef<const char*>     args,         // Arguments of the compile job
+    std::vector<std::string>* pOptions,     // [out] Options, with their values
+    std::vector<std::string>* pInFiles)     // [out] Input files
+{
+    auto& registeredOptions = cl::getRegisteredOptions();
+    bool isOptionValue = false;
+    for (const char* pArg : args)
+    {
+        StringRef arg = pArg;
+        if (isOptionValue)
+        {
+            pOptions->push_back(arg.str());
+            isOptionValue = false;
+        }
+        else if (arg.startswith("-") && (arg.size() > 1))
+        {
+            pOptions->push_back(arg.str());
+            if (arg.contains('=') == false)
+            {
+                auto it = registeredOptions.find(arg.ltrim('-'));
+                isOptionValue = (it != registeredOptions.end()) &&
+                                (it->second->getValueExpectedFlag() == cl::ValueRequired);
+            }
+        }
+        else
+        {
+            pInFiles->push_back(arg.str());
+        }
+    }
+}
+
+// =====================================================================================================================
+// Runs LLPC standalone tool as a resident compile server. Each line read from stdin is a compile job, written as the
+// arguments of a one-shot run (options and input files); the arguments given to the server itself, other than -server,
+// are prepended to every job. A job gives the same output as the one-shot run, followed by a line
+// "AMDLLPC_SERVER_JOB_DONE <exit code>" on both stdout and stderr to mark its end. The server exits at end of input.
+//
+// Jobs with the same options share one compiler (and so its context pool). A job with other options recreates the
+// compiler, LLVM stays initialized across that.
+//
+// Returns 0 when the input is exhausted; the result of each job is reported by its exit code line.
+static int32_t RunCompileServer(
+    int32_t argc,       // Count of arguments
+    char*   argv[])     // [in] List of arguments
+{
+    const GfxIpVersion defaultGfxIp = ParsedGfxIp;
+
+    ICompiler*               pCompiler  = nullptr;
+    bool                     isResident = false;
+    std::vector<std::string> compilerOptions;           // Options of the compiler, input files excluded
+
+    // Values of the options that a job may change, to be restored for the next job on the same compiler
+    std::string              entryTarget;
+    bool                     disableNullFragShader = false;
+
+    std::string jobLine;
+    while (std::getline(std::cin, jobLine))
+    {
+        BumpPtrAllocator allocator;
+        StringSaver      saver(allocator);
+
+        SmallVector<const char*, 32> jobArgs;
+        for (int32_t i = 1; i < argc; ++i)
+        {
+            if (IsCompileServerOption(argv[i]) == false)
+            {
+                jobArgs.push_back(argv[i]);
+            }
+        }
+        const size_t serverArgCount = jobArgs.size();
+        cl::TokenizeGNUCommandLine(jobLine, saver, jobArgs);
+        if (jobArgs.size() == serverArgCount)
+        {
+            // Skip empty line
+            continue;
+        }
+
+        std::vector<std::string> options;
+        std::vector<std::string> inFiles;
+        SplitJobArguments(jobArgs, &options, &inFiles);
+
+        Result result = Result::Success;
+        if (inFiles.empty())
+        {
+            LLPC_ERRS("No input file in compile job: " << jobLine << "\n");
+            result = Result::ErrorInvalidValue;
+        }
+        else if ((pCompiler != nullptr) && (options == compilerOptions))
+        {
+            EntryTarget.setValue(entryTarget);
+            cl::DisableNullFragShader.setValue(disableNullFragShader);
+        }
+        else
+        {
+            if (pCompiler != nullptr)
+            {
+                pCompiler->Destroy();
+                pCompiler = nullptr;
+            }
+            compilerOptions.clear();
+
+            std::vector<char*> initArgs;
+            initArgs.push_back(argv[0]);
+            for (const char* pArg : jobArgs)
+            {
+                initArgs.push_back(const_cast<char*>(pArg));
+            }
+
+            ParsedGfxIp = defaultGfxIp;
+            result = Init(initArgs.size(), initArgs.data(), &pCompiler);
+
+            if ((pCompiler != nullptr) && (isResident == false))
+            {
+                // Keep LLVM initialized when this compiler is destroyed for a job with other options.
+                Compiler::KeepResident();
+                isResident = true;
+            }
+
+            if (result == Result::Success)
+            {
+                compilerOptions       = options;
+                entryTarget           = EntryTarget;
+                disableNullFragShader = cl::DisableNullFragShader;
+            }
+            else if (pCompiler != nullptr)
+            {
+                pCompiler->Destroy();
+                pCompiler = nullptr;
+            }
+        }
+
+        if (result == Result::Success)
+        {
+            result = CompileInputFiles(pCompiler, inFiles);
+        }
+
+        if (result == Result::Success)
+        {
+            LLPC_OUTS("\n=====  AMDLLPC SUCCESS  =====\n");
+        }
+        else
+        {
+            LLPC_ERRS("\n=====  AMDLLPC FAILED  =====\n");
+        }
+
+        // NOTE: Output to "-o -" goes through stdio, so flush it before the end of the job is marked.
+        const int32_t exitCode = (result == Result::Success) ? 0 : 1;
+        fflush(stdout);
+        outs() << "AMDLLPC_SERVER_JOB_DONE " << exitCode << "\n";
+        outs().flush();
+        errs() << "AMDLLPC_SERVER_JOB_DONE " << exitCode << "\n";
+    }
+
+    if (pCompiler != nullptr)
+    {
+        pCompiler->Destroy();
+    }
+
+    return 0;
+}
+
+// =====================================================================================================================
+// Main function of LLPC standalone tool, entry-point.
+//
+// Returns 0 if successful. Other numeric values indicate failure.
+int32_t main(
+    int32_t argc,       // Count of arguments
+    char*   argv[])     // [in] List of arguments
+{
+    Result result = Result::Success;
+
+    ICompiler*  pCompiler   = nullptr;
+
+    //
+    // Initialization
+    //
+
+    // TODO: CRT based Memory leak detection is conflict with stack trace now, we only can enable one of them.
+#if defined(LLPC_MEM_TRACK_LEAK) && defined(_DEBUG)
+    EnableMemoryLeakDetection();
+#else
+    EnablePrettyStackTrace();
+    sys::PrintStackTraceOnErrorSignal(argv[0]);
+    PrettyStackTraceProgram X(argc, argv);
+
+#ifdef WIN_OS
+    signal(SIGABRT, LlpcSignalAbortHandler);
+#endif
+#endif
+
+    for (int32_t i = 1; i < argc; ++i)
+    {
+        if (IsCompileServerOption(argv[i]))
+        {
+            return RunCompileServer(argc, argv);
+        }
+    }
+
+    result = Init(argc, argv, &pCompiler);
+
+#ifdef WIN_OS
+    if (AssertToMsgBox)
+    {
+        _set_error_mode(_OUT_TO_MSGBOX);
+    }
+#endif
+
+    if (result == Result::Success)
+    {
+        result = CompileInputFiles(pCompiler, InFiles);
+    }
+
     pCompiler->Destroy();
 
     if (result == Result::Success)
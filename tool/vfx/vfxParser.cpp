@@ -169,16 +169,16 @@ VfxParser::VfxParser()
     :
     m_isValidVfxFile(false),
     m_pCurrentSection(nullptr),
-    m_currentLineNum(0),
-    m_currentSectionLineNum(0)
+    m_currentLineNum(0)
 {
 
 }
 
 // =====================================================================================================================
-// Parses a config file line.
+// Parses a config file line. Lines are handled as soon as they are read: key-value lines are applied to the current
+// section directly and shader source lines are appended to it, so a section is never buffered as text.
 bool VfxParser::ParseLine(
-    char* pLine)    // [in] Input test config line.
+    char* pLine)    // [in] Input test config line, without line ending.
 {
     bool result = true;
     ++m_currentLineNum;
@@ -201,9 +201,21 @@ bool VfxParser::ParseLine(
             result = BeginSection(pLine);
         }
     }
+    else if (m_pCurrentSection == nullptr)
+    {
+        // Lines outside of a (free) section are ignored
+    }
+    else if (m_pCurrentSection->IsShaderSourceSection() ||
+             (m_pCurrentSection->GetSectionType() == SectionTypeCompileLog))
+    {
+        // Process shader source sections, the line ending stripped by the tokenizer is added back.
+        m_pCurrentSection->AddLine(pLine);
+        m_pCurrentSection->AddLine("\n");
+    }
     else
     {
-        m_currentSectionStringBuffer << pLine;
+        // Process key-value based sections.
+        result = ParseSectionKeyValue(pLine);
     }
 
     return result;
@@ -234,10 +246,6 @@ bool VfxParser::BeginSection(
         m_pCurrentSection = m_pVfxDoc->GetFreeSection(pSectionName);
         if (m_pCurrentSection != nullptr)
         {
-            // Next line is the first line of section content.
-            m_currentSectionLineNum       = m_currentLineNum + 1;
-            m_currentSectionStringBuffer.str("");
-            m_currentSectionStringBuffer.clear();
             m_pCurrentSection->SetLineNum(m_currentLineNum);
         }
     }
@@ -251,29 +259,12 @@ bool VfxParser::EndSection()
 {
     bool result = true;
 
-    if (m_pCurrentSection == nullptr)
-    {
-        // Do nothing
-    }
-    else if (m_pCurrentSection->IsShaderSourceSection() ||
-             (m_pCurrentSection->GetSectionType() == SectionTypeCompileLog))
+    // The content of a section has been parsed line by line, only the version needs a check once it is complete.
+    if ((m_pCurrentSection != nullptr) && (m_pCurrentSection->GetSectionType() == SectionTypeVersion))
     {
-        // Process shader source sections.
-        ParseSectionShaderSource();
-    }
-    else
-    {
-        // Process key-value based sections.
-        result = ParseSectionKeyValues();
-        if (result)
-        {
-            if (m_pCurrentSection->GetSectionType() == SectionTypeVersion)
-            {
-                uint32_t version;
-                reinterpret_cast<SectionVersion*>(m_pCurrentSection)->GetSubState(version);
-                result = m_pVfxDoc->CheckVersion(version);
-            }
-        }
+        uint32_t version;
+        reinterpret_cast<SectionVersion*>(m_pCurrentSection)->GetSubState(version);
+        result = m_pVfxDoc->CheckVersion(version);
     }
 
     return result;
@@ -281,45 +272,25 @@ bool VfxParser::EndSection()
 
 // =====================================================================================================================
 // Parses a line of a pre-defined key-value section.
-bool VfxParser::ParseSectionKeyValues()
+bool VfxParser::ParseSectionKeyValue(
+    char* pLine)    // [in] Input test config line, without line ending.
 {
     bool result = true;
 
-    // Set line number variable which is used in error report.
-    uint32_t lineNum = m_currentSectionLineNum;
-    char pLineBuffer[MaxLineBufSize];
-    while (true)
+    // Skip empty line
+    if ((pLine[0] != '\0') && (strcmp(pLine, "\r") != 0))
     {
-        m_currentSectionStringBuffer.getline(pLineBuffer, MaxLineBufSize);
-
-        size_t readCount = static_cast<size_t>(m_currentSectionStringBuffer.gcount());
-        VFX_ASSERT(readCount < MaxLineBufSize);
-        if (readCount == 0)
-        {
-            break;
-        }
-        if ((pLineBuffer[0] == '\0') || (memcmp(pLineBuffer, "\r", 2) == 0))
-        {
-            // Skip empty line
-            continue;
-        }
-
         char* pKey   = nullptr;
         char* pValue = nullptr;
 
-        result = ExtractKeyAndValue(pLineBuffer, lineNum, '=', &pKey, &pValue, m_pErrorMsg);
-
-        if (result == false)
+        result = ExtractKeyAndValue(pLine, m_currentLineNum, '=', &pKey, &pValue, m_pErrorMsg);
+        if (result)
         {
-            break;
+            ParseKeyValue(pKey,
+                          pValue,
+                          m_currentLineNum,
+                          m_pCurrentSection);
         }
-
-        ParseKeyValue(pKey,
-                      pValue,
-                      lineNum,
-                      m_pCurrentSection);
-
-        ++lineNum;
     }
 
     return result;
@@ -610,30 +581,6 @@ bool VfxParser::ParseKeyValue(
     return result;
 }
 
-// =====================================================================================================================
-// Parses shader source section.
-void VfxParser::ParseSectionShaderSource()
-{
-    char pLineBuffer[MaxLineBufSize];
-
-    while (true)
-    {
-        m_currentSectionStringBuffer.getline(pLineBuffer, MaxLineBufSize);
-
-        size_t readCount = static_cast<size_t>(m_currentSectionStringBuffer.gcount());
-        VFX_ASSERT(readCount < MaxLineBufSize);
-        if (readCount == 0)
-        {
-            break;
-        }
-
-        // Line ending is not returned by getline(), so append them manually.
-        pLineBuffer[readCount- 1] = '\n';
-        pLineBuffer[readCount]    = '\0';
-        m_pCurrentSection->AddLine(pLineBuffer);
-    }
-}
-
 // =====================================================================================================================
 // Parses a VFX config file.
 bool VfxParser::Parse(
@@ -644,39 +591,88 @@ bool VfxParser::Parse(
     m_pVfxDoc   = pDoc;
     m_pErrorMsg = pDoc->GetErrorMsg();
 
+    // The whole file is read into one buffer, which is then split into lines in place by overwriting each line ending
+    // with a terminator. A line is only copied out when macros have to be substituted in it.
+    std::vector<char> fileBuffer;
     FILE* pConfigFile = fopen(info.vfxFile.c_str(), "r");
     if (pConfigFile != nullptr)
+    {
+        long fileSize = -1;
+        if (fseek(pConfigFile, 0, SEEK_END) == 0)
+        {
+            fileSize = ftell(pConfigFile);
+            fseek(pConfigFile, 0, SEEK_SET);
+        }
+
+        if (fileSize >= 0)
+        {
+            fileBuffer.resize(static_cast<size_t>(fileSize) + 1);
+            // Text mode may translate line endings, so the read size can be less than the file size.
+            const size_t readSize = fread(&fileBuffer[0], 1, static_cast<size_t>(fileSize), pConfigFile);
+            fileBuffer.resize(readSize + 1);
+            fileBuffer[readSize] = '\0';
+        }
+        else
+        {
+            result = false;
+        }
+
+        fclose(pConfigFile);
+    }
+    else
+    {
+        result = false;
+    }
+
+    if (result)
     {
         pDoc->SetFileName(info.vfxFile);
         char lineBuf[MaxLineBufSize];
-        char* pLinePtr = nullptr;
+        char* pLineStart = &fileBuffer[0];
+        char* pBufferEnd = pLineStart + fileBuffer.size() - 1;
 
-        while (true)
+        while (pLineStart < pBufferEnd)
         {
-            pLinePtr = fgets(lineBuf, MaxLineBufSize, pConfigFile);
-
-            if (pLinePtr == nullptr)
+            char* pLineEnd = static_cast<char*>(memchr(pLineStart, '\n', pBufferEnd - pLineStart));
+            if (pLineEnd == nullptr)
             {
-                result = EndSection();
-                break;
+                pLineEnd = pBufferEnd;
             }
-            else
+            *pLineEnd = '\0';
+
+            char* pLinePtr = pLineStart;
+            pLineStart     = pLineEnd + 1;
+
+            if (info.macros.empty() == false)
             {
-                result = MacroSubstituteLine(pLinePtr, m_currentLineNum+1, &info.macros, MaxLineBufSize);
-                if (result == false)
+                const size_t lineLength = pLineEnd - pLinePtr;
+                if (lineLength >= MaxLineBufSize)
                 {
+                    PARSE_ERROR(*m_pErrorMsg, m_currentLineNum + 1, "Line length exceeds MaxLineBufSize.");
+                    result = false;
                     break;
                 }
+                memcpy(lineBuf, pLinePtr, lineLength + 1);
+                pLinePtr = lineBuf;
 
-                result = ParseLine(pLinePtr);
+                result = MacroSubstituteLine(pLinePtr, m_currentLineNum + 1, &info.macros, MaxLineBufSize);
                 if (result == false)
                 {
                     break;
                 }
             }
+
+            result = ParseLine(pLinePtr);
+            if (result == false)
+            {
+                break;
+            }
         }
 
-        fclose(pConfigFile);
+        if (result)
+        {
+            result = EndSection();
+        }
 
         if (result)
         {
@@ -688,10 +684,6 @@ bool VfxParser::Parse(
             result = m_pVfxDoc->CompileShader();
         }
     }
-    else
-    {
-        result = false;
-    }
 
     m_isValidVfxFile = result;
 
@@ -34,7 +34,6 @@
 #include <string.h>
 #include <stddef.h>
 #include <vector>
-#include <sstream>
 #include <map>
 
 #include "vfxSection.h"
@@ -102,9 +101,7 @@ private:
 
     bool EndSection();
 
-    void ParseSectionShaderSource();
-
-    bool ParseSectionKeyValues();
+    bool ParseSectionKeyValue(char* pLine);
 
     bool ParseKey(const char* pKey,
                   uint32_t    lineNum,
@@ -123,8 +120,6 @@ private:
     bool                m_isValidVfxFile;                // If vfx file is valid
     Section*            m_pCurrentSection;               // Current section
     uint32_t            m_currentLineNum;                // Current line number
-    std::stringstream   m_currentSectionStringBuffer;    // Current section string buffer
-    uint32_t            m_currentSectionLineNum;         // Current section line number
     std::string*        m_pErrorMsg;                     // Error message
 };
 
@@ -30,6 +30,8 @@
 */
 
 #include <inttypes.h>
+#include <mutex>
+#include <unordered_map>
 #include "vfxEnumsConverter.h"
 #include "vfxSection.h"
 
@@ -43,7 +45,11 @@ namespace Vfx
 
 // =====================================================================================================================
 // Static variables in class Section and derived class
-std::map<std::string, SectionInfo> Section::m_sectionInfo;
+std::vector<const char*> Section::m_sectionNames;
+std::vector<SectionInfo> Section::m_sectionInfo;
+NameIndex Section::m_sectionIndex;
+
+const uint32_t NameIndex::InvalidIndex;
 
 StrToMemberAddr SectionResultItem::m_addrTable[SectionResultItem::MemberCount];
 StrToMemberAddr SectionResult::m_addrTable[SectionResult::MemberCount];
@@ -140,6 +146,7 @@ Section::Section(
     m_lineNum(0),
     m_pMemberTable(pAddrTable),
     m_tableSize(tableSize),
+    m_pMemberIndex(nullptr),
     m_isActive(false)
 {
 
@@ -234,6 +241,132 @@ void Section::InitSectionInfo()
     INIT_SECTION_INFO("GsInfo", SectionTypeGeometryShaderInfo, 0)
     INIT_SECTION_INFO("FsInfo", SectionTypeFragmentShaderInfo, 0)
     INIT_SECTION_INFO("CsInfo", SectionTypeComputeShaderInfo, 0)
+
+    m_sectionIndex.Build(m_sectionNames);
+}
+
+// =====================================================================================================================
+// Builds the index over the specified names. A nullptr name is skipped, and for a duplicated name the first one wins.
+void NameIndex::Build(
+    const std::vector<const char*>& names)  // [in] Names to index
+{
+    // Maximum seeds to try before the slot count is doubled
+    static const uint32_t MaxSeedTries = 64;
+
+    m_names = names;
+
+    uint32_t slotCount = 1;
+    while (slotCount < 2 * names.size())
+    {
+        slotCount <<= 1;
+    }
+
+    std::vector<uint32_t> slots;
+    while (true)
+    {
+        for (uint32_t seed = 0; seed < MaxSeedTries; ++seed)
+        {
+            bool collision = false;
+            slots.assign(slotCount, InvalidIndex);
+            for (uint32_t i = 0; i < names.size(); ++i)
+            {
+                if (names[i] == nullptr)
+                {
+                    continue;
+                }
+
+                uint32_t& slot = slots[Hash(names[i], seed) & (slotCount - 1)];
+                if (slot == InvalidIndex)
+                {
+                    slot = i;
+                }
+                else if (strcmp(names[slot], names[i]) != 0)
+                {
+                    collision = true;
+                    break;
+                }
+            }
+
+            if (collision == false)
+            {
+                m_seed = seed;
+                m_mask = slotCount - 1;
+                m_slots.swap(slots);
+                return;
+            }
+        }
+        slotCount <<= 1;
+    }
+}
+
+// =====================================================================================================================
+// Finds the index of the specified name, returns InvalidIndex if it isn't in the indexed set.
+uint32_t NameIndex::Find(
+    const char* pName   // [in] Name to find
+    ) const
+{
+    uint32_t index = InvalidIndex;
+    if (m_slots.empty() == false)
+    {
+        index = m_slots[Hash(pName, m_seed) & m_mask];
+        if ((index != InvalidIndex) && (strcmp(m_names[index], pName) != 0))
+        {
+            index = InvalidIndex;
+        }
+    }
+    return index;
+}
+
+// =====================================================================================================================
+// Hashes a name with the specified seed (FNV-1a, with the seed folded into the offset basis).
+uint32_t NameIndex::Hash(
+    const char* pName,  // [in] Name to hash
+    uint32_t    seed)   // Hash seed
+{
+    uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (const char* pChar = pName; *pChar != '\0'; ++pChar)
+    {
+        hash ^= static_cast<uint8_t>(*pChar);
+        hash *= 16777619u;
+    }
+    return hash ^ (hash >> 16);
+}
+
+// =====================================================================================================================
+// Gets the member name index of the specified member address table, building it on first use. Address tables are
+// static per section class, so the index is shared by all objects of that class.
+const NameIndex* Section::GetMemberIndex(
+    const StrToMemberAddr* pAddrTable,  // [in] Member address table
+    uint32_t               tableSize)   // Size of above table
+{
+    static std::mutex lock;
+    static std::unordered_map<const StrToMemberAddr*, NameIndex> memberIndices;
+
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = memberIndices.find(pAddrTable);
+    if (it == memberIndices.end())
+    {
+        std::vector<const char*> names(tableSize);
+        for (uint32_t i = 0; i < tableSize; ++i)
+        {
+            names[i] = pAddrTable[i].pMemberName;
+        }
+        it = memberIndices.insert(std::make_pair(pAddrTable, NameIndex())).first;
+        it->second.Build(names);
+    }
+    return &it->second;
+}
+
+// =====================================================================================================================
+// Finds a member in the member address table, returns NameIndex::InvalidIndex if it isn't found.
+uint32_t Section::FindMember(
+    const char* pMemberName)    // [in] Member name
+{
+    if (m_pMemberIndex == nullptr)
+    {
+        m_pMemberIndex = GetMemberIndex(m_pMemberTable, m_tableSize);
+    }
+    return m_pMemberIndex->Find(pMemberName);
 }
 
 // =====================================================================================================================
@@ -245,18 +378,14 @@ bool Section::GetMemberType(
     std::string* pErrorMsg)       // [out] Error message
 {
     bool result = false;
-    for (uint32_t i = 0; i < m_tableSize; ++i)
+    const uint32_t i = FindMember(pMemberName);
+    if (i != NameIndex::InvalidIndex)
     {
-        if ((m_pMemberTable[i].pMemberName != nullptr) && strcmp(pMemberName, m_pMemberTable[i].pMemberName) == 0)
-        {
-            result = true;
+        result = true;
 
-            if (pValueType != nullptr)
-            {
-                *pValueType = m_pMemberTable[i].memberType;
-            }
-
-            break;
+        if (pValueType != nullptr)
+        {
+            *pValueType = m_pMemberTable[i].memberType;
         }
     }
 
@@ -279,21 +408,18 @@ bool Section::IsSection(
 {
     bool result = false;
 
-    for (uint32_t i = 0; i < m_tableSize; ++i)
+    const uint32_t i = FindMember(pMemberName);
+    if (i != NameIndex::InvalidIndex)
     {
-        if ((m_pMemberTable[i].pMemberName != nullptr) && strcmp(pMemberName, m_pMemberTable[i].pMemberName) == 0)
+        result = true;
+        if (pOutput != nullptr)
         {
-            result = true;
-            if (pOutput != nullptr)
-            {
-                *pOutput = m_pMemberTable[i].isSection;
-            }
+            *pOutput = m_pMemberTable[i].isSection;
+        }
 
-            if (pType != nullptr)
-            {
-                *pType = m_pMemberTable[i].memberType;
-            }
-            break;
+        if (pType != nullptr)
+        {
+            *pType = m_pMemberTable[i].memberType;
         }
     }
 
@@ -607,12 +733,14 @@ void Section::PrintSelf(
 Section* Section::CreateSection(
     const char* pSectionName)    // [in] Section name
 {
-    auto it = m_sectionInfo.find(pSectionName);
+    const uint32_t index = m_sectionIndex.Find(pSectionName);
+    VFX_ASSERT(index != NameIndex::InvalidIndex);
+    const SectionInfo& sectionInfo = m_sectionInfo[index];
 
-    VFX_ASSERT(it->second.type != SectionTypeUnset);
+    VFX_ASSERT(sectionInfo.type != SectionTypeUnset);
 
     Section* pSection = nullptr;
-    switch (it->second.type)
+    switch (sectionInfo.type)
     {
     case SectionTypeResult:
         pSection = new SectionResult();
@@ -653,7 +781,7 @@ Section* Section::CreateSection(
     case SectionTypeGeometryShaderInfo:
     case SectionTypeFragmentShaderInfo:
     case SectionTypeComputeShaderInfo:
-        pSection = new SectionShaderInfo(it->second.type);
+        pSection = new SectionShaderInfo(sectionInfo.type);
         break;
     case SectionTypeVertexShader:
     case SectionTypeTessControlShader:
@@ -661,7 +789,7 @@ Section* Section::CreateSection(
     case SectionTypeGeometryShader:
     case SectionTypeFragmentShader:
     case SectionTypeComputeShader:
-        pSection = new SectionShader(it->second);
+        pSection = new SectionShader(sectionInfo);
         break;
     default:
         VFX_NEVER_CALLED();
@@ -677,10 +805,10 @@ SectionType Section::GetSectionType(
     const char* pSectionName)   // [in] Section name
 {
     SectionType type = SectionTypeUnset;
-    auto it = m_sectionInfo.find(pSectionName);
-    if (it != m_sectionInfo.end())
+    const uint32_t index = m_sectionIndex.Find(pSectionName);
+    if (index != NameIndex::InvalidIndex)
     {
-        type = it->second.type;
+        type = m_sectionInfo[index].type;
     }
     return type;
 }
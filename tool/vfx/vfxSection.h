@@ -200,7 +200,8 @@ enum ShaderType
 // Initiates section info
 #define INIT_SECTION_INFO(NAME, type, property) { \
     SectionInfo sectionInfo = { type, property }; \
-    m_sectionInfo[NAME] = sectionInfo;}
+    m_sectionNames.push_back(NAME); \
+    m_sectionInfo.push_back(sectionInfo);}
 
 // =====================================================================================================================
 // Represents the structure that maps a string to a class member offset
@@ -221,6 +222,29 @@ struct SectionInfo
     uint32_t    property;       // Additional section information
 };
 
+// =====================================================================================================================
+// Represents a perfect hash index over a fixed set of names, e.g. the member names of a section class. A hash seed is
+// searched for at build time so that no two names share a slot, so a lookup is one hash and at most one strcmp.
+class NameIndex
+{
+public:
+    NameIndex() : m_seed(0), m_mask(0) {}
+
+    void Build(const std::vector<const char*>& names);
+
+    uint32_t Find(const char* pName) const;
+
+    static const uint32_t InvalidIndex = UINT32_MAX;    // Returned by Find() for a name not in the set
+
+private:
+    static uint32_t Hash(const char* pName, uint32_t seed);
+
+    uint32_t                 m_seed;    // Hash seed that maps every name to a distinct slot
+    uint32_t                 m_mask;    // Slot count minus one (slot count is a power of 2)
+    std::vector<uint32_t>    m_slots;   // Name index of each slot, InvalidIndex for empty slots
+    std::vector<const char*> m_names;   // Indexed names, nullptr entries are not indexed
+};
+
 // =====================================================================================================================
 // Represents an object whose member can be set throught it's string form name.
 class Section
@@ -284,6 +308,9 @@ public:
 
     bool IsSection(uint32_t lineNum, const char* memberName, bool* pOutput, MemberType *pType, std::string* pErrorMsg);
 
+    // Finds a member in the member address table, returns NameIndex::InvalidIndex if it isn't found
+    uint32_t FindMember(const char* pMemberName);
+
     // Has this object been configured in VFX file.
     bool IsActive() { return m_isActive; }
 
@@ -303,10 +330,16 @@ protected:
     const char*               m_pSectionName;       // Section name
     uint32_t                  m_lineNum;            // Line number of this section
 private:
+    static const NameIndex* GetMemberIndex(const StrToMemberAddr* pAddrTable, uint32_t tableSize);
+
     StrToMemberAddr*          m_pMemberTable;      // Member address table
     uint32_t                  m_tableSize;         // Address table size
+    const NameIndex*          m_pMemberIndex;      // Hash index of member names (built on first lookup)
     bool                      m_isActive;          // If the scestion is active
-    static std::map<std::string, SectionInfo> m_sectionInfo;    //Section info
+
+    static std::vector<const char*> m_sectionNames; // Section names
+    static std::vector<SectionInfo> m_sectionInfo;  // Section info, in the same order as m_sectionNames
+    static NameIndex                m_sectionIndex; // Hash index of section names
 };
 
 // =====================================================================================================================
@@ -330,25 +363,22 @@ bool Section::GetPtrOf(
         SetActive(true);
     }
     // Search section member
-    for (uint32_t i = 0; i < m_tableSize; ++i)
+    const uint32_t i = FindMember(memberName);
+    if (i != NameIndex::InvalidIndex)
     {
-        if (strcmp(memberName, m_pMemberTable[i].pMemberName) == 0)
+        pMemberAddr = GetMemberAddr(i);
+        memberType  = m_pMemberTable[i].memberType;
+        if (arrayIndex >= m_pMemberTable[i].arrayMaxSize)
         {
-            pMemberAddr = GetMemberAddr(i);
-            memberType  = m_pMemberTable[i].memberType;
-            if (arrayIndex >= m_pMemberTable[i].arrayMaxSize)
-            {
-                PARSE_ERROR(*pErrorMsg,
-                            lineNum,
-                            "Array access out of bound: %u of %s[%u]",
-                            arrayIndex,
-                            memberName,
-                            m_pMemberTable[i].arrayMaxSize);
-                result = false;
-            }
-            arrayMaxSize = m_pMemberTable[i].arrayMaxSize;
-            break;
+            PARSE_ERROR(*pErrorMsg,
+                        lineNum,
+                        "Array access out of bound: %u of %s[%u]",
+                        arrayIndex,
+                        memberName,
+                        m_pMemberTable[i].arrayMaxSize);
+            result = false;
         }
+        arrayMaxSize = m_pMemberTable[i].arrayMaxSize;
     }
 
     if ((result == true) && (pMemberAddr == reinterpret_cast<void*>(static_cast<size_t>(VfxInvalidValue))))
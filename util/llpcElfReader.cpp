@@ -46,6 +46,7 @@ ElfReader<Elf>::ElfReader(
     :
     m_gfxIp(gfxIp),
     m_header(),
+    m_symbolIndexBuilt(false),
     m_symSecIdx(InvalidValue),
     m_relocSecIdx(InvalidValue),
     m_strtabSecIdx(InvalidValue)
@@ -56,11 +57,6 @@ ElfReader<Elf>::ElfReader(
 template<class Elf>
 ElfReader<Elf>::~ElfReader()
 {
-    for (auto pSection : m_sections)
-    {
-        delete pSection;
-    }
-    m_sections.clear();
 }
 
 // =====================================================================================================================
@@ -78,6 +74,8 @@ ElfReader<Elf>::~ElfReader()
 // + Section Header (h0) [NULL]
 // + Section Header (h1) [.shstrtab]
 // + ...            (h#) [...]
+//
+// NOTE: Nothing is copied out of the buffer except section headers, so the buffer must outlive this reader.
 template<class Elf>
 Result ElfReader<Elf>::ReadFromBuffer(
     const void* pBuffer,   // [in] Input ELF data buffer
@@ -89,6 +87,11 @@ Result ElfReader<Elf>::ReadFromBuffer(
 
     const uint8_t* pData = static_cast<const uint8_t*>(pBuffer);
 
+    m_map.clear();
+    m_sections.clear();
+    m_sortedSections.clear();
+    m_symbolIndexBuilt = false;
+
     // ELF header is always located at the beginning of the file
     auto pHeader = static_cast<const typename Elf::FormatHeader*>(pBuffer);
 
@@ -114,6 +117,10 @@ Result ElfReader<Elf>::ReadFromBuffer(
         auto pSectionStrTableHeader = reinterpret_cast<const typename Elf::SectionHeader*>(pData + sectionStrTableHeaderOffset);
         const uint32_t sectionStrTableOffset = static_cast<uint32_t>(pSectionStrTableHeader->sh_offset);
 
+        m_sections.resize(sectionHeaderNum);
+        m_sortedSections.resize(sectionHeaderNum);
+        m_map.reserve(sectionHeaderNum);
+
         for (uint32_t section = 0; section < sectionHeaderNum; section++)
         {
             // Where the header is located for this section
@@ -127,23 +134,25 @@ Result ElfReader<Elf>::ReadFromBuffer(
 
             // Where the data is located for this section
             const uint32_t sectionDataOffset = static_cast<uint32_t>(pSectionHeader->sh_offset);
-            auto pBuf = new SectionBuffer;
-
-            result = (pBuf != nullptr) ? Result::Success : Result::ErrorOutOfMemory;
 
-            if (result == Result::Success)
-            {
-                pBuf->secHead = *pSectionHeader;
-                pBuf->pName   = pSectionName;
-                pBuf->pData   = (pData + sectionDataOffset);
+            SectionBuffer& sectionBuf = m_sections[section];
+            sectionBuf.secHead = *pSectionHeader;
+            sectionBuf.pName   = pSectionName;
+            sectionBuf.pData   = (pData + sectionDataOffset);
 
-                readSize += static_cast<size_t>(pSectionHeader->sh_size);
+            readSize += static_cast<size_t>(pSectionHeader->sh_size);
 
-                m_sections.push_back(pBuf);
-                m_map[pSectionName] = section;
-            }
+            m_map[pSectionName] = section;
+            m_sortedSections[section] = section;
         }
 
+        // Sorting index is by section name, as used by ELF dump.
+        std::stable_sort(m_sortedSections.begin(), m_sortedSections.end(),
+            [this](uint32_t a, uint32_t b)
+            {
+                return strcmp(m_sections[a].pName, m_sections[b].pName) < 0;
+            });
+
         *pBufSize = readSize;
     }
 
@@ -170,8 +179,8 @@ Result ElfReader<Elf>::GetSectionData(
 
     if (pEntry != m_map.end())
     {
-        *pData = m_sections[pEntry->second]->pData;
-        *pDataLength = static_cast<size_t>(m_sections[pEntry->second]->secHead.sh_size);
+        *pData = m_sections[pEntry->second].pData;
+        *pDataLength = static_cast<size_t>(m_sections[pEntry->second].secHead.sh_size);
         result = Result::Success;
     }
 
@@ -186,8 +195,8 @@ uint32_t ElfReader<Elf>::GetSymbolCount()
     uint32_t symCount = 0;
     if (m_symSecIdx >= 0)
     {
-        auto& pSection = m_sections[m_symSecIdx];
-        symCount = static_cast<uint32_t>(pSection->secHead.sh_size / pSection->secHead.sh_entsize);
+        auto& section = m_sections[m_symSecIdx];
+        symCount = static_cast<uint32_t>(section.secHead.sh_size / section.secHead.sh_entsize);
     }
     return symCount;
 }
@@ -199,16 +208,17 @@ void ElfReader<Elf>::GetSymbol(
     uint32_t   idx,       // Symbol index
     ElfSymbol* pSymbol)   // [out] Info of the symbol
 {
-    auto& pSection = m_sections[m_symSecIdx];
-    const char* pStrTab = reinterpret_cast<const char*>(m_sections[m_strtabSecIdx]->pData);
-
-    auto symbols = reinterpret_cast<const typename Elf::Symbol*>(pSection->pData);
-    pSymbol->secIdx   = symbols[idx].st_shndx;
-    pSymbol->pSecName = m_sections[pSymbol->secIdx]->pName;
-    pSymbol->pSymName = pStrTab + symbols[idx].st_name;
-    pSymbol->size     = symbols[idx].st_size;
-    pSymbol->value    = symbols[idx].st_value;
-    pSymbol->info.all = symbols[idx].st_info.all;
+    auto& section = m_sections[m_symSecIdx];
+    const char* pStrTab = reinterpret_cast<const char*>(m_sections[m_strtabSecIdx].pData);
+
+    auto symbols = reinterpret_cast<const typename Elf::Symbol*>(section.pData);
+    pSymbol->secIdx     = symbols[idx].st_shndx;
+    pSymbol->pSecName   = m_sections[pSymbol->secIdx].pName;
+    pSymbol->pSymName   = pStrTab + symbols[idx].st_name;
+    pSymbol->nameOffset = symbols[idx].st_name;
+    pSymbol->size       = symbols[idx].st_size;
+    pSymbol->value      = symbols[idx].st_value;
+    pSymbol->info.all   = symbols[idx].st_info.all;
 }
 
 // =====================================================================================================================
@@ -219,8 +229,8 @@ uint32_t ElfReader<Elf>::GetRelocationCount()
     uint32_t relocCount = 0;
     if (m_relocSecIdx >= 0)
     {
-        auto& pSection = m_sections[m_relocSecIdx];
-        relocCount = static_cast<uint32_t>(pSection->secHead.sh_size / pSection->secHead.sh_entsize);
+        auto& section = m_sections[m_relocSecIdx];
+        relocCount = static_cast<uint32_t>(section.secHead.sh_size / section.secHead.sh_entsize);
     }
     return relocCount;
 }
@@ -232,9 +242,9 @@ void ElfReader<Elf>::GetRelocation(
     uint32_t  idx,      // Relocation index
     ElfReloc* pReloc)   // [out] Info of the relocation
 {
-    auto& pSection = m_sections[m_relocSecIdx];
+    auto& section = m_sections[m_relocSecIdx];
 
-    auto relocs = reinterpret_cast<const typename Elf::Reloc*>(pSection->pData);
+    auto relocs = reinterpret_cast<const typename Elf::Reloc*>(section.pData);
     pReloc->offset = relocs[idx].r_offset;
     pReloc->symIdx = relocs[idx].r_symbol;
 }
@@ -251,104 +261,148 @@ uint32_t ElfReader<Elf>::GetSectionCount()
 // Gets section data by section index.
 template<class Elf>
 Result ElfReader<Elf>::GetSectionDataBySectionIndex(
-    uint32_t           secIdx,          // Section index
-    SectionBuffer**    ppSectionData    // [out] Section data
+    uint32_t              secIdx,          // Section index
+    const SectionBuffer** ppSectionData    // [out] Section data
     ) const
 {
     Result result = Result::ErrorInvalidValue;
     if (secIdx < m_sections.size())
     {
-        *ppSectionData = m_sections[secIdx];
+        *ppSectionData = &m_sections[secIdx];
         result = Result::Success;
     }
     return result;
 }
 
 // =====================================================================================================================
-// Gets section data by sorting index (ordered map).
+// Gets section data by sorting index (sorted by section name).
 template<class Elf>
 Result ElfReader<Elf>::GetSectionDataBySortingIndex(
-    uint32_t           sortIdx,         // Sorting index
-    uint32_t*          pSecIdx,         // [out] Section index
-    SectionBuffer**    ppSectionData    // [out] Section data
+    uint32_t              sortIdx,         // Sorting index
+    uint32_t*             pSecIdx,         // [out] Section index
+    const SectionBuffer** ppSectionData    // [out] Section data
     ) const
 {
     Result result = Result::ErrorInvalidValue;
-    if (sortIdx < m_sections.size())
+    if (sortIdx < m_sortedSections.size())
     {
-        auto it = m_map.begin();
-        for (uint32_t i = 0; i < sortIdx; ++i)
-        {
-            ++it;
-        }
-        *pSecIdx = it->second;
-        *ppSectionData = m_sections[it->second];
+        *pSecIdx = m_sortedSections[sortIdx];
+        *ppSectionData = &m_sections[*pSecIdx];
         result = Result::Success;
     }
     return result;
 }
 
 // =====================================================================================================================
-// Gets all associated symbols by section index.
+// Builds the index from section to its symbols and from symbol name to symbol, if not yet built. Symbols of each
+// section are grouped together in one array by a counting sort over the symbol table, then sorted by value.
 template<class Elf>
-void ElfReader<Elf>::GetSymbolsBySectionIndex(
-    uint32_t                secIdx,         // Section index
-    std::vector<ElfSymbol>& secSymbols)     // [out] ELF symbols
+void ElfReader<Elf>::BuildSymbolIndex()
 {
-    if ((secIdx < m_sections.size()) && (m_symSecIdx >= 0))
+    if (m_symbolIndexBuilt)
+    {
+        return;
+    }
+    m_symbolIndexBuilt = true;
+
+    const uint32_t secCount = static_cast<uint32_t>(m_sections.size());
+    m_secSymbolStarts.assign(secCount + 1, 0);
+    m_secSymbols.clear();
+    m_symbolMap.clear();
+
+    if ((m_symSecIdx < 0) || (m_strtabSecIdx < 0))
     {
-        auto& pSection = m_sections[m_symSecIdx];
-        const char* pStrTab = reinterpret_cast<const char*>(m_sections[m_strtabSecIdx]->pData);
+        return;
+    }
 
-        auto symbols = reinterpret_cast<const typename Elf::Symbol*>(pSection->pData);
-        uint32_t symCount = GetSymbolCount();
-        ElfSymbol symbol = {};
+    const char* pStrTab = reinterpret_cast<const char*>(m_sections[m_strtabSecIdx].pData);
+    auto symbols = reinterpret_cast<const typename Elf::Symbol*>(m_sections[m_symSecIdx].pData);
+    const uint32_t symCount = GetSymbolCount();
 
-        for (uint32_t idx = 0; idx < symCount; ++idx)
+    // Count symbols of each section, then turn the counts into start positions.
+    for (uint32_t idx = 0; idx < symCount; ++idx)
+    {
+        const uint32_t secIdx = symbols[idx].st_shndx;
+        if (secIdx < secCount)
         {
-            if (symbols[idx].st_shndx == secIdx)
-            {
-                symbol.secIdx   = symbols[idx].st_shndx;
-                symbol.pSecName = m_sections[symbol.secIdx]->pName;
-                symbol.pSymName = pStrTab + symbols[idx].st_name;
-                symbol.size     = symbols[idx].st_size;
-                symbol.value    = symbols[idx].st_value;
-                symbol.info.all = symbols[idx].st_info.all;
-
-                secSymbols.push_back(symbol);
-            }
+            ++m_secSymbolStarts[secIdx + 1];
         }
+    }
 
-        std::sort(secSymbols.begin(), secSymbols.end(),
-             [](const ElfSymbol& a, const ElfSymbol& b)
-             {
-                 return a.value < b.value;
-             });
+    for (uint32_t secIdx = 0; secIdx < secCount; ++secIdx)
+    {
+        m_secSymbolStarts[secIdx + 1] += m_secSymbolStarts[secIdx];
+    }
+
+    // Scatter symbols to their sections. This advances each start position to the end of its section, which is the
+    // start of the next one, so shift them back afterwards.
+    m_secSymbols.resize(m_secSymbolStarts[secCount]);
+    for (uint32_t idx = 0; idx < symCount; ++idx)
+    {
+        const uint32_t secIdx = symbols[idx].st_shndx;
+        if (secIdx < secCount)
+        {
+            m_secSymbols[m_secSymbolStarts[secIdx]++] = idx;
+        }
+    }
+
+    for (uint32_t secIdx = secCount; secIdx > 0; --secIdx)
+    {
+        m_secSymbolStarts[secIdx] = m_secSymbolStarts[secIdx - 1];
+    }
+    m_secSymbolStarts[0] = 0;
+
+    for (uint32_t secIdx = 0; secIdx < secCount; ++secIdx)
+    {
+        std::stable_sort(m_secSymbols.begin() + m_secSymbolStarts[secIdx],
+                         m_secSymbols.begin() + m_secSymbolStarts[secIdx + 1],
+                         [symbols](uint32_t a, uint32_t b)
+                         {
+                             return symbols[a].st_value < symbols[b].st_value;
+                         });
+    }
+
+    // The first symbol of a name wins, as with a linear search.
+    m_symbolMap.reserve(symCount);
+    for (uint32_t idx = 0; idx < symCount; ++idx)
+    {
+        m_symbolMap.insert({ StringRef(pStrTab + symbols[idx].st_name), idx });
     }
 }
 
 // =====================================================================================================================
-// Checks whether the input name is a valid symbol.
+// Gets all associated symbols by section index, sorted by value.
 template<class Elf>
-bool ElfReader<Elf>::IsValidSymbol(
-    const char* pSymbolName)  // [in] Symbol name
+void ElfReader<Elf>::GetSymbolsBySectionIndex(
+    uint32_t                secIdx,         // Section index
+    std::vector<ElfSymbol>& secSymbols)     // [out] ELF symbols
 {
-    auto& pSection = m_sections[m_symSecIdx];
-    const char* pStrTab = reinterpret_cast<const char*>(m_sections[m_strtabSecIdx]->pData);
+    BuildSymbolIndex();
 
-    auto symbols = reinterpret_cast<const typename Elf::Symbol*>(pSection->pData);
-    uint32_t symCount = GetSymbolCount();
-    bool findSymbol = false;
-    for (uint32_t idx = 0; idx < symCount; ++idx)
+    if (secIdx < m_sections.size())
     {
-        auto pName = pStrTab + symbols[idx].st_name;
-        if (strcmp(pName, pSymbolName) == 0)
+        const uint32_t start = m_secSymbolStarts[secIdx];
+        const uint32_t end   = m_secSymbolStarts[secIdx + 1];
+        secSymbols.reserve(secSymbols.size() + end - start);
+
+        for (uint32_t i = start; i < end; ++i)
         {
-            findSymbol = true;
-            break;
+            ElfSymbol symbol = {};
+            GetSymbol(m_secSymbols[i], &symbol);
+            secSymbols.push_back(symbol);
         }
     }
-    return findSymbol;
+}
+
+// =====================================================================================================================
+// Checks whether the input name is a valid symbol.
+template<class Elf>
+bool ElfReader<Elf>::IsValidSymbol(
+    const char* pSymbolName)  // [in] Symbol name
+{
+    BuildSymbolIndex();
+
+    return (m_symbolMap.find(pSymbolName) != m_symbolMap.end());
 }
 
 // =====================================================================================================================
@@ -357,10 +411,10 @@ template<class Elf>
 ElfNote ElfReader<Elf>::GetNote(
     Util::Abi::PipelineAbiNoteType noteType) // Note type
 {
-    uint32_t noteSecIdx = m_map[NoteName];
+    int32_t noteSecIdx = GetSectionIndex(NoteName);
     LLPC_ASSERT(noteSecIdx > 0);
 
-    auto pNoteSection = m_sections[noteSecIdx];
+    auto pNoteSection = &m_sections[noteSecIdx];
     ElfNote noteNode = {};
     const uint32_t noteHeaderSize = sizeof(NoteHeader) - 8;
 
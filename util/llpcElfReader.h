@@ -31,9 +31,10 @@
 #pragma once
 
 #include <functional>
-#include <map>
 #include <string>
 #include <vector>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/BinaryFormat/MsgPackDocument.h"
 
 #include "llpc.h"
@@ -440,6 +441,9 @@ struct MsgPackIterator
 //
 // The client should call "ReadFromBuffer()" to initialize the context with the contents of an ELF, then
 // "GetSectionData()" to retrieve the contents of a particular named section.
+//
+// NOTE: The reader does not copy the ELF, section data and names refer to the input buffer, which must outlive the
+// reader. Section headers are kept in one flat array, and the section-to-symbol index is built on first use.
 template<class Elf>
 class ElfReader
 {
@@ -459,8 +463,10 @@ public:
     Result GetSectionData(const char* pName, const void** ppData, size_t* pDataLength) const;
 
     uint32_t GetSectionCount();
-    Result GetSectionDataBySectionIndex(uint32_t secIdx, SectionBuffer** ppSectionData) const;
-    Result GetSectionDataBySortingIndex(uint32_t sortIdx, uint32_t* pSecIdx, SectionBuffer** ppSectionData) const;
+    Result GetSectionDataBySectionIndex(uint32_t secIdx, const SectionBuffer** ppSectionData) const;
+    Result GetSectionDataBySortingIndex(uint32_t              sortIdx,
+                                        uint32_t*             pSecIdx,
+                                        const SectionBuffer** ppSectionData) const;
 
     // Determine if a section with the specified name is present in this ELF.
     bool IsSectionPresent(const char* pName) const { return (m_map.find(pName) != m_map.end()); }
@@ -497,13 +503,22 @@ public:
 private:
     LLPC_DISALLOW_COPY_AND_ASSIGN(ElfReader);
 
+    void BuildSymbolIndex();
+
     // -----------------------------------------------------------------------------------------------------------------
 
     GfxIpVersion    m_gfxIp;    // Graphics IP version info (used by ELF dump only)
 
-    typename Elf::FormatHeader        m_header;     // ELF header
-    std::map<std::string, uint32_t>   m_map;        // Map between section name and section index
-    std::vector<SectionBuffer*>       m_sections;   // List of section data and headers
+    typename Elf::FormatHeader                m_header;           // ELF header
+    llvm::DenseMap<llvm::StringRef, uint32_t> m_map;              // Map between section name and section index
+    std::vector<SectionBuffer>                m_sections;         // List of section data and headers
+    std::vector<uint32_t>                     m_sortedSections;   // Section indices sorted by section name
+
+    bool                                      m_symbolIndexBuilt; // Whether the symbol index below is built
+    std::vector<uint32_t>                     m_secSymbolStarts;  // Start of each section's symbols in m_secSymbols,
+                                                                  // plus an end marker
+    std::vector<uint32_t>                     m_secSymbols;       // Symbol indices grouped by section, sorted by value
+    llvm::DenseMap<llvm::StringRef, uint32_t> m_symbolMap;        // Map between symbol name and symbol index
 
     int32_t   m_symSecIdx;      // Index of symbol section
     int32_t   m_relocSecIdx;    // Index of relocation section
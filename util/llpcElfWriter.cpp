@@ -635,7 +635,7 @@ Result ElfWriter<Elf>::ReadFromBuffer(
     m_sections.resize(reader.m_sections.size());
     for (size_t i = 0; i < reader.m_sections.size(); ++i)
     {
-        auto pSection = reader.m_sections[i];
+        auto pSection = &reader.m_sections[i];
         m_sections[i].secHead = pSection->secHead;
         m_sections[i].pName = pSection->pName;
         auto pData = new uint8_t[pSection->secHead.sh_size + 1];
@@ -766,7 +766,7 @@ void ElfWriter<Elf>::MergeElfBinary(
 
     // Merge GPU ISA code
     const ElfSectionBuffer<Elf64::SectionHeader>* pNonFragmentTextSection = nullptr;
-    ElfSectionBuffer<Elf64::SectionHeader>* pFragmentTextSection = nullptr;
+    const ElfSectionBuffer<Elf64::SectionHeader>* pFragmentTextSection = nullptr;
     std::vector<ElfSymbol> fragmentSymbols;
     std::vector<ElfSymbol*> nonFragmentSymbols;
 
@@ -854,7 +854,7 @@ void ElfWriter<Elf>::MergeElfBinary(
     // Merge ISA disassemble
     auto fragmentDisassemblySecIndex = reader.GetSectionIndex(Util::Abi::AmdGpuDisassemblyName);
     auto nonFragmentDisassemblySecIndex = GetSectionIndex(Util::Abi::AmdGpuDisassemblyName);
-    ElfSectionBuffer<Elf64::SectionHeader>* pFragmentDisassemblySection = nullptr;
+    const ElfSectionBuffer<Elf64::SectionHeader>* pFragmentDisassemblySection = nullptr;
     const ElfSectionBuffer<Elf64::SectionHeader>* pNonFragmentDisassemblySection = nullptr;
     reader.GetSectionDataBySectionIndex(fragmentDisassemblySecIndex, &pFragmentDisassemblySection);
     GetSectionDataBySectionIndex(nonFragmentDisassemblySecIndex, &pNonFragmentDisassemblySection);
@@ -896,7 +896,7 @@ void ElfWriter<Elf>::MergeElfBinary(
 
     // Merge LLVM IR disassemble
     const std::string LlvmIrSectionName = std::string(Util::Abi::AmdGpuCommentLlvmIrName);
-    ElfSectionBuffer<Elf64::SectionHeader>* pFragmentLlvmIrSection = nullptr;
+    const ElfSectionBuffer<Elf64::SectionHeader>* pFragmentLlvmIrSection = nullptr;
     const ElfSectionBuffer<Elf64::SectionHeader>* pNonFragmentLlvmIrSection = nullptr;
 
     auto fragmentLlvmIrSecIndex = reader.GetSectionIndex(LlvmIrSectionName.c_str());
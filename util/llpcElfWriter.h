@@ -110,13 +110,13 @@ private:
 
     // -----------------------------------------------------------------------------------------------------------------
 
-    GfxIpVersion                      m_gfxIp;    // Graphics IP version info (used by ELF dump only)
-    typename Elf::FormatHeader        m_header;   // ELF header
-    std::map<std::string, uint32_t>   m_map;      // Map between section name and section index
+    GfxIpVersion                              m_gfxIp;    // Graphics IP version info (used by ELF dump only)
+    typename Elf::FormatHeader                m_header;   // ELF header
+    llvm::DenseMap<llvm::StringRef, uint32_t> m_map;      // Map between section name and section index
 
-    std::vector<SectionBuffer>        m_sections;    // List of section data and headers
-    std::vector<ElfNote>              m_notes;       // List of Elf notes
-    std::vector<ElfSymbol>            m_symbols;     // List of Elf symbols
+    std::vector<SectionBuffer>                m_sections;    // List of section data and headers
+    std::vector<ElfNote>                      m_notes;       // List of Elf notes
+    std::vector<ElfSymbol>                    m_symbols;     // List of Elf symbols
 
     int32_t m_textSecIdx;       // Section index of .text section
     int32_t m_noteSecIdx;       // Section index of .note section
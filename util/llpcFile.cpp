@@ -30,10 +30,25 @@
  */
 #define DEBUG_TYPE "llpc-file"
 
+#if defined(_WIN32)
+    // Must be defined before anything includes <windows.h>, so that it does not define min/max macros.
+    #define NOMINMAX
+#endif
+
 #include "llpcFile.h"
+#include <algorithm>
+#include <cerrno>
 #include <stdarg.h>
 #include <sys/stat.h>
 
+#if defined(_WIN32)
+    #include <io.h>
+    #include <windows.h>
+#else
+    #include <sys/file.h>
+    #include <unistd.h>
+#endif
+
 namespace Llpc
 {
 
@@ -56,6 +71,8 @@ Result File::Open(
     else
     {
         char fileMode[5] = { };
+        // Mode to create the file exclusively if opening it with fileMode fails, empty if the file isn't created
+        char createMode[5] = { };
 
         switch (accessFlags)
         {
@@ -109,6 +126,22 @@ Result File::Open(
             fileMode[1] = '+';
             fileMode[2] = 'b';
             break;
+        case (FileAccessReadUpdate | FileAccessCreate):
+            fileMode[0] = 'r';
+            fileMode[1] = '+';
+            createMode[0] = 'w';
+            createMode[1] = '+';
+            createMode[2] = 'x';
+            break;
+        case (FileAccessReadUpdate | FileAccessCreate | FileAccessBinary):
+            fileMode[0] = 'r';
+            fileMode[1] = '+';
+            fileMode[2] = 'b';
+            createMode[0] = 'w';
+            createMode[1] = '+';
+            createMode[2] = 'b';
+            createMode[3] = 'x';
+            break;
         default:
             LLPC_NEVER_CALLED();
             result = Result::ErrorInvalidValue;
@@ -117,13 +150,19 @@ Result File::Open(
 
         if (result == Result::Success)
         {
-#if defined(_WIN32)
-            // MS compilers provide fopen_s, which is supposedly "safer" than traditional fopen.
-            fopen_s(&m_pFileHandle, pFilename, &fileMode[0]);
-#else
-            // Just use the traditional fopen.
-            m_pFileHandle = fopen(pFilename, &fileMode[0]);
-#endif
+            m_pFileHandle = OpenStream(pFilename, &fileMode[0]);
+
+            if ((m_pFileHandle == nullptr) && (createMode[0] != '\0'))
+            {
+                // The file doesn't exist, so create it. "x" fails rather than truncates if another process has created
+                // the file in the meantime, in which case that file is opened instead.
+                m_pFileHandle = OpenStream(pFilename, &createMode[0]);
+                if (m_pFileHandle == nullptr)
+                {
+                    m_pFileHandle = OpenStream(pFilename, &fileMode[0]);
+                }
+            }
+
             if (m_pFileHandle == nullptr)
             {
                 result = Result::ErrorUnknown;
@@ -134,6 +173,23 @@ Result File::Open(
     return result;
 }
 
+// =====================================================================================================================
+// Opens a C runtime file stream with the specified mode. Returns nullptr on failure.
+std::FILE* File::OpenStream(
+    const char* pFilename,  // [in] Name of file to open
+    const char* pMode)      // [in] fopen-style mode string
+{
+    std::FILE* pFileHandle = nullptr;
+#if defined(_WIN32)
+    // MS compilers provide fopen_s, which is supposedly "safer" than traditional fopen.
+    fopen_s(&pFileHandle, pFilename, pMode);
+#else
+    // Just use the traditional fopen.
+    pFileHandle = fopen(pFilename, pMode);
+#endif
+    return pFileHandle;
+}
+
 // =====================================================================================================================
 // Closes the file handle if still open.
 void File::Close()
@@ -360,15 +416,19 @@ void File::Rewind()
 }
 
 // =====================================================================================================================
-// Sets the file position to the beginning of the file.
+// Sets the file position to the specified offset.
 void File::Seek(
-    int32_t offset,         // Number of bytes to offset
-    bool   fromOrigin)      // If true, the seek will be relative to the file origin;
+    int64_t offset,         // Number of bytes to offset
+    bool    fromOrigin)     // If true, the seek will be relative to the file origin;
                             // if false, it will be from the current position
 {
     if (m_pFileHandle != nullptr)
     {
-        int32_t ret = fseek(m_pFileHandle, offset, fromOrigin ? SEEK_SET : SEEK_CUR);
+#if defined(_WIN32)
+        int32_t ret = _fseeki64(m_pFileHandle, offset, fromOrigin ? SEEK_SET : SEEK_CUR);
+#else
+        int32_t ret = fseeko(m_pFileHandle, static_cast<off_t>(offset), fromOrigin ? SEEK_SET : SEEK_CUR);
+#endif
 
         LLPC_ASSERT(ret == 0);
         LLPC_UNUSED(ret);
@@ -376,15 +436,229 @@ void File::Seek(
 }
 
 // =====================================================================================================================
-// Returns true if a file with the given name exists.
+// Reads a stream of bytes from the specified offset of the file, without using the file position.
+Result File::ReadAt(
+    void*    pBuffer,     // [out] Buffer to read the file into
+    size_t   bufferSize,  // Size of buffer in bytes
+    uint64_t offset,      // Offset in bytes from the file origin
+    size_t*  pBytesRead)  // [out] Number of bytes actually read (can be nullptr)
+{
+    Result result = Result::Success;
+
+    if (m_pFileHandle == nullptr)
+    {
+        result = Result::ErrorUnavailable;
+    }
+    else if (pBuffer == nullptr)
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else if (bufferSize == 0)
+    {
+        result = Result::ErrorInvalidValue;
+    }
+    else
+    {
+        // Any data buffered by the stream must reach the file before it is read behind the stream's back.
+        fflush(m_pFileHandle);
+
+        size_t bytesRead = 0;
+#if defined(_WIN32)
+        // There is no pread on Windows; an overlapped ReadFile reads at an offset without the file pointer.
+        HANDLE hFile = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(m_pFileHandle)));
+        while (bytesRead < bufferSize)
+        {
+            const uint64_t readOffset = offset + bytesRead;
+            OVERLAPPED overlapped = {};
+            overlapped.Offset     = static_cast<DWORD>(readOffset);
+            overlapped.OffsetHigh = static_cast<DWORD>(readOffset >> 32);
+
+            const DWORD chunkSize = static_cast<DWORD>(std::min<size_t>(bufferSize - bytesRead, MAXDWORD));
+            DWORD chunkRead = 0;
+            if ((ReadFile(hFile,
+                          static_cast<char*>(pBuffer) + bytesRead,
+                          chunkSize,
+                          &chunkRead,
+                          &overlapped) == FALSE) ||
+                (chunkRead == 0))
+            {
+                break;
+            }
+            bytesRead += chunkRead;
+        }
+#else
+        const int fd = fileno(m_pFileHandle);
+        while (bytesRead < bufferSize)
+        {
+            const ssize_t chunkRead = pread(fd,
+                                            static_cast<char*>(pBuffer) + bytesRead,
+                                            bufferSize - bytesRead,
+                                            static_cast<off_t>(offset + bytesRead));
+            if (chunkRead <= 0)
+            {
+                break;
+            }
+            bytesRead += chunkRead;
+        }
+#endif
+
+        if (bytesRead != bufferSize)
+        {
+            result = Result::ErrorUnknown;
+        }
+
+        if (pBytesRead != nullptr)
+        {
+            *pBytesRead = bytesRead;
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Writes a stream of bytes to the specified offset of the file, without using the file position.
+Result File::WriteAt(
+    const void* pBuffer,     // [in] Buffer to write to the file
+    size_t      bufferSize,  // Size of the buffer in bytes
+    uint64_t    offset)      // Offset in bytes from the file origin
+{
+    Result result = Result::Success;
+
+    if (m_pFileHandle == nullptr)
+    {
+        result = Result::ErrorUnavailable;
+    }
+    else if (pBuffer == nullptr)
+    {
+        result = Result::ErrorInvalidPointer;
+    }
+    else if (bufferSize == 0)
+    {
+        result = Result::ErrorInvalidValue;
+    }
+    else
+    {
+        // Keep the order of writes: anything still buffered by the stream goes to the file first.
+        fflush(m_pFileHandle);
+
+        size_t bytesWritten = 0;
+#if defined(_WIN32)
+        HANDLE hFile = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(m_pFileHandle)));
+        while (bytesWritten < bufferSize)
+        {
+            const uint64_t writeOffset = offset + bytesWritten;
+            OVERLAPPED overlapped = {};
+            overlapped.Offset     = static_cast<DWORD>(writeOffset);
+            overlapped.OffsetHigh = static_cast<DWORD>(writeOffset >> 32);
+
+            const DWORD chunkSize = static_cast<DWORD>(std::min<size_t>(bufferSize - bytesWritten, MAXDWORD));
+            DWORD chunkWritten = 0;
+            if ((WriteFile(hFile,
+                           static_cast<const char*>(pBuffer) + bytesWritten,
+                           chunkSize,
+                           &chunkWritten,
+                           &overlapped) == FALSE) ||
+                (chunkWritten == 0))
+            {
+                break;
+            }
+            bytesWritten += chunkWritten;
+        }
+#else
+        const int fd = fileno(m_pFileHandle);
+        while (bytesWritten < bufferSize)
+        {
+            const ssize_t chunkWritten = pwrite(fd,
+                                                static_cast<const char*>(pBuffer) + bytesWritten,
+                                                bufferSize - bytesWritten,
+                                                static_cast<off_t>(offset + bytesWritten));
+            if (chunkWritten <= 0)
+            {
+                break;
+            }
+            bytesWritten += chunkWritten;
+        }
+#endif
+
+        if (bytesWritten != bufferSize)
+        {
+            result = Result::ErrorUnknown;
+        }
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Takes an advisory lock on the whole file, blocking until it is available. The lock is shared between processes, so
+// it coordinates several processes using the same file; it does not exclude threads of this process.
+Result File::Lock(
+    bool exclusive)     // Whether to take an exclusive (write) lock rather than a shared (read) lock
+{
+    Result result = Result::Success;
+
+    if (m_pFileHandle == nullptr)
+    {
+        result = Result::ErrorUnavailable;
+    }
+    else
+    {
+#if defined(_WIN32)
+        HANDLE hFile = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(m_pFileHandle)));
+        OVERLAPPED overlapped = {};
+        if (LockFileEx(hFile, exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0, 0, MAXDWORD, MAXDWORD, &overlapped) == FALSE)
+        {
+            result = Result::ErrorUnknown;
+        }
+#else
+        int ret = 0;
+        do
+        {
+            ret = flock(fileno(m_pFileHandle), exclusive ? LOCK_EX : LOCK_SH);
+        }
+        while ((ret != 0) && (errno == EINTR));
+
+        if (ret != 0)
+        {
+            result = Result::ErrorUnknown;
+        }
+#endif
+    }
+
+    return result;
+}
+
+// =====================================================================================================================
+// Releases the advisory lock taken by Lock().
+void File::Unlock()
+{
+    if (m_pFileHandle != nullptr)
+    {
+        // Make sure buffered writes are visible to the next process that takes the lock.
+        fflush(m_pFileHandle);
+
+#if defined(_WIN32)
+        HANDLE hFile = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(m_pFileHandle)));
+        OVERLAPPED overlapped = {};
+        UnlockFileEx(hFile, 0, MAXDWORD, MAXDWORD, &overlapped);
+#else
+        flock(fileno(m_pFileHandle), LOCK_UN);
+#endif
+    }
+}
+
+// =====================================================================================================================
+// Returns the size of the file with the given name, or 0 if it does not exist.
 size_t File::GetFileSize(
     const char* pFilename)     // [in] Name of the file to check
 {
 #if defined(_WIN32)
     // On MS compilers the function and structure to retrieve/store file status information is named '_stat' (with
     // underbar)...
-    struct _stat fileStatus = { };
-    const int32_t result = _stat(pFilename, &fileStatus);
+    // The 64-bit variant is used so that files beyond 4 GiB report their real size.
+    struct _stat64 fileStatus = { };
+    const int32_t result = _stat64(pFilename, &fileStatus);
 #else
     // ...however, on other compilers, they are named 'stat' (no underbar).
     struct stat fileStatus = {};
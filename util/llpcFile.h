@@ -46,6 +46,8 @@ enum FileAccessMode : uint32_t
     FileAccessAppend = 0x4,         ///< Append access.
     FileAccessBinary = 0x8,         ///< Binary access.
     FileAccessReadUpdate = 0x10,    ///< Read&Update access.
+    FileAccessCreate = 0x20,        ///< With Read&Update access, create the file if it does not exist. Unlike Write
+                                    ///  access, an existing file is not truncated.
 };
 
 // =====================================================================================================================
@@ -70,7 +72,16 @@ public:
     Result VPrintf(const char* pFormatStr, va_list argList);
     Result Flush() const;
     void Rewind();
-    void Seek(int32_t offset, bool fromOrigin);
+    void Seek(int64_t offset, bool fromOrigin);
+
+    // Positional I/O, which neither uses nor moves the file position, so it is safe to mix with other processes
+    // accessing the same file at different offsets.
+    Result ReadAt(void* pBuffer, size_t bufferSize, uint64_t offset, size_t* pBytesRead);
+    Result WriteAt(const void* pBuffer, size_t bufferSize, uint64_t offset);
+
+    // Advisory whole-file locking, shared between processes which open the same file.
+    Result Lock(bool exclusive);
+    void Unlock();
 
     // Returns true if the file is presently open.
     bool IsOpen() const { return (m_pFileHandle != nullptr); }
@@ -78,6 +89,8 @@ public:
     const std::FILE* GetHandle() const { return m_pFileHandle; }
 
 private:
+    static std::FILE* OpenStream(const char* pFilename, const char* pMode);
+
     std::FILE* m_pFileHandle;      // File handle
 };
 
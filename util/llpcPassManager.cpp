@@ -29,6 +29,7 @@
  ***********************************************************************************************************************
  */
 #include "llvm/Analysis/CFGPrinter.h"
+#include "llvm/IR/Function.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/CommandLine.h"
 
@@ -78,6 +79,7 @@ public:
 
     void SetPassIndex(uint32_t* pPassIndex) override { m_pPassIndex = pPassIndex; }
     void add(llvm::Pass* pPass) override;
+    bool run(llvm::Module& module) override;
     void stop() override;
 
 private:
@@ -88,8 +90,46 @@ private:
     uint32_t*         m_pPassIndex = nullptr;    // Pass Index
 };
 
+// =====================================================================================================================
+// Pass added after each pass by PassManagerImpl, so that an abandoned pipeline build is noticed at every pass boundary,
+// including after passes that never consult the pass gate themselves.
+class PassBoundaryCheck final : public FunctionPass
+{
+public:
+    PassBoundaryCheck() : FunctionPass(ID) {}
+
+    bool runOnFunction(Function& func) override;
+
+    void getAnalysisUsage(AnalysisUsage& analysisUsage) const override
+    {
+        analysisUsage.setPreservesAll();
+    }
+
+    StringRef getPassName() const override { return "LLPC pass boundary check"; }
+
+    // -----------------------------------------------------------------------------------------------------------------
+
+    static char ID;   // ID of this pass
+};
+
+char PassBoundaryCheck::ID = 0;
+
 } // anonymous
 
+// =====================================================================================================================
+// Executes this pass on the specified function.
+bool PassBoundaryCheck::runOnFunction(
+    Function& func)   // [in] Function to check the pass gate for
+{
+    // NOTE: The gate of an abandoned build throws here; the result only matters to the gate itself.
+    OptPassGate& gate = func.getContext().getOptPassGate();
+    if (gate.isEnabled())
+    {
+        gate.shouldRunPass(this, func.getName());
+    }
+    return false;
+}
+
 // =====================================================================================================================
 // Get the PassInfo for a registered pass given short name
 static const PassInfo* GetPassInfo(
@@ -152,6 +192,7 @@ void PassManagerImpl::add(
     }
 
     AnalysisID passId = pPass->getPassID();
+    PassKind passKind = pPass->getPassKind();
 
     // Skip the jump threading pass as it interacts really badly with the structurizer.
     if (passId == m_jumpThreading)
@@ -192,6 +233,39 @@ void PassManagerImpl::add(
         // Add a CFG printer pass after it.
         legacy::PassManager::add(createCFGPrinterLegacyPassPass());
     }
+
+#if LLPC_ENABLE_EXCEPTION
+    // Add a boundary check after it, unless it would split a loop or region pass pipeline.
+    if ((passKind == PT_Function) || (passKind == PT_Module))
+    {
+        legacy::PassManager::add(new PassBoundaryCheck());
+    }
+#endif
+}
+
+// =====================================================================================================================
+// Runs the passes on the specified module, unless the pipeline build that the module belongs to has been abandoned.
+// Returns true if the module was modified.
+//
+// NOTE: A build runs several pass managers in turn (SPIR-V lowering, patching and code generation), so an abandoned
+// build stops at the start of the next one, even without exceptions. Its skippable passes are already skipped by the
+// gate in the pass manager that is running.
+bool PassManagerImpl::run(
+    Module& module)   // [in/out] Module to run the passes on
+{
+    OptPassGate& gate = module.getContext().getOptPassGate();
+    if (gate.isEnabled())
+    {
+        // The gate lets boundary checks through unless the build has been abandoned.
+        PassBoundaryCheck boundaryCheck;
+        if (gate.shouldRunPass(&boundaryCheck, module.getName()) == false)
+        {
+            stop();
+            return false;
+        }
+    }
+
+    return legacy::PassManager::run(module);
 }
 
 // =====================================================================================================================
@@ -201,3 +275,83 @@ void PassManagerImpl::stop()
     m_stopped = true;
 }
 
+// =====================================================================================================================
+BuildCancelGate::BuildCancelGate(
+    LLVMContext& context)   // [in] LLVM context to install the gate on
+    :
+    m_context(context),
+    m_pPrevGate(&context.getOptPassGate())
+{
+    context.setOptPassGate(*this);
+}
+
+// =====================================================================================================================
+BuildCancelGate::~BuildCancelGate()
+{
+    m_context.setOptPassGate(*m_pPrevGate);
+}
+
+// =====================================================================================================================
+// Arms the gate for a pipeline build.
+void BuildCancelGate::Arm(
+    const volatile uint32_t* pCancelFlag,   // [in] Cancellation flag of the build (nullptr if none)
+    uint32_t                 timeoutMs)     // Milliseconds the build may run for (0 if unlimited)
+{
+    m_pCancelFlag = pCancelFlag;
+    m_hasDeadline = (timeoutMs != 0);
+    if (m_hasDeadline)
+    {
+        m_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    }
+    m_cancelled = false;
+}
+
+// =====================================================================================================================
+// Disarms the gate at the end of a pipeline build.
+void BuildCancelGate::Disarm()
+{
+    m_pCancelFlag = nullptr;
+    m_hasDeadline = false;
+    m_cancelled = false;
+}
+
+// =====================================================================================================================
+// Checks whether the build has been abandoned, by its cancellation flag or its deadline. Once abandoned, the build
+// stays abandoned until the gate is armed again.
+bool BuildCancelGate::IsCancelled()
+{
+    if ((m_cancelled == false) && IsArmed())
+    {
+        m_cancelled = ((m_pCancelFlag != nullptr) && (*m_pCancelFlag != 0)) ||
+                      (m_hasDeadline && (std::chrono::steady_clock::now() >= m_deadline));
+        if (m_cancelled)
+        {
+            LLPC_OUTS("Pipeline build is canceled\n");
+        }
+    }
+    return m_cancelled;
+}
+
+// =====================================================================================================================
+// Checks whether the specified pass should run. This is consulted by passes that may be skipped, and by the boundary
+// checks that PassManagerImpl makes before running and after each pass.
+bool BuildCancelGate::shouldRunPass(
+    const Pass* pPass,          // [in] Pass to check
+    StringRef   irDescription)  // Description of the IR unit the pass is about to run on
+{
+    if (IsCancelled())
+    {
+#if LLPC_ENABLE_EXCEPTION
+        throw("Pipeline build canceled");
+#endif
+        return false;
+    }
+
+    // Boundary checks are not real passes, so they do not count towards -opt-bisect-limit.
+    if (pPass->getPassID() == &PassBoundaryCheck::ID)
+    {
+        return true;
+    }
+
+    return (m_pPrevGate->isEnabled() == false) || m_pPrevGate->shouldRunPass(pPass, irDescription);
+}
@@ -30,7 +30,12 @@
  */
 #pragma once
 
+#include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/OptBisect.h"
+
+#include <chrono>
+#include "llpcDebug.h"
 
 namespace Llpc
 {
@@ -42,8 +47,48 @@ class PassManager : public llvm::legacy::PassManager
 public:
     static PassManager* Create();
     virtual ~PassManager() {}
+    virtual bool run(llvm::Module& module) = 0;
     virtual void stop() = 0;
     virtual void SetPassIndex(uint32_t* pPassIndex) = 0;
 };
 
+// =====================================================================================================================
+// Pass gate that abandons a pipeline build once its cancellation flag is set or its deadline has passed. It is
+// installed on an LLVM context for the lifetime of the gate, and only acts while armed for a build.
+//
+// Once the build is abandoned, passes that consult the gate are skipped, and pass managers created by
+// PassManager::Create do not run any more. If exceptions are enabled, the gate also throws at the next pass boundary of
+// such a pass manager, so the build unwinds at once.
+class BuildCancelGate : public llvm::OptPassGate
+{
+public:
+    BuildCancelGate(llvm::LLVMContext& context);
+    ~BuildCancelGate() override;
+
+    void Arm(const volatile uint32_t* pCancelFlag, uint32_t timeoutMs);
+    void Disarm();
+
+    bool IsCancelled();
+
+    // Checks whether the build has been seen to be abandoned, without checking the flag or the deadline again
+    bool HasCancelled() const { return m_cancelled; }
+
+    // Checks whether the gate is armed with a cancellation flag or a deadline
+    bool IsArmed() const { return (m_pCancelFlag != nullptr) || m_hasDeadline; }
+
+    bool isEnabled() const override { return IsArmed() || m_pPrevGate->isEnabled(); }
+    bool shouldRunPass(const llvm::Pass* pPass, llvm::StringRef irDescription) override;
+
+private:
+    LLPC_DISALLOW_DEFAULT_CTOR(BuildCancelGate);
+    LLPC_DISALLOW_COPY_AND_ASSIGN(BuildCancelGate);
+
+    llvm::LLVMContext&                      m_context;                  // LLVM context the gate is installed on
+    llvm::OptPassGate*                      m_pPrevGate;                // Gate that was installed before this one
+    const volatile uint32_t*                m_pCancelFlag = nullptr;    // Cancellation flag of the build
+    bool                                    m_hasDeadline = false;      // Whether the build has a deadline
+    std::chrono::steady_clock::time_point   m_deadline;                 // Deadline of the build
+    bool                                    m_cancelled = false;        // Whether the build has been abandoned
+};
+
 } // Llpc
@@ -1383,7 +1383,7 @@ OStream& operator<<(
 
     for (uint32_t sortIdx = 0; sortIdx < sectionCount; ++sortIdx)
     {
-        typename ElfReader<Elf>::SectionBuffer* pSection = nullptr;
+        const typename ElfReader<Elf>::SectionBuffer* pSection = nullptr;
         uint32_t secIdx = 0;
         Result result = reader.GetSectionDataBySortingIndex(sortIdx, &secIdx, &pSection);
         LLPC_ASSERT(result == Result::Success);
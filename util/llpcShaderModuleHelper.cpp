@@ -59,6 +59,7 @@ Result ShaderModuleHelper::CollectInfoFromSpirvBinary(
 
     // Parse SPIR-V instructions
     std::unordered_set<uint32_t> capabilities;
+    bool inFunction = false;
 
     while (pCodePos < pEnd)
     {
@@ -73,6 +74,7 @@ Result ShaderModuleHelper::CollectInfoFromSpirvBinary(
         }
 
         // Parse each instruction and find those we are interested in
+        bool isDebugInst = false;
         switch (opCode)
         {
         case OpCapability:
@@ -111,6 +113,7 @@ Result ShaderModuleHelper::CollectInfoFromSpirvBinary(
         case OpModuleProcessed:
             {
                 *pDebugInfoSize += wordCount * sizeof(uint32_t);
+                isDebugInst = true;
                 break;
             }
         case OpSpecConstantTrue:
@@ -131,11 +134,34 @@ Result ShaderModuleHelper::CollectInfoFromSpirvBinary(
                 shaderEntryNames.push_back(entry);
                 break;
             }
+        case OpFunction:
+            {
+                ++pShaderModuleUsage->functionCount;
+                inFunction = true;
+                break;
+            }
+        case OpFunctionEnd:
+            {
+                inFunction = false;
+                break;
+            }
+        case OpLoopMerge:
+            {
+                ++pShaderModuleUsage->loopCount;
+                break;
+            }
         default:
             {
                 break;
             }
         }
+
+        // NOTE: The size of function bodies is what compile time mostly scales with, so it is counted for the
+        // estimation of pipeline compile cost.
+        if (inFunction && (isDebugInst == false))
+        {
+            ++pShaderModuleUsage->instructionCount;
+        }
         pCodePos += wordCount;
     }
 